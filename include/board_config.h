@@ -25,6 +25,10 @@
     #define BUZZER_PIN                  4     // 蜂鸣器引脚
     #endif
     
+    #ifndef MPU_INT_PIN
+    #define MPU_INT_PIN                 1     // MPU6050 INT引脚（深度睡眠唤醒只支持GPIO0-5）
+    #endif
+    
     #ifndef UART_RX_PIN
     #define UART_RX_PIN                 20    // UART RX引脚
     #endif
@@ -45,6 +49,7 @@
         Serial.printf("   I2C: SDA=GPIO%d, SCL=GPIO%d\n", I2C_SDA_PIN, I2C_SCL_PIN); \
         Serial.printf("   按钮: GPIO%d (高电平触发)\n", BUTTON_PIN); \
         Serial.printf("   蜂鸣器: GPIO%d\n", BUZZER_PIN); \
+        Serial.printf("   MPU6050 INT: GPIO%d\n", MPU_INT_PIN); \
         Serial.printf("   UART: RX=GPIO%d, TX=GPIO%d\n", UART_RX_PIN, UART_TX_PIN); \
         Serial.printf("   I2C频率: %d Hz\n", I2C_FREQUENCY); \
     } while(0)
@@ -70,6 +75,10 @@
     #define BUZZER_PIN                  25    // 蜂鸣器引脚
     #endif
     
+    #ifndef MPU_INT_PIN
+    #define MPU_INT_PIN                 34    // MPU6050 INT引脚（深度睡眠唤醒需为RTC GPIO）
+    #endif
+    
     #ifndef UART_RX_PIN
     #define UART_RX_PIN                 3     // UART RX引脚
     #endif
@@ -90,6 +99,7 @@
         Serial.printf("   I2C: SDA=GPIO%d, SCL=GPIO%d\n", I2C_SDA_PIN, I2C_SCL_PIN); \
         Serial.printf("   按钮: GPIO%d (低电平触发)\n", BUTTON_PIN); \
         Serial.printf("   蜂鸣器: GPIO%d\n", BUZZER_PIN); \
+        Serial.printf("   MPU6050 INT: GPIO%d\n", MPU_INT_PIN); \
         Serial.printf("   UART: RX=GPIO%d, TX=GPIO%d\n", UART_RX_PIN, UART_TX_PIN); \
         Serial.printf("   I2C频率: %d Hz\n", I2C_FREQUENCY); \
     } while(0)
@@ -118,6 +128,10 @@
     #define BUZZER_PIN                  4
     #endif
     
+    #ifndef MPU_INT_PIN
+    #define MPU_INT_PIN                 1
+    #endif
+    
     #ifndef UART_RX_PIN
     #define UART_RX_PIN                 20
     #endif
@@ -180,6 +194,28 @@
     #endif
 #endif
 
+// 快速启动：不等待串口、不扫描I2C、不播放阻塞的提示音，各任务创建后与V3.0初始化并行进行，
+// 自检改为串口命令（selftest）。设为0恢复完整启动流程
+#ifndef FAST_BOOT_ENABLED
+#define FAST_BOOT_ENABLED           1
+#endif
+
+// 电源管理：游戏中保持最高频率，其它状态动态降频并在sdkconfig支持时自动浅睡眠（串口命令power查看估算电流）
+#ifndef POWER_MANAGEMENT_ENABLED
+#define POWER_MANAGEMENT_ENABLED    1
+#endif
+
+// 深度睡眠：待机空闲超时后MPU6050切换到低功耗动作检测，由动作中断或按键唤醒（串口命令sleep查看）
+#ifndef DEEP_SLEEP_ENABLED
+#define DEEP_SLEEP_ENABLED          1
+#endif
+
+// 自适应采样：游戏以外的状态MPU6050进入低功耗循环模式，由动作中断（MPU_INT_PIN）恢复全速采样，
+// INT未接线时每秒查询一次中断状态（待机启动手势可能需要多跳一次）
+#ifndef SENSOR_ADAPTIVE_SAMPLING
+#define SENSOR_ADAPTIVE_SAMPLING    1
+#endif
+
 // 引脚有效性检查宏
 #define IS_VALID_GPIO(pin) ((pin) >= 0 && (pin) <= BOARD_MAX_GPIO_NUM)
 
@@ -0,0 +1,126 @@
+#ifndef DLOG_H
+#define DLOG_H
+
+// 延迟日志：调用方只把格式串指针和参数写入无锁环形缓冲区，由低优先级任务格式化后输出到串口，
+// 热路径上的日志不会等待UART。缓冲区满时丢弃并计数，不会阻塞调用方。
+//
+// 注意：
+// - 输出时才读取格式串和%s参数，%s只能传指向静态存储的字符串（字符串常量、全局或static数组）；
+//   局部char数组、String::c_str()等临时缓冲区能编译通过，但输出时已经失效，编译期检查不出来
+// - 整数按32位保存，不支持long long参数；float/double按float保存
+// - 与直接调用Serial.printf的输出之间不保证顺序
+#include <Arduino.h>
+#include <type_traits>
+
+// 日志级别
+#define DLOG_LEVEL_NONE             0
+#define DLOG_LEVEL_ERROR            1
+#define DLOG_LEVEL_WARN             2
+#define DLOG_LEVEL_INFO             3
+#define DLOG_LEVEL_DEBUG            4
+#define DLOG_LEVEL_VERBOSE          5
+
+// 编译期级别过滤：高于DLOG_LEVEL的日志不生成任何代码（可用-DDLOG_LEVEL=4打开调试日志）
+#ifndef DLOG_LEVEL
+#define DLOG_LEVEL                  DLOG_LEVEL_INFO
+#endif
+
+#define DLOG_RING_SIZE              64      // 缓冲条数（2的幂）
+#define DLOG_MAX_ARGS               6       // 每条日志最多参数个数
+#define DLOG_LINE_MAX               192     // 格式化后单行最大长度
+#define DLOG_DRAIN_MS               20      // 输出任务轮询间隔
+#define DLOG_TASK_PRIORITY          1
+#define DLOG_TASK_STACK             3072
+
+typedef union {
+    uint32_t u;
+    int32_t i;
+    float f;
+    const char* s;
+} dlog_arg_t;
+
+// 每个调用点一个（宏内的静态变量），保存格式串和限速状态
+typedef struct {
+    const char* format;
+    uint8_t level;
+    uint16_t interval_ms;       // 0表示不限速
+    uint32_t last_ms;
+    uint16_t suppressed;        // 限速期间被丢弃的条数，在下一条输出时附带
+} dlog_site_t;
+
+// 启动输出任务（启动前写入的日志保留在缓冲区中）
+void dlog_init(void);
+
+// 等待缓冲区输出完毕（重启或睡眠前调用），超时返回false
+bool dlog_flush(uint32_t timeout_ms);
+
+uint32_t dlog_get_dropped(void);    // 累计因缓冲区满丢弃的条数
+
+// 以下供宏使用
+bool dlog_admit(dlog_site_t* site, uint16_t* suppressed);
+void dlog_push(const dlog_site_t* site, uint16_t suppressed, const dlog_arg_t* args, uint8_t argc);
+
+template<typename T>
+inline dlog_arg_t dlog_arg(T value) {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "DLOG: unsupported argument type (use string literals for %s)");
+    static_assert(sizeof(T) <= sizeof(long), "DLOG: long long arguments are not supported");
+    dlog_arg_t arg;
+    arg.u = (uint32_t)value;
+    return arg;
+}
+
+inline dlog_arg_t dlog_arg(float value) {
+    dlog_arg_t arg;
+    arg.f = value;
+    return arg;
+}
+
+inline dlog_arg_t dlog_arg(double value) {
+    dlog_arg_t arg;
+    arg.f = (float)value;
+    return arg;
+}
+
+inline dlog_arg_t dlog_arg(const char* value) {
+    dlog_arg_t arg;
+    arg.s = value;
+    return arg;
+}
+
+template<typename... Args>
+inline void dlog_write(dlog_site_t* site, Args... args) {
+    static_assert(sizeof...(Args) <= DLOG_MAX_ARGS, "DLOG: too many arguments");
+
+    uint16_t suppressed = 0;
+    if (site->interval_ms && !dlog_admit(site, &suppressed)) return;
+
+    dlog_arg_t argv[sizeof...(Args) + 1] = { dlog_arg(args)... };
+    dlog_push(site, suppressed, argv, sizeof...(Args));
+}
+
+// 只用于编译期检查格式串与参数是否匹配，从不调用
+inline void dlog_format_check(const char* format, ...) __attribute__((format(printf, 1, 2)));
+inline void dlog_format_check(const char* format, ...) {}
+
+#define DLOG_AT(level, interval_ms, format, ...) do { \
+    if ((level) <= DLOG_LEVEL) { \
+        static dlog_site_t dlog_site_ = { format, (level), (interval_ms), 0, 0 }; \
+        if (false) dlog_format_check(format, ##__VA_ARGS__); \
+        dlog_write(&dlog_site_, ##__VA_ARGS__); \
+    } \
+} while (0)
+
+#define DLOG_E(format, ...)         DLOG_AT(DLOG_LEVEL_ERROR, 0, format, ##__VA_ARGS__)
+#define DLOG_W(format, ...)         DLOG_AT(DLOG_LEVEL_WARN, 0, format, ##__VA_ARGS__)
+#define DLOG_I(format, ...)         DLOG_AT(DLOG_LEVEL_INFO, 0, format, ##__VA_ARGS__)
+#define DLOG_D(format, ...)         DLOG_AT(DLOG_LEVEL_DEBUG, 0, format, ##__VA_ARGS__)
+#define DLOG_V(format, ...)         DLOG_AT(DLOG_LEVEL_VERBOSE, 0, format, ##__VA_ARGS__)
+
+// 限速版本：同一调用点每interval_ms最多输出一条
+#define DLOG_RATE_W(interval_ms, format, ...)   DLOG_AT(DLOG_LEVEL_WARN, interval_ms, format, ##__VA_ARGS__)
+#define DLOG_RATE_I(interval_ms, format, ...)   DLOG_AT(DLOG_LEVEL_INFO, interval_ms, format, ##__VA_ARGS__)
+#define DLOG_RATE_D(interval_ms, format, ...)   DLOG_AT(DLOG_LEVEL_DEBUG, interval_ms, format, ##__VA_ARGS__)
+#define DLOG_RATE_V(interval_ms, format, ...)   DLOG_AT(DLOG_LEVEL_VERBOSE, interval_ms, format, ##__VA_ARGS__)
+
+#endif // DLOG_H
@@ -16,6 +16,8 @@
 #define MPU6050_ADDR                0x68
 #define MPU6050_PWR_MGMT_1          0x6B
 #define MPU6050_ACCEL_XOUT_H        0x3B
+#define MPU6050_MOTION_THRESHOLD    20    // 动作检测阈值（单位2mg，约40mg，高通滤波后）
+#define MPU6050_MOTION_DURATION     1     // 动作检测持续时间（单位1ms）
 
 // 游戏状态枚举
 typedef enum {
@@ -88,6 +90,58 @@ typedef struct {
     bool jump_detected;
 } sensor_data_t;
 
+// 任务遥测
+#define TELEMETRY_SAMPLE_MS         5000  // 采样间隔
+#define TELEMETRY_RING_SIZE         8     // 保留最近几次采样
+#define TELEMETRY_MAX_TASKS         16    // 每次采样最多记录的任务数
+#define TELEMETRY_NAME_LEN          16
+#define TELEMETRY_STACK_WARN_BYTES  512   // 登记任务栈剩余低于此值时报警
+
+// 启动阶段
+#define BOOT_MAX_PHASES             16
+#define BOOT_PHASE_FIRST_FRAME      "first_frame"   // 首个可交互画面（待机界面或V3.0菜单）
+
+// 电源管理
+#define POWER_CPU_MIN_MHZ           80    // 不低于80MHz：APB时钟保持80MHz，I2C和串口波特率不受影响
+
+// 功耗模式
+typedef enum {
+    POWER_MODE_ECO,         // 允许降频和浅睡眠（待机、结算、菜单）
+    POWER_MODE_PERFORMANCE  // 保持最高频率（游戏中、发射动画）
+} power_mode_t;
+
+// 深度睡眠
+#define DEEP_SLEEP_DEFAULT_TIMEOUT_S    300   // 未配置时的待机空闲超时（V3.0使用系统配置）
+#define DEEP_SLEEP_MOTION_G             0.15f // 加速度幅值偏离1g超过此值视为有动作，重新计时
+#define DEEP_SLEEP_PARK_TIMEOUT_MS      1000  // 等待各任务停止的最长时间
+#define DEEP_SLEEP_WAKE_BUDGET_MS       800   // 唤醒到首个可交互画面的时间上限，超出时报警
+#define DEEP_SLEEP_LATENCY_HISTORY      8     // RTC内存中保留最近几次唤醒延迟
+
+// 唤醒源
+typedef enum {
+    DEEP_SLEEP_WAKE_NONE,       // 上电或复位（不是从深度睡眠唤醒）
+    DEEP_SLEEP_WAKE_BUTTON,     // 按键
+    DEEP_SLEEP_WAKE_MOTION,     // MPU6050动作中断
+    DEEP_SLEEP_WAKE_OTHER
+} deep_sleep_wake_t;
+
+// 睡眠前需要停止的任务（各任务在主循环开头检查）
+#define DEEP_SLEEP_PARK_SENSOR          0x01
+#define DEEP_SLEEP_PARK_DISPLAY         0x02
+#define DEEP_SLEEP_PARK_BUTTON          0x04
+#define DEEP_SLEEP_PARK_GAME            0x08
+#define DEEP_SLEEP_PARK_ALL             0x0F
+
+// 登记循环周期的任务
+typedef enum {
+    TELEMETRY_TASK_SENSOR,
+    TELEMETRY_TASK_DISPLAY,
+    TELEMETRY_TASK_SOUND,
+    TELEMETRY_TASK_BUTTON,
+    TELEMETRY_TASK_GAME,
+    TELEMETRY_TASK_COUNT
+} telemetry_task_t;
+
 // 全局变量声明
 extern game_state_t current_state;
 extern game_data_t game_data;
@@ -116,6 +170,9 @@ void i2c_scan(void);
 // 传感器相关
 bool mpu6050_init_sensor(void);
 bool mpu6050_read_accel(float* accel_x, float* accel_y, float* accel_z);
+bool mpu6050_enable_wake_on_motion(void);           // 低功耗循环模式+动作中断（INT高电平锁存），用于深度睡眠唤醒
+bool sensor_is_low_power(void);                     // 传感器任务是否处于低功耗等待动作状态
+void sensor_print_stats(void);
 bool detect_jump(float accel_x, float accel_y, float accel_z);
 void sensor_task(void* pvParameters);
 
@@ -145,6 +202,7 @@ void oled_display_game_screen(void);
 void oled_display_pause_screen(void);
 void oled_display_reset_confirm_screen(void);
 void oled_display_result_screen(void);
+void oled_display_sleep_screen(void);
 void display_task(void* pvParameters);
 
 // 音效相关
@@ -193,6 +251,40 @@ void data_processor_init(void);
 void add_jump_record(uint32_t timestamp);
 void update_game_statistics(void);
 
+// 启动阶段计时（从复位开始的微秒数，同名阶段只记录第一次）
+void boot_mark(const char* phase);
+uint32_t boot_get_phase_ms(const char* phase);      // 未记录返回0
+void boot_print_timeline(void);
+
+// 任务遥测
+void telemetry_init(void);
+void telemetry_loop_tick(telemetry_task_t task);     // 各任务在主循环开头调用
+void telemetry_update(void);                         // 到采样间隔时采样一次
+void telemetry_print_latest(void);
+void telemetry_print_history(void);
+bool telemetry_handle_command(const char* command);  // 串口命令，已处理返回true
+
+// 电源管理
+void power_init(void);
+void power_update(void);                             // 游戏任务周期调用，按当前游戏状态切换功耗模式
+power_mode_t power_get_mode(void);
+void power_print_report(void);                       // 各状态停留时间和估算电流
+bool power_handle_command(const char* command);      // 串口命令，已处理返回true
+
+// 深度睡眠
+void deep_sleep_init(void);                          // setup开头调用：识别唤醒源
+bool deep_sleep_is_resume(void);                     // 本次启动是否从深度睡眠唤醒
+deep_sleep_wake_t deep_sleep_get_wake_source(void);
+void deep_sleep_set_policy(bool enabled, uint32_t timeout_s);
+void deep_sleep_note_activity(void);                 // 按键、动作等用户活动，重新计时
+bool deep_sleep_update(void);                        // loop周期调用，空闲超时需要睡眠时返回true
+bool deep_sleep_pending(void);                       // 睡眠准备中，各任务应调用deep_sleep_park
+void deep_sleep_park(uint8_t task_bit);              // 报告本任务已停止并挂起，不返回
+void deep_sleep_prepare(void);                       // 通知各任务停止并等待
+void deep_sleep_start(void);                         // 配置唤醒源后进入深度睡眠，不返回
+void deep_sleep_print_report(void);
+bool deep_sleep_handle_command(const char* command); // 串口命令，已处理返回true
+
 // 工具函数
 uint32_t get_time_ms(void);
 
@@ -56,14 +56,16 @@
     #define V3_ENHANCED_STATS_ENABLED   1     // 增强统计功能
     #define V3_SETTINGS_MENU_ENABLED    1     // 设置菜单功能
     
+    #define V3_POWER_MANAGEMENT_ENABLED POWER_MANAGEMENT_ENABLED  // 电源管理（动态调频+浅睡眠）
+    #define V3_DEEP_SLEEP_ENABLED       DEEP_SLEEP_ENABLED          // 深度睡眠（动作/按键唤醒）
+    
     // 暂时禁用的功能（按要求）
-    #define V3_POWER_MANAGEMENT_ENABLED 0     // 电源管理（暂不实现）
-    #define V3_DEEP_SLEEP_ENABLED       0     // 深度睡眠（暂不实现）
     #define V3_BATTERY_MONITOR_ENABLED  0     // 电池监测（暂不实现）
     
     // V3.0数据配置
     #define V3_MAX_DAILY_SESSIONS       20    // 每日最大游戏次数
     #define V3_HISTORY_DAYS             7     // 历史记录天数
+    #define V3_ROLLING_DAYS             30    // 内存中滚动汇总的天数
     #define V3_MAX_FILENAME_LENGTH      32    // 最大文件名长度
     
     // 调试信息
@@ -85,6 +87,7 @@
         Serial.printf("     Enhanced Stats: %s\n", V3_ENHANCED_STATS_ENABLED ? "Enabled" : "Disabled"); \
         Serial.printf("     Settings Menu: %s\n", V3_SETTINGS_MENU_ENABLED ? "Enabled" : "Disabled"); \
         Serial.printf("     Power Mgmt: %s\n", V3_POWER_MANAGEMENT_ENABLED ? "Enabled" : "Disabled(V3.1)"); \
+        Serial.printf("     Deep Sleep: %s\n", V3_DEEP_SLEEP_ENABLED ? "Enabled" : "Disabled"); \
     } while(0)
 
 #else
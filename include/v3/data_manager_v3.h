@@ -5,17 +5,93 @@
 #include <vector>
 #include "data_models_v3.h"
 #include "file_system_v3.h"
+#include "history_index_v3.h"
+#include "rollup_store_v3.h"
+#include "trend_series_v3.h"
+
+// 写回缓存：各记录的脏标记
+#define V3_DIRTY_DAILY                  0x01    // 当日数据
+#define V3_DIRTY_STATS                  0x02    // 历史统计
+#define V3_DIRTY_CONFIG                 0x04    // 系统配置
+#define V3_DIRTY_TARGETS                0x08    // 目标设置
+#define V3_DIRTY_PREV_DAY               0x10    // 跨天时尚未落盘的前一天数据
+
+// 写回缓存配置
+#define V3_WRITE_BEHIND_STALENESS_MS    5000    // 脏数据最长滞留时间
+#define V3_WRITE_BEHIND_CHECK_MS        500     // 刷新任务检查间隔
+#define V3_FLUSH_TASK_PRIORITY          1       // 低于所有业务任务
+#define V3_FLUSH_TASK_STACK_SIZE        6144    // 快照为定长DailyDataV3，放在任务栈上
+#define V3_FLUSH_TASK_STOP_TIMEOUT_MS   5000    // 等待写回任务退出（进行中的压缩可能较慢）
+
+// 已解码每日数据的LRU缓存（每条为定长DailyDataV3，约430B）
+#ifndef V3_DAILY_CACHE_SIZE
+#define V3_DAILY_CACHE_SIZE             V3_HISTORY_DAYS
+#endif
+
+// 分层汇总压缩（在写回任务中空闲时执行）
+#define V3_COMPACTION_BOOT_DELAY_MS     60000   // 启动后延迟，避开开机阶段
+#define V3_COMPACTION_MAX_STEPS         16      // 单次最多压缩步数，积压在后续空闲时继续
+#define V3_RETENTION_CHECK_MS           60000   // 高水位检查间隔
+
+// 历史汇总预取状态（在写回任务中加载，UI就绪后取走）
+#define V3_PREFETCH_IDLE                0
+#define V3_PREFETCH_REQUESTED           1
+#define V3_PREFETCH_READY               2
 
 class DataManagerV3 {
 private:
+    struct DailyCacheEntryV3 {
+        DailyDataV3 data;
+        uint32_t last_used;             // LRU计数，0表示空槽
+    };
+    
+
     FileSystemV3* fs;
     SystemConfigV3 system_config;
     DailyDataV3 current_day_data;
     HistoryStatsV3 history_stats;
+    RollingTotalsV3 rolling_totals;     // 最近V3_ROLLING_DAYS天汇总，周统计/趋势/连续天数均由此计算
+    HistoryIndexV3 history_index;       // 按epoch-day索引的每日汇总（/history.idx）
+    TrendSeriesV3 trend_series;         // 最近V3_TREND_DAYS天跳跃数及各窗口缩放好的柱高（趋势页面）
+    RollupStoreV3 rollup_store;         // 超出日期层的周/月汇总（/rollup.bin）
     TargetSettingsV3 target_settings;
     
     bool initialized;
-    String current_date;
+    int32_t current_day;        // 当前日期(epoch-day)，-1表示未确定
+    uint32_t last_save_us;      // 最近一次saveGameSession耗时(μs)
+    
+    // 写回缓存状态
+    SemaphoreHandle_t data_mutex;       // 保护内存记录和脏标记（递归锁）
+    SemaphoreHandle_t tier_mutex;       // 保护日期索引和周/月汇总（递归锁，压缩期间只阻塞历史查询）
+                                        // 加锁顺序：data_mutex -> tier_mutex
+    TaskHandle_t flush_task_handle;
+    volatile bool flush_task_stop;
+    SemaphoreHandle_t flush_task_exited;    // 任务退出前释放
+    DailyDataV3 previous_day_data;      // 跨天后待落盘的前一天数据
+    uint8_t dirty_mask;
+    uint32_t dirty_since;               // 最早一次未落盘修改的时间
+    uint32_t dirty_updates;             // 累计标脏次数
+    uint32_t flush_count;               // 累计刷新次数
+    
+    // 每日数据缓存（按日期，写入时失效）
+    DailyCacheEntryV3 daily_cache[V3_DAILY_CACHE_SIZE];
+    uint32_t cache_tick;
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+    
+    // 后台压缩状态
+    volatile bool background_allowed;   // 由主循环根据游戏状态设置
+    int32_t last_compaction_day;        // 最近一次完成压缩的epoch-day
+    uint32_t last_compaction_ms;        // 最近一次压缩耗时
+    uint32_t last_retention_check_ms;
+    
+    // 历史汇总预取暂存区
+    volatile uint8_t prefetch_state;
+    uint8_t prefetch_days;
+    uint8_t prefetch_count;
+    int32_t prefetch_day;               // 加载时的当前日期
+    uint32_t prefetch_version;          // 加载时的dirty_updates，之后有修改则视为过期
+    DailySummaryV3 prefetch_buffer[V3_HISTORY_DAYS];
     
 public:
     DataManagerV3();
@@ -23,7 +99,7 @@ public:
     
     // 初始化和管理
     bool init(FileSystemV3* filesystem);
-    void deinit();
+    bool deinit();      // 写回任务未能退出时返回false，保持已初始化状态（可重试）
     bool isInitialized() const { return initialized; }
     
     // 系统配置管理
@@ -40,19 +116,48 @@ public:
     
     // 每日数据管理
     const DailyDataV3& getCurrentDayData() const { return current_day_data; }
-    bool loadDailyData(const String& date, DailyDataV3& data);
+    bool loadDailyData(int32_t epoch_day, DailyDataV3& data);
+    bool loadDailySummary(int32_t epoch_day, DailyTotalV3& total);    // 只解析daily_total
     bool saveDailyData(const DailyDataV3& data);
     bool loadCurrentDayData();
-    bool saveCurrentDayData();
+    bool saveCurrentDayData();          // 标记当日数据待写回
+    
+    // 写回缓存
+    bool flushPendingWrites(bool force = false);   // force为true时立即写出全部脏记录
+    bool hasPendingWrites() const { return dirty_mask != 0; }
+    
+    // 每日数据缓存统计
+    uint32_t getCacheHits() const { return cache_hits; }
+    uint32_t getCacheMisses() const { return cache_misses; }
+    void clearDailyCache();
     
     // 历史数据管理
     std::vector<DailyDataV3> getHistoryData(uint8_t days = V3_HISTORY_DAYS);
-    bool deleteHistoryData(const String& date);
-    void cleanupOldData(uint8_t keep_days = V3_HISTORY_DAYS);
+    std::vector<DailySummaryV3> getHistorySummaries(uint8_t days = V3_HISTORY_DAYS);
+    
+    // 异步预取：请求后由写回任务加载到暂存区，UI线程不做文件读取
+    void prefetchHistorySummaries(uint8_t days = V3_HISTORY_DAYS);
+    bool takeHistorySummaries(std::vector<DailySummaryV3>& out, uint32_t* version = nullptr);    // 数据就绪且未过期时返回true
+    bool deleteHistoryData(int32_t epoch_day);
+    bool loadRollingTotals();           // 从日期索引（或每日数据文件）重新填充滚动汇总
+    bool loadTrendSeries();             // 由滚动汇总和日期索引重新填充趋势序列（需先加载滚动汇总）
+    bool rebuildHistoryIndex();         // 扫描每日数据文件重建日期索引（修复用）
+    
+    // 分层汇总：明细只保留V3_DETAIL_DAYS天，更早的数据逐级压缩为周/月汇总
+    void setBackgroundWorkAllowed(bool allowed) { background_allowed = allowed; }
+    bool runCompaction();               // 立即执行一轮压缩（通常由写回任务空闲时调用）
+    
+    // 按日期区间查询汇总（epoch-day，含首尾），不打开每日数据文件
+    int32_t getTodayEpochDay() const;
+    bool getDayTotals(int32_t epoch_day, DailyTotalV3& totals);
+    bool getRangeTotals(int32_t first_day, int32_t last_day, DailyTotalV3& totals);
+    DailyTotalV3 getRecentTotals(uint16_t days);     // 最近days天（含今天）
+    void checkDayRollover();            // 检查跨天，滚动汇总窗口
+    void cleanupOldData(uint8_t keep_days = V3_DETAIL_DAYS);   // 按保留策略删除每日明细（汇总保留）
     
     // 统计数据管理
     const HistoryStatsV3& getHistoryStats() const { return history_stats; }
-    bool updateHistoryStats();
+    bool rebuildHistoryStats();     // 全量重建（修复用），正常保存走增量更新
     bool saveHistoryStats();
     bool loadHistoryStats();
     void resetHistoryStats();
@@ -76,11 +181,15 @@ public:
     float getWeeklyCalories() const;
     uint32_t getWeeklyTime() const;
     uint8_t getWeeklyGoalsAchieved() const;
+    uint8_t getStreakDays() const;
     
-    // 趋势分析
-    std::vector<uint32_t> getJumpsTrend(uint8_t days = 7);
-    std::vector<float> getCaloriesTrend(uint8_t days = 7);
-    std::vector<uint16_t> getScoresTrend(uint8_t days = 7);
+    // 趋势分析（按时间从旧到新排列，最后一个为今天）
+    std::vector<uint32_t> getJumpsTrend(uint8_t days = 7) const;
+    std::vector<float> getCaloriesTrend(uint8_t days = 7) const;
+    std::vector<uint16_t> getScoresTrend(uint8_t days = 7) const;
+    
+    // 趋势页面用的缩放结果；version与上次相同时不复制并返回false
+    bool getTrendWindow(trend_window_v3_t which, TrendWindowV3& out, uint32_t* version = nullptr);
     
     // 目标检查
     bool isTodayTargetAchieved() const;
@@ -95,6 +204,7 @@ public:
     // 数据验证和修复
     bool validateData();
     bool repairCorruptedData();
+    uint32_t getLastSaveLatency() const { return last_save_us; }
     
     // 调试和信息
     void printDataSummary();
@@ -105,9 +215,31 @@ public:
     bool generateDemoData(uint8_t days = 7);
     
 private:
+    // 写回缓存内部实现
+    void lock() const;      // 只使用互斥量句柄，const查询也可加锁
+    void unlock() const;
+    void lockTier() const;
+    void unlockTier() const;
+    // 从日期索引批量读取last_day及之前共count天（out[i]对应last_day - i，只打开一次文件），返回有记录的天数
+    uint16_t loadIndexedDays(int32_t last_day, uint16_t count, DailyTotalV3* out, uint8_t* found);
+    void markDirty(uint8_t mask);
+    void startFlushTask();
+    bool stopFlushTask();   // 等待任务真正退出，超时返回false（停止标志保持设置）
+    static void flushTaskEntry(void* param);
+    bool writeHistoryStats(const HistoryStatsV3& stats);
+    bool writeSystemConfig(const SystemConfigV3& config);
+    bool writeTargetSettings(const TargetSettingsV3& settings);
+    void runScheduledCompaction();
+    bool cacheLookup(int32_t epoch_day, DailyDataV3& data);
+    void cacheStore(const DailyDataV3& data);
+    void cacheInvalidate(int32_t epoch_day);
+    void runScheduledRetention();
+    void runPrefetch();
+    bool ensureDayCovered(int32_t epoch_day);
+    static bool retentionGuard(int32_t epoch_day, void* ctx);
+    
     // 内部辅助函数
     void updateCurrentDate();
-    void initNTPTime();
     bool ensureDailyDataExists(const String& date);
     void updateDailyTotals();
     String generateDailyDataPath(const String& date);
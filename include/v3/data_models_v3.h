@@ -6,34 +6,51 @@
 #include <ArduinoJson.h>
 #include "board_config_v3.h"
 
-// 游戏会话数据结构
+#define V3_SESSION_FLAG_TARGET      0x01    // 本次游戏达成目标
+
+// 游戏会话记录（定长POD，无填充，不占用堆）
+// 开始时间为epoch秒；时间未同步时为当天秒数（< 86400）
+// 浮点量以定点数保存，字符串形式只在导出时生成
 struct GameSessionV3 {
-    String start_time;          // 开始时间 "HH:MM:SS"
-    uint32_t duration;          // 持续时间(秒)
-    game_difficulty_t difficulty; // 游戏难度
-    uint32_t jump_count;        // 跳跃次数
-    float calories;             // 消耗卡路里
-    float max_height;           // 最大跳跃高度
-    float avg_frequency;        // 平均跳跃频率
+    uint32_t start_epoch;       // 开始时间
+    uint16_t duration;          // 持续时间(秒)
+    uint16_t jump_count;        // 跳跃次数
+    uint16_t calories_x10;      // 消耗卡路里(0.1)
     uint16_t score;             // 游戏得分
-    bool target_achieved;       // 是否达成目标
+    uint16_t avg_frequency_x100;// 平均跳跃频率(0.01次/秒)
+    uint16_t max_height_mm;     // 最大跳跃高度(毫米)
+    uint8_t difficulty;         // 游戏难度
+    uint8_t flags;              // V3_SESSION_FLAG_*
+    uint16_t reserved;
     
     // 构造函数
-    GameSessionV3() : 
-        start_time("00:00:00"),
+    GameSessionV3() :
+        start_epoch(0),
         duration(0),
-        difficulty(DIFFICULTY_NORMAL),
         jump_count(0),
-        calories(0.0f),
-        max_height(0.0f),
-        avg_frequency(0.0f),
+        calories_x10(0),
         score(0),
-        target_achieved(false) {}
-    
-    // 序列化到JSON
-    void toJson(JsonObject& obj) const;
-    
-    // 从JSON反序列化
+        avg_frequency_x100(0),
+        max_height_mm(0),
+        difficulty(DIFFICULTY_NORMAL),
+        flags(0),
+        reserved(0) {}
+    
+    // 定点字段访问
+    float getCalories() const { return calories_x10 / 10.0f; }
+    float getAvgFrequency() const { return avg_frequency_x100 / 100.0f; }
+    float getMaxHeight() const { return max_height_mm / 1000.0f; }
+    game_difficulty_t getDifficulty() const { return (game_difficulty_t)difficulty; }
+    bool isTargetAchieved() const { return flags & V3_SESSION_FLAG_TARGET; }
+    void setCalories(float calories);
+    void setAvgFrequency(float frequency);
+    void setMaxHeight(float height);
+    void setTargetAchieved(bool achieved);
+    
+    // 序列化到JSON（for_export为true时附加"HH:MM:SS"格式的开始时间）
+    void toJson(JsonObject& obj, bool for_export = false) const;
+    
+    // 从JSON反序列化（兼容旧版"start_time"字符串）
     bool fromJson(const JsonObject& obj);
     
     // 计算得分
@@ -42,6 +59,7 @@ struct GameSessionV3 {
     // 计算卡路里
     float calculateCalories() const;
 };
+static_assert(sizeof(GameSessionV3) == 20, "GameSessionV3 must stay a 20-byte record");
 
 // 每日数据汇总结构
 struct DailyTotalV3 {
@@ -74,43 +92,89 @@ struct DailyTotalV3 {
     void addSession(const GameSessionV3& session);
 };
 
-// 每日数据结构
+// 每日数据结构（定长，会话保存在内联数组中）
 struct DailyDataV3 {
-    String date;                        // 日期 "YYYY-MM-DD"
-    std::vector<GameSessionV3> sessions; // 游戏会话列表
-    DailyTotalV3 daily_total;           // 每日汇总
+    int32_t epoch_day;                              // 日期（1970-01-01起的天数，-1表示未设置）
+    uint8_t session_count;                          // sessions中的有效条数
+    GameSessionV3 sessions[V3_MAX_DAILY_SESSIONS];  // 游戏会话（超出容量时只计入汇总）
+    DailyTotalV3 daily_total;                       // 每日汇总
     
     // 构造函数
-    DailyDataV3() : date("") {}
+    DailyDataV3() : epoch_day(-1), session_count(0) {}
     
-    DailyDataV3(const String& date_str) : date(date_str) {}
+    explicit DailyDataV3(int32_t day) : epoch_day(day), session_count(0) {}
+    
+    explicit DailyDataV3(const String& date_str);
+    
+    // 日期字符串"YYYY-MM-DD"，只用于显示、文件名和导出
+    String dateString() const;
     
     // 序列化到JSON
+    void toJson(JsonDocument& doc, bool for_export = false) const;
     String toJsonString() const;
     
-    // 从JSON字符串反序列化
+    // 从JSON反序列化
+    bool fromJson(JsonDocument& doc);
     bool fromJsonString(const String& json_str);
     
-    // 添加游戏会话
-    void addSession(const GameSessionV3& session);
+    // 只解析日期和每日汇总（配合summaryFilter过滤，不构造会话列表）
+    bool fromJsonSummary(JsonDocument& doc);
+    static void summaryFilter(JsonDocument& filter);
+    
+    // 添加游戏会话，数组已满时返回false（汇总仍然更新）
+    bool addSession(const GameSessionV3& session);
     
     // 更新每日汇总
     void updateDailyTotal();
     
     // 获取会话数量
-    size_t getSessionCount() const { return sessions.size(); }
+    size_t getSessionCount() const { return session_count; }
     
     // 检查是否为空
-    bool isEmpty() const { return sessions.empty(); }
+    bool isEmpty() const { return session_count == 0; }
+};
+
+// 只含汇总的每日记录（历史页面等只需要汇总的场景）
+struct DailySummaryV3 {
+    int32_t epoch_day;
+    DailyTotalV3 total;
+    
+    DailySummaryV3() : epoch_day(-1) {}
+    DailySummaryV3(int32_t day, const DailyTotalV3& day_total) : epoch_day(day), total(day_total) {}
+};
+
+// 最近N天每日汇总的滚动窗口（环形缓冲，常驻内存）
+struct RollingTotalsV3 {
+    DailyTotalV3 days[V3_ROLLING_DAYS]; // 每日汇总
+    uint8_t head;                       // 今天所在槽位
+    int32_t today;                      // head对应的日期（epoch-day）
+    
+    RollingTotalsV3() : head(0), today(-1) {}
+    
+    // 清空并以epoch_day作为今天
+    void reset(int32_t epoch_day);
+    
+    // 按"几天前"访问，0为今天，超出窗口返回空汇总
+    const DailyTotalV3& getDay(uint8_t days_ago) const;
+    void setDay(uint8_t days_ago, const DailyTotalV3& total);
+    
+    // 日期前进days天，新进入窗口的日期清零
+    void advance(uint16_t days, int32_t new_today);
+    
+    // 最近days天（含今天）的汇总，best_score取最大值
+    DailyTotalV3 sum(uint8_t days) const;
+    
+    // 从今天（今天没有运动则从昨天）往前的连续运动天数
+    uint8_t streak() const;
 };
 
 // 系统配置结构
 struct SystemConfigV3 {
     uint8_t volume;             // 音量 0-100
     uint8_t brightness;         // 亮度 0-100 (预留)
-    uint32_t sleep_timeout;     // 睡眠超时(秒) (预留)
+    uint32_t sleep_timeout;     // 待机空闲多久后深度睡眠(秒)
     game_difficulty_t default_difficulty; // 默认难度
-    bool auto_sleep;            // 自动睡眠 (预留)
+    bool auto_sleep;            // 空闲超时后自动深度睡眠
     bool sound_enabled;         // 声音开关
     bool vibration_enabled;     // 震动开关 (预留)
     String language;            // 语言设置 (预留)
@@ -121,15 +185,17 @@ struct SystemConfigV3 {
         brightness(70),
         sleep_timeout(300),
         default_difficulty(DIFFICULTY_NORMAL),
-        auto_sleep(false),
+        auto_sleep(true),
         sound_enabled(true),
         vibration_enabled(false),
         language("en-US") {}
     
     // 序列化到JSON
+    void toJson(JsonDocument& doc) const;
     String toJsonString() const;
     
-    // 从JSON字符串反序列化
+    // 从JSON反序列化
+    bool fromJson(JsonDocument& doc);
     bool fromJsonString(const String& json_str);
     
     // 验证配置有效性
@@ -147,8 +213,9 @@ struct HistoryStatsV3 {
     float total_calories;       // 总卡路里
     uint16_t best_score;        // 历史最佳得分
     uint16_t best_jumps;        // 单次最多跳跃
-    String best_date;           // 最佳记录日期
+    int32_t best_day;           // 最佳记录日期（epoch-day，-1表示无）
     uint8_t streak_days;        // 连续运动天数
+    int32_t last_active_day;    // 最近有运动的日期（用于增量计算连续天数）
     
     // 构造函数
     HistoryStatsV3() : 
@@ -158,18 +225,24 @@ struct HistoryStatsV3 {
         total_calories(0.0f),
         best_score(0),
         best_jumps(0),
-        best_date(""),
-        streak_days(0) {}
+        best_day(-1),
+        streak_days(0),
+        last_active_day(-1) {}
     
     // 序列化到JSON
+    void toJson(JsonDocument& doc) const;
     String toJsonString() const;
     
-    // 从JSON字符串反序列化
+    // 从JSON反序列化
+    bool fromJson(JsonDocument& doc);
     bool fromJsonString(const String& json_str);
     
-    // 更新统计数据
+    // 更新统计数据（全量重建时逐日累加）
     void updateWithDailyData(const DailyDataV3& daily_data);
     
+    // 增量更新：daily_data为已加入session后的当日数据，O(1)
+    void addSession(const GameSessionV3& session, const DailyDataV3& daily_data);
+    
     // 重置统计数据
     void reset();
 };
@@ -206,9 +279,22 @@ namespace DataUtilsV3 {
     // 时间格式化
     String formatTime(uint32_t seconds);
     String getCurrentTimeString();
-    String getCurrentDateString();
+    
+    // 日期统一使用epoch-day（1970-01-01起的天数，本地时区）作为键，字符串只用于显示和文件名
+    int32_t getEpochDay(int days_offset = 0);     // 今天（加偏移）的epoch-day
+    int32_t civilToEpochDay(int32_t year, int32_t month, int32_t day);
+    void epochDayToCivil(int32_t epoch_day, int32_t* year, int32_t* month, int32_t* day);
+    int32_t dateToEpochDay(const char* date);     // "YYYY-MM-DD" -> epoch-day，无效返回-1
+    int32_t dateToEpochDay(const String& date);
+    void formatEpochDay(int32_t epoch_day, char* buf, size_t len);    // 写入"YYYY-MM-DD"
+    String epochDayToDateString(int32_t epoch_day);
+    String getCurrentDateString();                // 仅用于显示
     String getDateString(int days_offset = 0);
     
+    // 会话开始时间（epoch秒，时间未同步时为当天秒数）
+    uint32_t getCurrentEpochSeconds();
+    void formatTimeOfDay(uint32_t epoch_seconds, char* buf, size_t len); // 写入"HH:MM:SS"
+    
     // 数据验证
     bool isValidDate(const String& date);
     bool isValidTime(const String& time);
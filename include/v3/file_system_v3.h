@@ -2,27 +2,80 @@
 #define FILE_SYSTEM_V3_H
 
 #include <Arduino.h>
-#include <SPIFFS.h>
 #include <ArduinoJson.h>
 #include <vector>
 #include "board_config_v3.h"
+#include "storage_backend_v3.h"
+#include "storage_stream_v3.h"
+#include "trace_log_v3.h"
 
 // 文件路径定义 (SPIFFS不支持真正的目录，使用扁平结构)
 #define V3_CONFIG_FILE          "/system.json"
 #define V3_DAILY_DATA_PREFIX    "/daily_"
 #define V3_STATS_FILE           "/summary.json"
-#define V3_LOG_FILE             "/system.log"
+#define V3_LOG_FILE             "/system.log"     // 定长二进制环形事件日志，见trace_log_v3.h
+#define V3_DAILY_PATH_SIZE      32      // "/daily_YYYY-MM-DD.json"加结束符
 
 // 文件系统配置
 #define V3_FS_FORMAT_ON_FAIL    true
-#define V3_MAX_FILE_SIZE        8192    // 8KB最大文件大小
-#define V3_JSON_BUFFER_SIZE     2048    // JSON缓冲区大小
+
+// 保留策略：每日明细文件有字节预算和年龄上限；SPIFFS越满写入越慢，
+// 使用率超过高水位时从最早的明细开始删除，直到低于低水位
+#ifndef V3_RETENTION_BYTE_BUDGET
+#define V3_RETENTION_BYTE_BUDGET    (192 * 1024)    // 每日明细文件总字节上限
+#endif
+#define V3_FS_HIGH_WATER_PERCENT    75.0f
+#define V3_FS_LOW_WATER_PERCENT     65.0f
+#define V3_RETENTION_MIN_DAYS       V3_HISTORY_DAYS // 最近几天的明细始终保留（历史页面使用）
+
+// 写入延迟统计：按写入时的使用率分档（每档10%）
+#define V3_FILL_BUCKETS             10
+#define V3_FILL_SAMPLE_WRITES       16              // 每16次写入刷新一次使用率缓存
+
+// 删除每日明细前的回调，返回false时保留该文件（用于确认汇总已保存）
+typedef bool (*retention_guard_cb_t)(int32_t epoch_day, void* ctx);
+
+typedef struct {
+    uint16_t files_deleted;
+    uint32_t bytes_freed;
+    uint16_t files_kept;        // 清理后剩余的每日明细文件
+    uint32_t bytes_kept;
+} retention_result_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t total_us;
+    uint32_t max_us;
+} write_latency_bucket_t;
+
+// 记录文件格式：4字节文件头 'J' 'R' 版本 编码，后接JSON或MessagePack正文
+// 没有文件头的旧JSON文件在首次读取时按当前编码重写
+#define V3_RECORD_FORMAT_JSON       0
+#define V3_RECORD_FORMAT_MSGPACK    1
+#ifndef V3_RECORD_FORMAT
+#define V3_RECORD_FORMAT            V3_RECORD_FORMAT_MSGPACK
+#endif
+#define V3_RECORD_MAGIC_0           'J'
+#define V3_RECORD_MAGIC_1           'R'
+#define V3_RECORD_VERSION           1
+#define V3_RECORD_HEADER_SIZE       4
 
 class FileSystemV3 {
 private:
+    StorageBackendV3* backend;
     bool fs_initialized;
     bool fs_available;
     
+    // 写入延迟统计
+    float fill_percent;                 // 使用率缓存，避免每次写入都查询容量
+    uint16_t writes_since_fill;
+    write_latency_bucket_t write_latency[V3_FILL_BUCKETS];
+    
+    // 事件日志：热路径只复制到内存缓冲，由写回任务调用flushTrace写出
+    TraceLogV3 trace_log;
+    portMUX_TYPE trace_mux;             // 保护内存缓冲（append/takePending）
+    SemaphoreHandle_t trace_io_mutex;   // 串行化日志文件读写（写回任务和串口命令都会访问）
+    
 public:
     FileSystemV3();
     ~FileSystemV3();
@@ -31,22 +84,37 @@ public:
     bool init();
     void deinit();
     bool isAvailable() const { return fs_available; }
+    StorageBackendV3* getBackend() const { return backend; }
+    const char* getBackendName() const { return backend ? backend->name() : "None"; }
     
     // 文件操作
     bool writeFile(const String& path, const String& content);
     String readFile(const String& path);
-    bool fileExists(const String& path);
+    bool fileExists(const char* path);
+    bool fileExists(const String& path) { return fileExists(path.c_str()); }
     bool deleteFile(const String& path);
+    bool renameFile(const String& from, const String& to);
+    bool appendFile(const String& path, const String& content);
     size_t getFileSize(const String& path);
     
     // 目录操作
     bool createDirectory(const String& path);
     std::vector<String> listFiles(const String& dir = "/");
     
-    // JSON操作
+    // JSON操作（直接在文件句柄上流式读写，不经过整文件String）
     bool writeJson(const String& path, const JsonDocument& doc);
     bool readJson(const String& path, JsonDocument& doc);
     
+    // 带版本头的记录文件（每日数据、统计、配置、目标）
+    // const char*版本供数据路径使用，避免每次读写构造String
+    bool writeRecord(const char* path, const JsonDocument& doc);
+    bool writeRecord(const String& path, const JsonDocument& doc) { return writeRecord(path.c_str(), doc); }
+    // filter非空时只解析过滤器中列出的字段（部分读取不触发格式迁移）
+    bool readRecord(const char* path, JsonDocument& doc, const JsonDocument* filter = nullptr);
+    bool readRecord(const String& path, JsonDocument& doc, const JsonDocument* filter = nullptr) {
+        return readRecord(path.c_str(), doc, filter);
+    }
+    
     // 系统信息
     size_t getTotalBytes();
     size_t getUsedBytes();
@@ -55,18 +123,35 @@ public:
     
     // 维护操作
     void formatFileSystem();
-    void cleanupOldFiles(int keep_days = V3_HISTORY_DAYS);
+    // 删除超过keep_days天的明细，再按字节预算和高水位删除最早的明细
+    retention_result_t cleanupOldFiles(int keep_days = V3_HISTORY_DAYS,
+                                       size_t byte_budget = V3_RETENTION_BYTE_BUDGET,
+                                       retention_guard_cb_t guard = nullptr, void* ctx = nullptr);
+    bool isAboveHighWater() const { return fill_percent >= V3_FS_HIGH_WATER_PERCENT; }
     void printFileSystemInfo();
     
-    // 数据文件路径生成
-    String getDailyDataPath(const String& date);
+    // 事件日志（V3_LOG_FILE）
+    void trace(trace_event_v3_t event, uint16_t arg0 = 0, uint32_t arg1 = 0);
+    bool flushTrace();
+    void printTraceLog(uint16_t max_records = 32);
+    void dumpTraceLogHex();             // 输出十六进制，供主机端trace_decode解码
+    
+    // 写入延迟与使用率的关系
+    void printWriteLatencyReport();
+    void resetWriteLatencyStats();
+    
+    // 数据文件路径生成：以epoch-day为键，文件名仍为"YYYY-MM-DD"以兼容已有文件
+    static void formatDailyDataPath(int32_t epoch_day, char* buf, size_t len);
+    static int32_t parseDailyDataPath(const char* path);    // 非每日数据文件返回-1
+    String getDailyDataPath(int32_t epoch_day);
     String getCurrentDailyDataPath();
     
 private:
     void createDefaultDirectories();
     bool ensureDirectoryExists(const String& path);
-    String getDateString(int days_offset = 0);
-    void logOperation(const String& operation, const String& path, bool success);
+    void logOperation(const char* operation, const char* path, bool success, uint32_t bytes = 0);
+    void refreshFillLevel();
+    void recordWriteLatency(uint32_t elapsed_us);
 };
 
 // 全局文件系统实例声明
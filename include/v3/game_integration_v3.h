@@ -10,6 +10,19 @@
 #include "jumping_rocket_simple.h"
 #endif
 
+// V3.0 UI循环配置：UI的按键处理、更新和渲染都在显示任务中执行
+#define V3_UI_TICK_MS               100     // 无按键时的动画刷新节拍（10FPS）
+#define V3_UI_EVENT_QUEUE_SIZE      8
+
+// 按键到画面延迟统计（微秒），从按键被识别到对应画面发送到屏幕
+typedef struct {
+    uint32_t count;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t dropped;           // UI事件队列满时丢弃的按键
+} v3_ui_latency_stats_t;
+
 // V3.0游戏状态枚举
 typedef enum {
     V3_GAME_DISABLED = 0,   // V3.0功能禁用
@@ -29,6 +42,17 @@ typedef enum {
  */
 bool initGameIntegrationV3();
 
+/**
+ * 标记V3.0启动加载结束（成功或失败都要调用），之后待机画面才不再显示加载动画
+ */
+void markV3SetupFinished();
+
+/**
+ * V3.0是否仍在启动加载（快速启动时与显示任务并行）
+ * @return 加载未结束返回true
+ */
+bool isV3SetupPending();
+
 /**
  * 检查是否应该进入V3.0 UI模式
  * @return 如果应该进入UI模式返回true
@@ -53,15 +77,36 @@ bool isInV3UIMode();
 
 /**
  * 更新V3.0 UI模式
- * 在主循环中调用，处理UI逻辑和状态转换
+ * 由UI循环调用，处理UI逻辑和状态转换
  */
 void updateV3UIMode();
 
 /**
  * 渲染V3.0 UI模式
- * 在显示任务中调用，绘制UI界面
+ * 由UI循环调用，绘制UI界面
+ * @return 本帧有内容发送到屏幕返回true
+ */
+bool renderV3UIMode();
+
+/**
+ * 投递按钮事件到V3.0 UI循环（可在任意任务中调用）
+ * @param event 按钮事件
+ * @param detect_us 按键被识别时的micros()，用于统计按键到画面延迟
+ * @return 事件已投递返回true
+ */
+bool postV3UIButton(button_event_t event, uint32_t detect_us);
+
+/**
+ * 运行一次V3.0 UI循环：等待按键事件（最多V3_UI_TICK_MS），依次处理按键、更新和渲染
+ * 在显示任务中调用，UI状态只在这个任务中修改
+ */
+void runV3UIFrame();
+
+/**
+ * 获取/打印按键到画面延迟统计
  */
-void renderV3UIMode();
+void getV3UILatencyStats(v3_ui_latency_stats_t* stats);
+void printV3UILatencyStats();
 
 /**
  * 处理V3.0 UI模式的按钮事件
@@ -269,14 +314,15 @@ bool importV3DataFromJson(const String& json_data);
     #define V3_ON_GAME_RESUME() onV2GameResume()
     #define V3_ON_GAME_RESET() onV2GameReset()
     
-    #define V3_UPDATE_UI() updateV3UIMode()
-    #define V3_RENDER_UI() renderV3UIMode()
+    #define V3_RUN_UI() runV3UIFrame()
+    #define V3_POST_UI_BUTTON(event, detect_us) postV3UIButton(event, detect_us)
     #define V3_HANDLE_BUTTON(event) handleV3UIButton(event)
     
     #define V3_SHOULD_ENTER_UI() shouldEnterV3UIMode()
     #define V3_ENTER_UI() enterV3UIMode()
     #define V3_EXIT_UI() exitV3UIMode()
     #define V3_IS_IN_UI() isInV3UIMode()
+    #define V3_IS_LOADING() isV3SetupPending()
 #else
     // V3.0功能禁用时的空宏
     #define V3_ON_GAME_START(difficulty) do {} while(0)
@@ -286,14 +332,15 @@ bool importV3DataFromJson(const String& json_data);
     #define V3_ON_GAME_RESUME() do {} while(0)
     #define V3_ON_GAME_RESET() do {} while(0)
     
-    #define V3_UPDATE_UI() do {} while(0)
-    #define V3_RENDER_UI() do {} while(0)
+    #define V3_RUN_UI() do {} while(0)
+    #define V3_POST_UI_BUTTON(event, detect_us) false
     #define V3_HANDLE_BUTTON(event) false
     
     #define V3_SHOULD_ENTER_UI() false
     #define V3_ENTER_UI() do {} while(0)
     #define V3_EXIT_UI() do {} while(0)
     #define V3_IS_IN_UI() false
+    #define V3_IS_LOADING() false
 #endif
 
 #endif // GAME_INTEGRATION_V3_H
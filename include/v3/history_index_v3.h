@@ -0,0 +1,89 @@
+#ifndef HISTORY_INDEX_V3_H
+#define HISTORY_INDEX_V3_H
+
+// 按日期索引的历史汇总（不依赖Arduino，主机上也可编译）
+// 文件内容：16字节文件头 + 从base_day开始每天一条的定长记录，
+// 记录保存截至当天的累计值，任意日期区间的汇总只需读两条记录
+#include "storage_backend_v3.h"
+
+#define V3_HISTORY_INDEX_FILE       "/history.idx"
+#define V3_HISTORY_INDEX_VERSION    1
+#define V3_HISTORY_INDEX_MAX_DAYS   4000      // 约11年，防止错误时间导致文件暴涨
+
+#define V3_INDEX_FLAG_HAS_DATA      0x01      // 当天有游戏记录
+
+// 单日（或区间）汇总，卡路里为0.1定点数
+typedef struct {
+    uint32_t jumps;
+    uint32_t duration;          // 秒
+    uint32_t calories_x10;      // 0.1卡路里
+    uint32_t sessions;
+    uint32_t targets;
+    uint16_t best_score;        // 区间查询不计算此项
+} day_totals_v3_t;
+
+// 索引记录：截至当天的累计值
+typedef struct __attribute__((packed)) {
+    uint32_t cum_jumps;
+    uint32_t cum_duration;
+    uint32_t cum_calories_x10;
+    uint32_t cum_sessions;
+    uint32_t cum_targets;
+    uint16_t best_score;        // 当天最佳得分
+    uint8_t flags;
+    uint8_t reserved;
+} history_index_entry_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t magic[2];           // 'J' 'I'
+    uint8_t version;
+    uint8_t entry_size;
+    uint32_t base_day;          // 第一条记录的epoch-day
+    uint32_t count;             // 记录条数
+    uint32_t reserved;
+} history_index_header_t;
+
+class HistoryIndexV3 {
+public:
+    HistoryIndexV3();
+
+    // 加载索引文件，文件不存在或损坏时返回false（此时索引为空，可调用setDay重建）
+    bool begin(StorageBackendV3* storage, const char* file_path = V3_HISTORY_INDEX_FILE);
+    bool isLoaded() const { return backend != nullptr; }
+    bool isEmpty() const { return header.count == 0; }
+    uint32_t firstDay() const { return header.base_day; }
+    uint32_t lastDay() const { return header.base_day + header.count - 1; }
+    uint32_t dayCount() const { return header.count; }
+
+    // 写入某天的汇总：最后一天及之后为O(1)，更早的日期需要改写后续记录
+    bool setDay(uint32_t epoch_day, const day_totals_v3_t& totals);
+
+    // 查询某天汇总，日期不在索引范围内返回false
+    bool getDay(uint32_t epoch_day, day_totals_v3_t* out);
+    bool hasData(uint32_t epoch_day);
+
+    // 顺序读取从first_day开始的count天（一次打开文件），返回实际读取的天数
+    uint32_t getDays(uint32_t first_day, uint32_t count, day_totals_v3_t* out);
+
+    // 区间[first_day, last_day]汇总，O(1)
+    bool getRange(uint32_t first_day, uint32_t last_day, day_totals_v3_t* out);
+
+    // 删除epoch_day之前的记录（已并入周/月汇总），其余记录改为相对新起点的累计值
+    bool trimBefore(uint32_t epoch_day);
+
+    bool clear();
+    size_t fileSize() const;
+
+private:
+    bool readEntry(StorageFileV3* file, uint32_t index, history_index_entry_t* entry);
+    bool writeEntry(StorageFileV3* file, uint32_t index, const history_index_entry_t& entry);
+    bool writeHeader(StorageFileV3* file);
+    bool prependDays(uint32_t epoch_day, const day_totals_v3_t& totals);
+
+    StorageBackendV3* backend;
+    std::string path;
+    history_index_header_t header;
+    history_index_entry_t last_entry;   // 缓存最后一条记录
+};
+
+#endif // HISTORY_INDEX_V3_H
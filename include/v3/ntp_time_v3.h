@@ -4,6 +4,10 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+class FileSystemV3;
 
 // NTP服务器配置
 #define NTP_SERVER_PRIMARY   "pool.ntp.org"
@@ -14,64 +18,106 @@
 #define TIME_ZONE_OFFSET     8
 #define DAYLIGHT_OFFSET      0
 
+// Wi-Fi凭据（通过build_flags传入，为空时只使用保存的时间，不联网）
+#ifndef V3_WIFI_SSID
+#define V3_WIFI_SSID         ""
+#endif
+#ifndef V3_WIFI_PASSWORD
+#define V3_WIFI_PASSWORD     ""
+#endif
+
 // NTP同步配置
 #define NTP_SYNC_INTERVAL    (6 * 60 * 60 * 1000UL)  // 6小时同步一次
-#define NTP_TIMEOUT          10000                    // 10秒超时
+#define NTP_RETRY_INTERVAL   (10 * 60 * 1000UL)      // 同步失败后10分钟再试
+#define NTP_TIMEOUT          10000                    // 10秒超时（连接和同步各自计时）
 #define NTP_RETRY_COUNT      3                        // 重试次数
 
+// 时间持久化：定期保存当前时间和时钟漂移，重启后日期不回退到备用日期
+#define V3_TIME_FILE             "/time.json"
+#define NTP_PERSIST_INTERVAL     (15 * 60 * 1000UL)  // 15分钟保存一次
+#define NTP_DRIFT_MIN_SPAN_S     3600                // 两次同步间隔超过1小时才计算漂移
+#define NTP_DRIFT_MAX_PPM        500.0f              // 超出此值视为测量异常
+
+// 后台任务配置
+#define NTP_TASK_STACK_SIZE      4096
+#define NTP_TASK_PRIORITY        1                   // 与写回任务相同，低于业务任务
+#define NTP_TASK_CHECK_MS        1000
+
+#define NTP_VALID_EPOCH          946684800           // 2000-01-01 00:00:00 UTC
+
+// 当前时间来源，按可信度递增
+typedef enum {
+    V3_TIME_SOURCE_NONE = 0,        // 无有效时间（使用备用日期）
+    V3_TIME_SOURCE_RESTORED,        // 从文件恢复的上次时间（断电期间不计，只可能偏早）
+    V3_TIME_SOURCE_RTC,             // 复位前已有时间，RTC计时延续
+    V3_TIME_SOURCE_NTP              // 本次启动已与NTP同步
+} time_source_v3_t;
+
 class NTPTimeV3 {
 private:
     bool initialized;
-    bool time_synced;
-    unsigned long last_sync_time;
+    volatile uint8_t time_source;           // time_source_v3_t，任务写、任意线程读
+    volatile bool sync_requested;
+    volatile bool sync_allowed;             // 游戏中不开Wi-Fi，避免影响传感器采样
+    volatile bool task_stop;
+    TaskHandle_t task_handle;
+    FileSystemV3* fs;
+
+    unsigned long last_sync_time;           // millis()
     unsigned long last_sync_attempt;
+    unsigned long last_persist_time;
+    portMUX_TYPE sync_mux;                  // 保护同步点与漂移（任务写、任意线程读，64位读写在C3上不是原子的）
+    int64_t sync_mono_us;                   // 最近一次同步时的单调时钟
+    time_t sync_epoch;                      // 最近一次同步得到的时间
+    float drift_ppm;                        // 本地时钟相对NTP的漂移（正数表示本地偏慢）
+    uint32_t sync_count;
+    uint32_t sync_failures;
     String current_ntp_server;
-    
-    // 内部方法
+
+    // 内部方法（仅在后台任务中调用，可以阻塞）
+    bool connectWiFi(unsigned long timeout_ms);
+    void disconnectWiFi();
     bool connectToNTP(const char* server);
     bool waitForTimeSync(unsigned long timeout_ms);
+    bool syncTime();
+    void syncTimeIfNeeded();
+    void updateDrift(time_t epoch, int64_t mono_us);
     void logTimeSync(bool success);
 
+    // 持久化
+    bool loadPersistedTime();
+    bool persistTime();
+
+    static void taskEntry(void* param);
+
 public:
     NTPTimeV3();
     ~NTPTimeV3();
-    
-    // 初始化和管理
-    bool init();
+
+    // 初始化和管理：只恢复时间并启动后台任务，不等待网络
+    bool init(FileSystemV3* filesystem);
     void deinit();
     bool isInitialized() const { return initialized; }
-    bool isTimeSynced() const { return time_synced; }
-    
-    // 时间同步
-    bool syncTime();
-    bool syncTimeIfNeeded();
-    void forceSync();
+    bool isTimeSynced() const { return time_source == V3_TIME_SOURCE_NTP; }
+
+    // 时间同步（由后台任务执行）
+    void forceSync() { sync_requested = true; }
+    void setSyncAllowed(bool allowed) { sync_allowed = allowed; }
     unsigned long getLastSyncTime() const { return last_sync_time; }
-    
-    // 时间获取
-    String getCurrentDateString();
-    String getCurrentTimeString();
-    String getCurrentDateTimeString();
-    String getDateString(int days_offset = 0);
-    
-    // 时间信息
-    struct tm getCurrentTime();
+    float getDriftPpm() const { return drift_ppm; }
+
+    // 时间有效性：只读一个变量，数据层可随时调用
+    bool isValidTime() const { return time_source != V3_TIME_SOURCE_NONE; }
+    time_source_v3_t getTimeSource() const { return (time_source_v3_t)time_source; }
+
+    // 时间获取（已按漂移修正；无有效时间时返回0）
     time_t getCurrentTimestamp();
-    bool isValidTime();
-    
-    // 格式化
-    String formatDate(const struct tm& timeinfo);
-    String formatTime(const struct tm& timeinfo);
-    String formatDateTime(const struct tm& timeinfo);
-    
+    bool getCurrentTime(struct tm* timeinfo);
+    String getCurrentDateTimeString();
+
     // 调试信息
     void printTimeInfo();
-    String getTimeZoneInfo();
-    String getNTPServerInfo();
-    
-    // 静态工具函数
-    static bool isLeapYear(int year);
-    static int getDaysInMonth(int year, int month);
+    static const char* getTimeSourceName(time_source_v3_t source);
     static String formatTimestamp(time_t timestamp);
 };
 
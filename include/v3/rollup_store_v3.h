@@ -0,0 +1,86 @@
+#ifndef ROLLUP_STORE_V3_H
+#define ROLLUP_STORE_V3_H
+
+// 分层汇总：日(history.idx) -> 周 -> 月 -> 累计，不依赖Arduino
+// 各层覆盖的日期区间互不重叠：累计 < 月 < 周 < day_tier_start <= 日期索引
+#include <vector>
+#include "history_index_v3.h"
+
+#define V3_ROLLUP_FILE              "/rollup.bin"
+#define V3_ROLLUP_VERSION           1
+
+#ifndef V3_DETAIL_DAYS
+#define V3_DETAIL_DAYS              35    // 保留逐次会话明细（每日数据文件）的天数
+#endif
+#ifndef V3_DAY_TIER_DAYS
+#define V3_DAY_TIER_DAYS            120   // 日期索引保留天数（覆盖90天趋势）
+#endif
+#ifndef V3_WEEK_TIER_WEEKS
+#define V3_WEEK_TIER_WEEKS          52    // 周汇总保留条数
+#endif
+#ifndef V3_MONTH_TIER_MONTHS
+#define V3_MONTH_TIER_MONTHS        120   // 月汇总保留条数，更早的并入累计
+#endif
+
+// 周/月汇总记录
+typedef struct __attribute__((packed)) {
+    uint32_t start_day;         // 周一或月首日的epoch-day
+    uint32_t jumps;
+    uint32_t duration;
+    uint32_t calories_x10;
+    uint32_t sessions;
+    uint32_t targets;
+    uint32_t max_day_jumps;     // 单日最多跳跃
+    uint16_t best_score;
+    uint16_t active_days;       // 有运动的天数
+} rollup_record_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t magic[2];           // 'J' 'U'
+    uint8_t version;
+    uint8_t record_size;
+    uint32_t day_tier_start;    // 日期索引负责的第一天，之前的数据已进入周/月汇总（0表示尚未压缩）
+    uint16_t week_count;
+    uint16_t month_count;
+    rollup_record_t carry;      // 超出月汇总保留期的累计值
+} rollup_header_t;
+
+class RollupStoreV3 {
+public:
+    RollupStoreV3();
+
+    // 加载汇总文件到内存（文件不存在视为空），损坏时返回false
+    bool begin(StorageBackendV3* storage, const char* file_path = V3_ROLLUP_FILE);
+    bool save();
+
+    // 执行最多max_steps步压缩（日->周、周->月、月->累计），返回执行的步数
+    int compact(HistoryIndexV3& index, uint32_t today, int max_steps = 16);
+
+    // 全部时间的汇总，代价与保留的周/月条数成正比，与使用年限无关
+    void getLifetime(HistoryIndexV3& index, rollup_record_t* out, uint32_t* best_day = nullptr);
+
+    // 区间汇总：周/月记录按起始日是否落在区间内整条计入
+    bool getRange(HistoryIndexV3& index, uint32_t first_day, uint32_t last_day, day_totals_v3_t* out);
+
+    uint32_t dayTierStart() const { return header.day_tier_start; }
+    size_t weekCount() const { return weeks.size(); }
+    size_t monthCount() const { return months.size(); }
+    size_t fileSize() const;
+
+    static uint32_t weekStart(uint32_t epoch_day);     // 所在周的周一
+    static uint32_t monthStart(uint32_t epoch_day);    // 所在月的1日
+
+private:
+    bool compactDayToWeek(HistoryIndexV3& index, uint32_t today);
+    bool finishTrim(HistoryIndexV3& index);     // 裁剪索引中已并入周汇总的日期
+    bool compactWeekToMonth();
+    bool compactMonthToCarry();
+
+    StorageBackendV3* backend;
+    std::string path;
+    rollup_header_t header;
+    std::vector<rollup_record_t> weeks;
+    std::vector<rollup_record_t> months;
+};
+
+#endif // ROLLUP_STORE_V3_H
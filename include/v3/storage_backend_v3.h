@@ -0,0 +1,213 @@
+#ifndef STORAGE_BACKEND_V3_H
+#define STORAGE_BACKEND_V3_H
+
+// 存储后端接口 - 不依赖Arduino，主机(Linux)上也可编译运行
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// 存储后端类型（编译期选择）
+#define V3_STORAGE_SPIFFS           0     // SPIFFS（默认）
+#define V3_STORAGE_LITTLEFS         1     // LittleFS（使用同一个spiffs分区）
+#define V3_STORAGE_RAM              2     // 内存文件系统（掉电丢失，用于测试）
+#define V3_STORAGE_POSIX            3     // POSIX文件（主机目录或ESP-IDF VFS挂载点）
+
+#ifndef V3_STORAGE_BACKEND
+#define V3_STORAGE_BACKEND          V3_STORAGE_SPIFFS
+#endif
+
+// RAM后端容量
+#ifndef V3_RAM_STORAGE_CAPACITY
+#define V3_RAM_STORAGE_CAPACITY     (32 * 1024)
+#endif
+
+// POSIX后端根目录和配额（配额模拟分区大小，与partitions_v3.csv一致）
+#ifndef V3_POSIX_STORAGE_ROOT
+#ifdef ARDUINO
+#define V3_POSIX_STORAGE_ROOT       "/spiffs"
+#else
+#define V3_POSIX_STORAGE_ROOT       "./flash_v3"
+#endif
+#endif
+
+#ifndef V3_POSIX_STORAGE_MAX_FILES
+#define V3_POSIX_STORAGE_MAX_FILES  8       // 设备上SPIFFS VFS同时打开的文件数
+#endif
+
+#ifndef V3_POSIX_STORAGE_QUOTA
+#define V3_POSIX_STORAGE_QUOTA      0x160000
+#endif
+
+// 文件打开模式
+typedef enum {
+    V3_OPEN_READ = 0,       // 只读
+    V3_OPEN_WRITE,          // 截断写入
+    V3_OPEN_APPEND,         // 追加写入
+    V3_OPEN_UPDATE          // 读写，不截断（不存在则创建），用于原地更新
+} storage_open_mode_t;
+
+// 打开的文件句柄，delete时自动关闭
+class StorageFileV3 {
+public:
+    virtual ~StorageFileV3() {}
+
+    virtual size_t read(uint8_t* buf, size_t len) = 0;
+    virtual size_t write(const uint8_t* buf, size_t len) = 0;
+    virtual bool seek(size_t pos) = 0;
+    virtual size_t position() = 0;
+    virtual size_t size() = 0;
+    virtual void flush() {}
+};
+
+// 目录遍历回调：path为完整路径（以'/'开头）
+typedef void (*storage_list_cb_t)(const char* path, size_t size, void* ctx);
+
+// 存储后端基类
+class StorageBackendV3 {
+public:
+    virtual ~StorageBackendV3() {}
+
+    // 挂载和管理
+    virtual const char* name() const = 0;
+    virtual bool begin(bool format_on_fail) = 0;
+    virtual void end() = 0;
+    virtual bool format() = 0;
+
+    // 文件操作（path均以'/'开头）
+    virtual StorageFileV3* open(const char* path, storage_open_mode_t mode) = 0;
+    virtual bool exists(const char* path) = 0;
+    virtual bool stat(const char* path, size_t* size) = 0;
+    virtual bool remove(const char* path) = 0;
+    virtual bool rename(const char* from, const char* to) = 0;
+    virtual int list(const char* dir, storage_list_cb_t cb, void* ctx) = 0;
+
+    // 容量信息
+    virtual size_t totalBytes() = 0;
+    virtual size_t usedBytes() = 0;
+
+    // 便捷方法（基于open实现）
+    bool writeAll(const char* path, const uint8_t* data, size_t len);
+    bool append(const char* path, const uint8_t* data, size_t len);
+    size_t readAt(const char* path, size_t offset, uint8_t* buf, size_t len);
+};
+
+// 内存文件系统
+class RamStorageBackendV3 : public StorageBackendV3 {
+public:
+    struct Entry {
+        std::string path;
+        std::vector<uint8_t> data;
+        int open_count = 0;         // 打开的文件句柄数
+        bool unlinked = false;      // 已删除（或被rename覆盖），最后一个句柄关闭时释放
+    };
+
+    explicit RamStorageBackendV3(size_t capacity = V3_RAM_STORAGE_CAPACITY);
+
+    const char* name() const override { return "RAM"; }
+    bool begin(bool format_on_fail) override;
+    void end() override;
+    bool format() override;
+
+    StorageFileV3* open(const char* path, storage_open_mode_t mode) override;
+    bool exists(const char* path) override;
+    bool stat(const char* path, size_t* size) override;
+    bool remove(const char* path) override;
+    bool rename(const char* from, const char* to) override;
+    int list(const char* dir, storage_list_cb_t cb, void* ctx) override;
+
+    size_t totalBytes() override { return capacity; }
+    size_t usedBytes() override { return used; }
+
+    // 供文件句柄调用的容量记账
+    bool reserve(size_t bytes);
+    void release(size_t bytes);
+    void closeEntry(Entry* entry);
+
+private:
+    Entry* find(const char* path);
+    void dropEntry(size_t index);
+
+    std::vector<Entry*> entries;
+    size_t capacity;
+    size_t used;
+    bool mounted;
+};
+
+// POSIX文件后端（主机目录，或ESP32上通过VFS访问的挂载点）
+class PosixStorageBackendV3 : public StorageBackendV3 {
+public:
+    explicit PosixStorageBackendV3(const char* root = V3_POSIX_STORAGE_ROOT,
+                                   size_t quota = V3_POSIX_STORAGE_QUOTA);
+
+    const char* name() const override { return "POSIX"; }
+    bool begin(bool format_on_fail) override;
+    void end() override;
+    bool format() override;
+
+    StorageFileV3* open(const char* path, storage_open_mode_t mode) override;
+    bool exists(const char* path) override;
+    bool stat(const char* path, size_t* size) override;
+    bool remove(const char* path) override;
+    bool rename(const char* from, const char* to) override;
+    int list(const char* dir, storage_list_cb_t cb, void* ctx) override;
+
+    size_t totalBytes() override { return quota; }
+    size_t usedBytes() override;
+
+private:
+    std::string fullPath(const char* path) const;
+
+    std::string root;
+    size_t quota;
+    bool mounted;
+};
+
+#ifdef ARDUINO
+#include <FS.h>
+
+// Arduino fs::FS 通用实现（SPIFFS和LittleFS共用）
+class ArduinoFSStorageBackendV3 : public StorageBackendV3 {
+public:
+    explicit ArduinoFSStorageBackendV3(fs::FS& filesystem) : vfs(filesystem) {}
+
+    StorageFileV3* open(const char* path, storage_open_mode_t mode) override;
+    bool exists(const char* path) override;
+    bool stat(const char* path, size_t* size) override;
+    bool remove(const char* path) override;
+    bool rename(const char* from, const char* to) override;
+    int list(const char* dir, storage_list_cb_t cb, void* ctx) override;
+
+protected:
+    fs::FS& vfs;
+};
+
+class SPIFFSStorageBackendV3 : public ArduinoFSStorageBackendV3 {
+public:
+    SPIFFSStorageBackendV3();
+
+    const char* name() const override { return "SPIFFS"; }
+    bool begin(bool format_on_fail) override;
+    void end() override;
+    bool format() override;
+    size_t totalBytes() override;
+    size_t usedBytes() override;
+};
+
+class LittleFSStorageBackendV3 : public ArduinoFSStorageBackendV3 {
+public:
+    LittleFSStorageBackendV3();
+
+    const char* name() const override { return "LittleFS"; }
+    bool begin(bool format_on_fail) override;
+    void end() override;
+    bool format() override;
+    size_t totalBytes() override;
+    size_t usedBytes() override;
+};
+#endif // ARDUINO
+
+// 根据V3_STORAGE_BACKEND返回编译期选定的后端实例
+StorageBackendV3* getStorageBackendV3();
+
+#endif // STORAGE_BACKEND_V3_H
@@ -0,0 +1,57 @@
+#ifndef STORAGE_BENCH_V3_H
+#define STORAGE_BENCH_V3_H
+
+// 存储后端基准测试 - 同一套用例跑所有后端（设备端和主机端共用）
+#include "storage_backend_v3.h"
+
+#define V3_BENCH_SMALL_FILE_COUNT   20        // 小文件写读次数
+#define V3_BENCH_SMALL_FILE_SIZE    256       // 小文件大小（约一条会话JSON）
+#define V3_BENCH_STREAM_SIZE        (16 * 1024) // 吞吐量测试文件大小
+#define V3_BENCH_CHUNK_SIZE         512       // 吞吐量测试分块大小
+#define V3_BENCH_APPEND_COUNT       100       // 追加记录次数
+#define V3_BENCH_APPEND_SIZE        64        // 单条追加记录大小
+#define V3_BENCH_FILL_FILE_SIZE     1024      // 填充测试单文件大小
+#define V3_BENCH_FILL_LIMIT         90        // 填充测试上限（使用率%）
+#define V3_BENCH_FILL_BUCKETS       10        // 按使用率每10%一档统计
+
+// 单档填充统计
+typedef struct {
+    uint32_t writes;
+    uint32_t avg_us;
+    uint32_t max_us;
+} storage_bench_bucket_t;
+
+// 基准测试结果
+typedef struct {
+    const char* backend_name;
+    bool success;
+
+    // 小文件写读延迟
+    uint32_t small_write_avg_us;
+    uint32_t small_write_max_us;
+    uint32_t small_read_avg_us;
+    uint32_t small_read_max_us;
+
+    // 顺序吞吐量（KB/s）
+    float write_kbps;
+    float read_kbps;
+
+    // 追加记录延迟
+    uint32_t append_avg_us;
+    uint32_t append_max_us;
+
+    // 不同使用率下的写入延迟
+    storage_bench_bucket_t fill[V3_BENCH_FILL_BUCKETS];
+    uint32_t fill_files;
+    float fill_reached_percent;
+} storage_bench_result_t;
+
+// 运行基准测试（只创建和删除"/bench_"前缀的文件）
+// 填充测试会把分区写到90%，在真实flash上耗时较长，默认开机测试中不运行
+bool runStorageBenchmarkV3(StorageBackendV3* backend, storage_bench_result_t* result,
+                           bool include_fill = true);
+
+// 打印测试结果
+void printStorageBenchmarkV3(const storage_bench_result_t* result);
+
+#endif // STORAGE_BENCH_V3_H
@@ -0,0 +1,52 @@
+#ifndef STORAGE_STREAM_V3_H
+#define STORAGE_STREAM_V3_H
+
+// 文件句柄上的缓冲读写适配器，满足ArduinoJson自定义Reader/Writer接口，
+// 序列化/反序列化直接在文件上进行，不经过整文件String
+#include "storage_backend_v3.h"
+
+#ifndef V3_STREAM_BUFFER_SIZE
+#define V3_STREAM_BUFFER_SIZE       256   // 读写缓冲大小
+#endif
+
+// 缓冲读取：int read() / size_t readBytes(char*, size_t)
+class StorageReaderV3 {
+public:
+    explicit StorageReaderV3(StorageFileV3* file);
+
+    int read();
+    size_t readBytes(char* buf, size_t len);
+
+private:
+    bool fill();
+
+    StorageFileV3* file;
+    uint8_t buffer[V3_STREAM_BUFFER_SIZE];
+    size_t pos;
+    size_t len;
+};
+
+// 缓冲写入：size_t write(uint8_t) / size_t write(const uint8_t*, size_t)
+// 析构时不自动flush，调用方需检查flush()的返回值
+class StorageWriterV3 {
+public:
+    explicit StorageWriterV3(StorageFileV3* file);
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buf, size_t n);
+    bool flush();
+
+    size_t bytesWritten() const { return total; }
+    bool hasError() const { return error; }
+
+private:
+    bool drain();   // 缓冲写入文件
+
+    StorageFileV3* file;
+    uint8_t buffer[V3_STREAM_BUFFER_SIZE];
+    size_t used;
+    size_t total;
+    bool error;
+};
+
+#endif // STORAGE_STREAM_V3_H
@@ -0,0 +1,102 @@
+#ifndef TRACE_LOG_V3_H
+#define TRACE_LOG_V3_H
+
+// 定长二进制环形事件日志（不依赖Arduino，主机解码工具共用）
+// 文件内容：16字节文件头 + capacity条16字节记录，创建时一次性预分配，之后只原地覆盖，
+// 文件大小不变；写入位置由序号决定（slot = (seq - 1) % capacity），启动时扫描一次找到最大序号
+#include "storage_backend_v3.h"
+#include <vector>
+
+#define V3_TRACE_VERSION            1
+#ifndef V3_TRACE_CAPACITY
+#define V3_TRACE_CAPACITY           512       // 8KB，约几天的文件操作和事件
+#endif
+#define V3_TRACE_BUFFER_SIZE        32        // 内存中待写出的记录数，满时丢弃新记录
+
+// 记录标志
+#define V3_TRACE_FLAG_EPOCH         0x01      // timestamp为epoch秒（否则为启动后毫秒）
+
+// 文件编号（arg0）：每日明细为 0x8000 | epoch-day，其它已知文件为小编号，未知文件为路径哈希
+#define V3_TRACE_FILE_DAILY         0x8000
+#define V3_TRACE_FILE_HASHED        0x4000
+
+// 事件编号，只能追加，已写入flash的编号含义不能改变
+typedef enum {
+    V3_TRACE_NONE = 0,
+    V3_TRACE_BOOT,              // arg0=版本号 arg1=复位原因
+    V3_TRACE_FILE_WRITE,        // arg0=文件编号 arg1=字节数
+    V3_TRACE_FILE_WRITE_FAIL,   // arg0=文件编号
+    V3_TRACE_FILE_READ_FAIL,    // arg0=文件编号
+    V3_TRACE_FILE_DELETE,       // arg0=文件编号
+    V3_TRACE_FILE_RENAME,       // arg0=原文件编号
+    V3_TRACE_SESSION_SAVED,     // arg0=跳跃次数 arg1=得分
+    V3_TRACE_DAY_ROLLOVER,      // arg1=新的epoch-day
+    V3_TRACE_NTP_SYNC,          // arg1=时钟漂移(0.1ppm，有符号)
+    V3_TRACE_NTP_FAIL,          // arg1=累计失败次数
+    V3_TRACE_RETENTION,         // arg0=删除文件数 arg1=释放字节数
+    V3_TRACE_COMPACTION,        // arg0=压缩步数 arg1=耗时(ms)
+    V3_TRACE_EVENT_COUNT
+} trace_event_v3_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t seq;               // 全局递增序号，0表示空槽
+    uint32_t timestamp;
+    uint8_t event;
+    uint8_t flags;
+    uint16_t arg0;
+    uint32_t arg1;
+} trace_record_v3_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t magic[2];           // 'J' 'L'
+    uint8_t version;
+    uint8_t record_size;
+    uint32_t capacity;
+    uint32_t reserved[2];
+} trace_header_v3_t;
+
+// 非线程安全：append和takePending由调用方加锁，writeRecords在锁外执行
+class TraceLogV3 {
+public:
+    TraceLogV3();
+
+    // 打开（必要时预分配）日志文件并恢复写入位置
+    bool begin(StorageBackendV3* storage, const char* file_path, uint32_t capacity = V3_TRACE_CAPACITY);
+    bool isOpen() const { return backend != nullptr; }
+    uint32_t capacity() const { return header.capacity; }
+    uint32_t nextSeq() const { return next_seq; }
+    uint32_t dropped() const { return dropped_count; }
+    size_t pendingCount() const { return pending_count; }
+
+    // 热路径：只复制到内存缓冲
+    bool append(uint8_t event, uint8_t flags, uint32_t timestamp, uint16_t arg0, uint32_t arg1);
+
+    // 取出待写出的记录，之后在锁外调用writeRecords
+    size_t takePending(trace_record_v3_t* out, size_t max);
+    bool writeRecords(const trace_record_v3_t* records, size_t count);
+
+    // 按序号顺序读取全部有效记录
+    bool readAll(std::vector<trace_record_v3_t>* out);
+    bool clear();
+
+    // 解码工具（设备和主机共用）
+    static bool decode(const uint8_t* data, size_t len, std::vector<trace_record_v3_t>* out);
+    static const char* eventName(uint8_t event);
+    static uint16_t fileId(const char* path);
+    static int formatRecord(const trace_record_v3_t& record, char* buf, size_t len);
+
+private:
+    bool preallocate();
+    size_t slotOffset(uint32_t seq) const;
+
+    StorageBackendV3* backend;
+    std::string path;
+    trace_header_v3_t header;
+    uint32_t next_seq;
+    uint32_t dropped_count;
+
+    trace_record_v3_t pending[V3_TRACE_BUFFER_SIZE];
+    size_t pending_count;
+};
+
+#endif // TRACE_LOG_V3_H
@@ -0,0 +1,64 @@
+#ifndef TREND_SERIES_V3_H
+#define TREND_SERIES_V3_H
+
+// 趋势序列（不依赖Arduino）：最近V3_TREND_DAYS天的每日跳跃数，以及7/30/90天三个窗口
+// 按窗口最大值缩放好的柱高，趋势页面只需遍历一个小整数数组绘制
+// 保存会话时只更新今天一个点，只有今天成为窗口新最大值时才重新缩放该窗口
+#include <stdint.h>
+#include <stddef.h>
+
+#define V3_TREND_DAYS               90
+#define V3_TREND_PLOT_HEIGHT        24        // 柱高像素上限（128x64屏幕上副标题和页码之间的绘图区）
+
+typedef enum {
+    V3_TREND_WINDOW_7D = 0,
+    V3_TREND_WINDOW_30D,
+    V3_TREND_WINDOW_90D,
+    V3_TREND_WINDOW_COUNT
+} trend_window_v3_t;
+
+// 一个窗口的缩放结果，按时间从旧到新排列，最后一个为今天
+struct TrendWindowV3 {
+    uint8_t days;
+    uint32_t max_value;                       // 窗口内最大每日跳跃数，0表示没有数据
+    uint8_t heights[V3_TREND_DAYS];           // 0..V3_TREND_PLOT_HEIGHT，有数据的日期至少为1
+
+    TrendWindowV3() : days(0), max_value(0) {}
+};
+
+class TrendSeriesV3 {
+public:
+    TrendSeriesV3();
+
+    // 清空并以epoch_day作为今天
+    void reset(int32_t epoch_day);
+
+    // 批量加载：按"几天前"写入原始值，全部写完后调用rescaleAll
+    void setDay(uint16_t days_ago, uint32_t value);
+    void rescaleAll();
+
+    // 增量更新：今天的值增加delta
+    void addToday(uint32_t delta);
+
+    // 日期前进到new_today，移出窗口的日期丢弃，新日期为0
+    void advance(int32_t new_today);
+
+    int32_t today() const { return today_day; }
+    uint32_t version() const { return change_count; }   // 每次变化递增，UI据此判断是否需要重新复制
+    uint32_t getDay(uint16_t days_ago) const;
+    const TrendWindowV3& window(trend_window_v3_t which) const { return windows[which]; }
+
+    static uint8_t windowDays(trend_window_v3_t which);
+    static const char* windowName(trend_window_v3_t which);
+
+private:
+    void rescale(TrendWindowV3& w);
+    static uint8_t scale(uint32_t value, uint32_t max_value);
+
+    uint32_t values[V3_TREND_DAYS];           // 从旧到新，values[V3_TREND_DAYS - 1]为今天
+    int32_t today_day;
+    uint32_t change_count;
+    TrendWindowV3 windows[V3_TREND_WINDOW_COUNT];
+};
+
+#endif // TREND_SERIES_V3_H
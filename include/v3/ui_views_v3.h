@@ -5,6 +5,12 @@
 #include <U8g2lib.h>
 #include "board_config_v3.h"
 #include "data_models_v3.h"
+#include "ui_widgets_v3.h"
+#include "trend_series_v3.h"
+
+// 主菜单光标在History上停留多久后开始预取历史数据
+#define V3_HISTORY_PREFETCH_DWELL_MS    300
+#define V3_HISTORY_REFRESH_MS           5000    // 历史页面后台刷新间隔
 
 // UI视图状态枚举
 typedef enum {
@@ -27,12 +33,13 @@ struct MenuItemV3 {
         title(t), description(d), target_view(tv), enabled(e) {}
 };
 
-// UI视图基类
+// UI视图基类：每个视图持有一棵控件树，render只把变化的控件发送到屏幕
 class UIViewV3 {
 protected:
     U8G2* display;
     bool active;
     uint32_t last_update_time;
+    UIScreenV3 screen;
     
 public:
     UIViewV3(U8G2* disp) : display(disp), active(false), last_update_time(0) {}
@@ -49,13 +56,13 @@ public:
     bool isActive() const { return active; }
     void setActive(bool state) { active = state; }
     
+    // 屏幕被其它界面覆盖后调用，下一帧整屏重绘
+    void invalidate() { screen.invalidateAll(); }
+    uint32_t getFlushCount() const { return screen.getFlushCount(); }
+    
 protected:
-    // 通用绘制方法
-    void drawTitle(const String& title, int y = 12);
-    void drawMenuItem(const String& text, int y, bool selected = false);
-    void drawProgressBar(int x, int y, int width, int height, float progress);
-    void drawValue(const String& label, const String& value, int y);
-    void drawCenteredText(const String& text, int y);
+    // 选中项闪烁：每500ms切换一次显示状态
+    static bool blinkOn(uint32_t period_ms = 500, uint32_t since = 0) { return ((millis() - since) / period_ms) % 2 == 0; }
 };
 
 // 主菜单视图
@@ -64,6 +71,9 @@ private:
     std::vector<MenuItemV3> menu_items;
     int selected_index;
     uint32_t animation_time;
+    uint32_t selection_time;        // 光标移到当前项的时间
+    bool prefetch_requested;
+    UIListV3 menu_list;
     
 public:
     MainMenuViewV3(U8G2* disp);
@@ -79,9 +89,6 @@ public:
 private:
     void initMenuItems();
     void updateSelection(int direction);
-    void renderMenuItems();
-    void renderStatusBar();
-    void drawMenuItemWithBlink(const String& text, int y, bool selected);
 };
 
 // 难度选择视图
@@ -92,6 +99,13 @@ private:
     uint32_t animation_time;
     bool selection_confirmed;
     
+    UILabelV3 title_label;
+    UIListV3 option_list;
+    UILabelV3 detail_label;
+    UILabelV3 confirm_name_label;
+    UILabelV3 confirm_ready_label;
+    UILabelV3 confirm_prompt_label;
+    
 public:
     DifficultySelectViewV3(U8G2* disp);
     
@@ -108,18 +122,31 @@ public:
 private:
     void updateSelection(int direction);
     void confirmSelection();
-    void renderDifficultyOptions();
-    void renderDifficultyDetails();
-    void renderConfirmation();
+    void bindDifficultyOptions();
+    void bindConfirmation();
 };
 
 // 历史数据视图
 class HistoryViewV3 : public UIViewV3 {
 private:
-    std::vector<DailyDataV3> history_data;
+    std::vector<DailySummaryV3> history_data;   // 最近几天的每日汇总（不含会话列表）
+    bool history_loaded;                        // false时每日页面显示加载占位
+    uint32_t history_version;                   // 当前显示数据对应的数据版本
     int current_page;
     int total_pages;
     uint32_t last_data_update;
+    uint32_t loading_start;
+    TrendWindowV3 trend_window;                 // 当前趋势页面的柱高（数据管理器预先缩放好）
+    uint32_t trend_version;
+    int trend_shown;                            // trend_window对应的窗口，-1表示无
+    
+    UILabelV3 title_label;
+    UIValueV3 value_rows[4];
+    UILabelV3 message_label;
+    UILabelV3 message_label2;
+    UILabelV3 subtitle_label;
+    UIBarChartV3 trend_chart;
+    UILabelV3 page_label;
     
 public:
     HistoryViewV3(U8G2* disp);
@@ -131,13 +158,17 @@ public:
     bool handleButton(button_event_t event) override;
     
 private:
-    void loadHistoryData();
+    void requestHistoryData();
+    void pollHistoryData();
     void updatePage(int direction);
-    void renderHistoryPage();
-    void renderDayData(const DailyDataV3& data, int y);
-    void renderSummaryPage();
-    void renderWeeklyPage();
-    void renderTrendPage();
+    void showRows(bool show);
+    void showMessage(const char* line1, int16_t y1, const char* line2 = nullptr, int16_t y2 = 0);
+    void bindHistoryPage();
+    void bindDayData(const DailyTotalV3& total);
+    void bindLoadingPlaceholder();
+    void bindSummaryPage();
+    void bindWeeklyPage();
+    void bindTrendPage(trend_window_v3_t which);
 };
 
 // 设置视图
@@ -152,11 +183,18 @@ private:
     // 轮播显示相关
     int display_start_index;  // 当前显示的第一个设置项索引
     static const int MAX_VISIBLE_ITEMS = 5;  // 屏幕最多显示5个设置项
+    
+    UILabelV3 title_label;
+    UIListV3 item_list;
+    UIScrollBarV3 scroll_bar;
+    UILabelV3 edit_label;
 
     enum SettingItem {
         SETTING_VOLUME = 0,
         SETTING_DIFFICULTY,
         SETTING_SOUND_ENABLED,
+        SETTING_AUTO_SLEEP,
+        SETTING_SLEEP_TIMEOUT,
         SETTING_TARGET_ENABLED,
         SETTING_TARGET_JUMPS,
         SETTING_TARGET_TIME,
@@ -183,12 +221,10 @@ private:
     void updateSelection(int direction);
     void toggleEditMode();
     void adjustValue(int direction);
-    void renderSettingItems();
-    void renderEditIndicator();
-    void renderScrollIndicator();  // 渲染滚动指示器
+    void bindSettingItems();
     void updateDisplayWindow();  // 更新轮播显示窗口
-    String getSettingName(int index);
-    String getSettingValue(int index);
+    const char* getSettingName(int index);
+    void formatSettingValue(int index, char* buf, size_t len);
 };
 
 // 目标计时视图
@@ -199,6 +235,12 @@ private:
     uint32_t target_duration;
     bool timer_active;
     bool target_achieved;
+    uint32_t shown_elapsed;         // 计时文字对应的秒数，秒数不变时不重新格式化
+    
+    UILabelV3 title_label;
+    UILabelV3 target_label;
+    UILabelV3 timer_label;
+    UIProgressBarV3 progress_bar;
     
 public:
     TargetTimerViewV3(U8G2* disp);
@@ -217,9 +259,7 @@ private:
     void startTimer();
     void stopTimer();
     void checkTargetAchievement();
-    void renderTimer();
-    void renderProgress();
-    void renderTargetInfo();
+    void bindTimer();
 };
 
 // UI管理器
@@ -246,10 +286,11 @@ public:
     void deinit();
     
     void update();
-    void render();
+    bool render();                  // 返回本帧是否有内容发送到屏幕
     bool handleButton(button_event_t event);
     
     void switchToView(ui_view_t view);
+    void invalidate();              // 其它界面占用过屏幕后整屏重绘当前视图
     ui_view_t getCurrentView() const { return current_view; }
     ui_view_t getPreviousView() const { return previous_view; }
     
@@ -270,7 +311,7 @@ extern UIManagerV3* uiManagerV3;
 bool initUIManagerV3(U8G2* display);
 void deinitUIManagerV3();
 void updateUIV3();
-void renderUIV3();
+bool renderUIV3();
 bool handleUIButtonV3(button_event_t event);
 
 #endif // UI_VIEWS_V3_H
@@ -0,0 +1,242 @@
+#ifndef UI_WIDGETS_V3_H
+#define UI_WIDGETS_V3_H
+
+// 保留模式控件层：控件缓存格式化后的文字和上次绘制的区域，绑定的值变化时才重绘，
+// 只把变化的区域（按8x8 tile对齐）发送到屏幕，内容不变的帧不产生I2C传输
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include <vector>
+
+#define V3_UI_TEXT_MAX              40      // 单个控件文字最大长度（含结束符）
+#define V3_UI_MAX_DIRTY_RECTS       6       // 超出后合并为外接矩形
+#define V3_UI_FULL_FLUSH_TILES      64      // 脏区域超过一半屏幕（128个tile）时直接整屏发送
+#define V3_UI_SCREEN_WIDTH          128
+#define V3_UI_SCREEN_HEIGHT         64
+#define V3_UI_CHART_MAX_POINTS      90      // 柱状图最多柱数（90天趋势）
+
+// 文字对齐方式
+typedef enum {
+    UI_ALIGN_LEFT = 0,
+    UI_ALIGN_CENTER,
+    UI_ALIGN_RIGHT
+} ui_align_v3_t;
+
+struct UIRectV3 {
+    int16_t x, y, w, h;
+
+    UIRectV3() : x(0), y(0), w(0), h(0) {}
+    UIRectV3(int16_t rx, int16_t ry, int16_t rw, int16_t rh) : x(rx), y(ry), w(rw), h(rh) {}
+
+    bool isEmpty() const { return w <= 0 || h <= 0; }
+    bool intersects(const UIRectV3& other) const {
+        return !isEmpty() && !other.isEmpty() &&
+               x < other.x + other.w && other.x < x + w && y < other.y + other.h && other.y < y + h;
+    }
+    UIRectV3 unite(const UIRectV3& other) const;
+};
+
+// 一帧内的脏区域，render结束时发送到屏幕
+class UIDirtyRegionV3 {
+private:
+    UIRectV3 rects[V3_UI_MAX_DIRTY_RECTS];     // tile坐标
+    uint8_t count;
+    bool full;
+
+public:
+    UIDirtyRegionV3() : count(0), full(false) {}
+
+    void add(const UIRectV3& pixel_rect);
+    void markFull() { full = true; }
+    bool isEmpty() const { return !full && count == 0; }
+
+    // 发送脏区域并清空；返回发送的tile数
+    uint16_t flush(U8G2* display);
+    void clear() { count = 0; full = false; }
+};
+
+// 控件基类：一帧分两步，先擦除所有脏控件上次占用的区域（与之重叠的控件一并标记重绘），
+// 再绘制所有脏控件，擦除和绘制的区域计入脏区域
+class UIWidgetV3 {
+protected:
+    UIRectV3 bounds;        // 上次绘制占用的区域
+    bool dirty;
+    bool visible;
+
+    virtual UIRectV3 measure(U8G2* display) = 0;
+    virtual void draw(U8G2* display) = 0;
+
+public:
+    UIWidgetV3() : dirty(true), visible(true) {}
+    virtual ~UIWidgetV3() {}
+
+    virtual void invalidate() { dirty = true; }
+    virtual bool isDirty() const { return dirty; }
+    virtual void setVisible(bool state);
+    bool isVisible() const { return visible; }
+    // 与擦除区域重叠时标记重绘，返回是否新标记
+    virtual bool invalidateIntersecting(const UIRectV3& rect);
+
+    // 整屏清空后调用：上次区域已不存在，不需要擦除
+    virtual void resetBounds() { bounds = UIRectV3(); dirty = true; }
+
+    // 返回擦除的区域
+    virtual UIRectV3 erase(U8G2* display, UIDirtyRegionV3& region);
+    virtual void paint(U8G2* display, UIDirtyRegionV3& region);
+
+    // 擦除脏控件，重叠的控件级联标记重绘并擦除；返回擦除区域的外接矩形
+    static UIRectV3 eraseDirty(std::vector<UIWidgetV3*>& widgets, U8G2* display, UIDirtyRegionV3& region);
+};
+
+// 单行文字
+class UILabelV3 : public UIWidgetV3 {
+protected:
+    char text[V3_UI_TEXT_MAX];
+    const uint8_t* font;
+    int16_t x, y;
+    ui_align_v3_t align;
+
+    UIRectV3 measure(U8G2* display) override;
+    void draw(U8G2* display) override;
+
+public:
+    UILabelV3(int16_t lx, int16_t ly, const uint8_t* f = u8g2_font_6x10_tf, ui_align_v3_t a = UI_ALIGN_LEFT);
+
+    // 文字与缓存相同时不标记重绘
+    void setText(const char* value);
+    void setTextf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void setFont(const uint8_t* f);
+    void setPosition(int16_t lx, int16_t ly);
+    const char* getText() const { return text; }
+};
+
+// 左侧标签 + 右对齐数值的一行
+class UIValueV3 : public UIWidgetV3 {
+private:
+    char label[V3_UI_TEXT_MAX];
+    char value[V3_UI_TEXT_MAX];
+    int32_t bound_value;
+    bool has_bound_value;
+    int16_t y;
+
+protected:
+    UIRectV3 measure(U8G2* display) override;
+    void draw(U8G2* display) override;
+
+public:
+    UIValueV3(int16_t ly, const char* l = "");
+
+    void setLabel(const char* l);   // 标签变化时清除绑定的值
+    void setValue(const char* v);
+    void setValue(int32_t v);       // 整数值相同时不重新格式化
+
+    // 绑定任意整数键（如秒数），返回true时调用方需要重新格式化并setValue
+    bool bind(int32_t key);
+};
+
+// 进度条：按填充像素宽度比较，变化不足1像素时不重绘
+class UIProgressBarV3 : public UIWidgetV3 {
+private:
+    int16_t x, y, w, h;
+    int16_t fill_width;
+
+protected:
+    UIRectV3 measure(U8G2* display) override;
+    void draw(U8G2* display) override;
+
+public:
+    UIProgressBarV3(int16_t bx, int16_t by, int16_t bw, int16_t bh);
+
+    void setProgress(float progress);
+};
+
+// 竖直滚动条（设置页面右侧）
+class UIScrollBarV3 : public UIWidgetV3 {
+private:
+    int16_t x, y, h;
+    int16_t thumb_y, thumb_h;
+
+protected:
+    UIRectV3 measure(U8G2* display) override;
+    void draw(U8G2* display) override;
+
+public:
+    UIScrollBarV3(int16_t bx, int16_t by, int16_t bh);
+
+    void setWindow(int first, int visible_count, int total);
+};
+
+// 柱状图：柱高由调用方预先缩放好，柱高数组不变时不重绘
+class UIBarChartV3 : public UIWidgetV3 {
+private:
+    int16_t x, baseline, w, h;      // baseline为基线所在行，柱向上生长，最高h像素
+    uint8_t heights[V3_UI_CHART_MAX_POINTS];
+    uint8_t count;
+
+protected:
+    UIRectV3 measure(U8G2* display) override;
+    void draw(U8G2* display) override;
+
+public:
+    UIBarChartV3(int16_t bx, int16_t by, int16_t bw, int16_t bh);
+
+    void setBars(const uint8_t* values, uint8_t n);
+};
+
+// 文字列表：每行是一个独立标签，选中行通过setHighlightVisible实现闪烁，只重绘变化的行
+class UIListV3 : public UIWidgetV3 {
+private:
+    std::vector<UILabelV3> rows;
+    std::vector<UIWidgetV3*> row_widgets;
+    int selected;
+    bool highlight_visible;
+
+    void updateRowVisibility();
+
+protected:
+    UIRectV3 measure(U8G2* display) override { return UIRectV3(); }
+    void draw(U8G2* display) override {}
+
+public:
+    UIListV3(int16_t lx, int16_t ly, int16_t row_height, uint8_t row_count, const uint8_t* f = u8g2_font_6x10_tf);
+
+    uint8_t getRowCount() const { return rows.size(); }
+    void setRow(uint8_t index, const char* text);
+    void setSelected(int index);
+    void setHighlightVisible(bool state);
+
+    void invalidate() override;
+    bool isDirty() const override;
+    void setVisible(bool state) override;
+    bool invalidateIntersecting(const UIRectV3& rect) override;
+    void resetBounds() override;
+    UIRectV3 erase(U8G2* display, UIDirtyRegionV3& region) override;
+    void paint(U8G2* display, UIDirtyRegionV3& region) override;
+};
+
+// 控件树根节点：每个视图一个，render只发送本帧变化的区域
+class UIScreenV3 {
+private:
+    std::vector<UIWidgetV3*> widgets;
+    UIDirtyRegionV3 region;
+    volatile bool needs_clear;      // 视图切换或屏幕被其它界面占用后整屏重绘
+    bool blanked;
+    uint32_t flush_count;           // 发送到屏幕的帧数
+
+public:
+    UIScreenV3() : needs_clear(true), blanked(false), flush_count(0) {}
+
+    void add(UIWidgetV3* widget) { widgets.push_back(widget); }
+
+    // 下一帧清屏并重绘所有控件（可在其它任务中调用）
+    void invalidateAll() { needs_clear = true; }
+
+    // 绘制脏控件并发送脏区域；返回是否有内容发送到屏幕
+    bool render(U8G2* display);
+
+    // 熄屏（闪烁效果），重复调用不重复发送
+    void blank(U8G2* display);
+
+    uint32_t getFlushCount() const { return flush_count; }
+};
+
+#endif // UI_WIDGETS_V3_H
@@ -72,6 +72,11 @@ bool board_config_validate(void) {
         Serial.println("❌ 错误: 按钮和蜂鸣器引脚不能相同!");
         is_valid = false;
     }
+
+    if (MPU_INT_PIN == BUTTON_PIN || MPU_INT_PIN == BUZZER_PIN) {
+        Serial.println("❌ 错误: MPU6050 INT引脚与其他功能引脚冲突!");
+        is_valid = false;
+    }
     
     if (I2C_SDA_PIN == BUTTON_PIN || I2C_SDA_PIN == BUZZER_PIN) {
         Serial.println("❌ 错误: I2C SDA引脚与其他功能引脚冲突!");
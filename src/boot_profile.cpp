@@ -0,0 +1,89 @@
+#include "jumping_rocket_simple.h"
+#include "dlog.h"
+#include <esp_timer.h>
+
+// 启动阶段计时：各任务在初始化的关键点调用boot_mark，记录从复位开始的时间，
+// 首个可交互画面出现时输出一行汇总，完整时间线通过串口命令boot查看
+typedef struct {
+    const char* name;
+    uint32_t time_us;
+} boot_phase_t;
+
+static boot_phase_t boot_phases[BOOT_MAX_PHASES];
+static uint8_t boot_phase_count = 0;
+static volatile bool boot_complete = false;     // 首个画面之后不再记录，显示循环中的调用直接返回
+static portMUX_TYPE boot_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void boot_mark(const char* phase) {
+    if (boot_complete) return;
+
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+    bool recorded = false;
+
+    portENTER_CRITICAL(&boot_mux);
+    bool exists = false;
+    for (uint8_t i = 0; i < boot_phase_count; i++) {
+        if (strcmp(boot_phases[i].name, phase) == 0) {
+            exists = true;
+            break;
+        }
+    }
+    if (!exists && boot_phase_count < BOOT_MAX_PHASES) {
+        boot_phases[boot_phase_count].name = phase;
+        boot_phases[boot_phase_count].time_us = now_us;
+        boot_phase_count++;
+        recorded = true;
+    }
+    if (strcmp(phase, BOOT_PHASE_FIRST_FRAME) == 0) {
+        boot_complete = true;
+    }
+    portEXIT_CRITICAL(&boot_mux);
+
+    if (recorded && boot_complete) {
+        DLOG_I("🚀 首个可交互画面: %lu ms（启动时间线: 串口命令 boot）\n", now_us / 1000);
+    }
+}
+
+uint32_t boot_get_phase_ms(const char* phase) {
+    uint32_t time_us = 0;
+    portENTER_CRITICAL(&boot_mux);
+    for (uint8_t i = 0; i < boot_phase_count; i++) {
+        if (strcmp(boot_phases[i].name, phase) == 0) {
+            time_us = boot_phases[i].time_us;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&boot_mux);
+    return time_us / 1000;
+}
+
+void boot_print_timeline(void) {
+    boot_phase_t phases[BOOT_MAX_PHASES];
+    uint8_t count;
+    portENTER_CRITICAL(&boot_mux);
+    count = boot_phase_count;
+    memcpy(phases, boot_phases, count * sizeof(boot_phase_t));
+    portEXIT_CRITICAL(&boot_mux);
+
+    // 各任务并行记录，按时间排序后输出
+    for (uint8_t i = 1; i < count; i++) {
+        boot_phase_t phase = phases[i];
+        int j = i - 1;
+        while (j >= 0 && phases[j].time_us > phase.time_us) {
+            phases[j + 1] = phases[j];
+            j--;
+        }
+        phases[j + 1] = phase;
+    }
+
+    Serial.printf("🚀 启动时间线 (%s启动):\n", FAST_BOOT_ENABLED ? "快速" : "完整");
+    uint32_t prev_us = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        Serial.printf("   %-14s %7.1f ms  (+%.1f ms)\n", phases[i].name,
+                     phases[i].time_us / 1000.0f, (phases[i].time_us - prev_us) / 1000.0f);
+        prev_us = phases[i].time_us;
+    }
+    if (!boot_complete) {
+        Serial.println("   （尚未显示首个可交互画面）");
+    }
+}
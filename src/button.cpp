@@ -19,8 +19,14 @@ static uint32_t button_press_time = 0;
 static uint32_t button_release_time = 0;
 static bool button_long_press_triggered = false;
 
-// 按钮事件队列
+// 按钮事件队列（连同识别时间，转交V3.0 UI时按识别时刻统计延迟）
+typedef struct {
+    button_event_t event;
+    uint32_t detect_us;
+} button_queued_event_t;
+
 static QueueHandle_t button_event_queue = NULL;
+static uint32_t button_event_detect_us = 0;    // 最近一次button_get_event取出的事件的识别时间（游戏任务使用）
 
 // 获取按钮当前状态
 static bool get_button_state(void) {
@@ -76,13 +82,14 @@ static button_event_t detect_button_event(void) {
 
 // 获取按钮事件
 button_event_t button_get_event(void) {
-    button_event_t event = BUTTON_EVENT_NONE;
+    button_queued_event_t queued;
     
-    if (button_event_queue) {
-        xQueueReceive(button_event_queue, &event, 0);
+    if (button_event_queue && xQueueReceive(button_event_queue, &queued, 0) == pdTRUE) {
+        button_event_detect_us = queued.detect_us;
+        return queued.event;
     }
     
-    return event;
+    return BUTTON_EVENT_NONE;
 }
 
 // 按钮任务
@@ -100,13 +107,21 @@ void button_task(void* pvParameters) {
                  pin, (active_level == HIGH) ? "高电平" : "低电平");
 
     // 创建按钮事件队列
-    button_event_queue = xQueueCreate(5, sizeof(button_event_t));
+    button_event_queue = xQueueCreate(5, sizeof(button_queued_event_t));
     if (!button_event_queue) {
         Serial.println("按钮事件队列创建失败");
         vTaskDelete(NULL);
         return;
     }
 
+    // 按键唤醒时按键可能还没松开，松开前不产生事件（最多等待3秒，避免引脚悬空时卡住）
+    if (deep_sleep_get_wake_source() == DEEP_SLEEP_WAKE_BUTTON) {
+        uint32_t wait_start = millis();
+        while (get_button_state() == BUTTON_PRESSED && millis() - wait_start < 3000) {
+            delay(10);
+        }
+    }
+
     // 初始化按钮状态
     button_last_state = get_button_state();
     button_release_time = millis();
@@ -119,6 +134,11 @@ void button_task(void* pvParameters) {
                  (button_last_state == BUTTON_PRESSED) ? "按下" : "释放", pin);
 
     while (1) {
+        telemetry_loop_tick(TELEMETRY_TASK_BUTTON);
+        if (deep_sleep_pending()) {
+            deep_sleep_park(DEEP_SLEEP_PARK_BUTTON);
+        }
+
         bool current_button_state = get_button_state();
         uint32_t current_time = millis();
 
@@ -141,11 +161,19 @@ void button_task(void* pvParameters) {
         }
 
         // 检测按钮事件
+        uint32_t detect_us = micros();
         button_event_t event = detect_button_event();
 
         // 如果有事件，发送到队列
         if (event != BUTTON_EVENT_NONE) {
-            if (xQueueSend(button_event_queue, &event, 0) != pdTRUE) {
+            deep_sleep_note_activity();
+            bool delivered = false;
+#ifdef JUMPING_ROCKET_V3
+            // V3.0 UI模式下直接投递给UI循环，不经过游戏任务的50ms轮询
+            delivered = V3_IS_IN_UI() && V3_POST_UI_BUTTON(event, detect_us);
+#endif
+            button_queued_event_t queued = { event, detect_us };
+            if (!delivered && xQueueSend(button_event_queue, &queued, 0) != pdTRUE) {
                 Serial.println("按钮事件队列已满，丢弃事件");
             }
         }
@@ -164,13 +192,8 @@ void handle_button_event(button_event_t event) {
 #ifdef JUMPING_ROCKET_V3
     // V3.0 UI模式按钮处理
     if (V3_IS_IN_UI()) {
-        if (V3_HANDLE_BUTTON(event)) {
-            Serial.println("🎨 V3.0 UI处理了按钮事件");
-            return; // V3.0 UI处理了事件
-        }
-        // V3.0 UI没有处理事件，可能需要退出UI模式
-        Serial.println("🎨 V3.0 UI未处理按钮事件，退出UI模式");
-        V3_EXIT_UI();
+        // 进入UI模式前排队的事件也交给UI循环处理，UI状态只在显示任务中修改
+        V3_POST_UI_BUTTON(event, button_event_detect_us);
         return;
     }
 #endif
@@ -180,15 +203,17 @@ void handle_button_event(button_event_t event) {
             // 待机状态下，按钮处理
             if (event == BUTTON_EVENT_SHORT_PRESS || event == BUTTON_EVENT_LONG_PRESS) {
 #ifdef JUMPING_ROCKET_V3
-                // V3.0模式：进入UI模式
-                Serial.println("🔘 按钮触发，进入V3.0 UI模式");
-                V3_ENTER_UI();
-#else
+                // V3.0模式：由显示任务进入UI模式（UI状态只在显示任务中修改），这里不处理
+                if (V3_IS_LOADING() || V3_SHOULD_ENTER_UI()) {
+                    Serial.println("🔘 等待显示任务进入V3.0 UI模式");
+                    break;
+                }
+                // V3.0加载失败时按V2.0处理
+#endif
                 // V2.0模式：直接进入难度选择
                 Serial.println("🔘 按钮触发，进入难度选择界面");
                 current_state = GAME_STATE_DIFFICULTY_SELECT;
                 difficulty_select_init();
-#endif
             }
             break;
 
@@ -1,4 +1,5 @@
 #include "jumping_rocket_simple.h"
+#include "dlog.h"
 
 // 数据统计结构
 typedef struct {
@@ -10,7 +11,8 @@ typedef struct {
     uint32_t best_time_ms;          // 最佳游戏时长
 } game_statistics_t;
 
-static game_statistics_t game_stats = {0};
+// 放在RTC内存中，深度睡眠唤醒后保留（上电时清零）
+RTC_DATA_ATTR static game_statistics_t game_stats = {0};
 
 // 跳跃频率分析
 #define JUMP_FREQUENCY_WINDOW   5000    // 5秒窗口
@@ -31,7 +33,7 @@ void add_jump_record(uint32_t timestamp) {
     
     jump_record_index = (jump_record_index + 1) % MAX_JUMP_RECORDS;
     
-    Serial.printf("添加跳跃记录: %lu\n", timestamp);
+    DLOG_D("添加跳跃记录: %lu\n", timestamp);
 }
 
 // 计算跳跃频率（每分钟跳跃次数）
@@ -50,7 +52,7 @@ float calculate_jump_frequency(void) {
     // 计算每分钟跳跃频率
     float frequency = (float)valid_jumps * 60000.0f / JUMP_FREQUENCY_WINDOW;
     
-    Serial.printf("跳跃频率: %.1f 次/分钟\n", frequency);
+    DLOG_D("跳跃频率: %.1f 次/分钟\n", frequency);
     return frequency;
 }
 
@@ -79,7 +81,7 @@ float calculate_exercise_intensity(void) {
     // 限制强度范围 0-10
     if (intensity > 10.0f) intensity = 10.0f;
     
-    Serial.printf("运动强度: %.1f\n", intensity);
+    DLOG_D("运动强度: %.1f\n", intensity);
     return intensity;
 }
 
@@ -93,7 +95,7 @@ float calculate_calories_burned(void) {
     
     float total_calories = calories_from_jumps + calories_from_time;
     
-    Serial.printf("估算卡路里消耗: %.1f\n", total_calories);
+    DLOG_D("估算卡路里消耗: %.1f\n", total_calories);
     return total_calories;
 }
 
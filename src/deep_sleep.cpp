@@ -0,0 +1,263 @@
+#include "jumping_rocket_simple.h"
+#include "dlog.h"
+#include <esp_sleep.h>
+#include <freertos/event_groups.h>
+#include <sys/time.h>
+
+#ifdef JUMPING_ROCKET_V3
+#include "v3/game_integration_v3.h"
+#endif
+
+// 深度睡眠：待机状态空闲超时后，各任务在循环开头停止（传感器任务把MPU6050切换到低功耗动作检测），
+// 写出V3.0数据后进入深度睡眠，由MPU6050动作中断或按键唤醒。唤醒相当于重新启动，
+// 跳过开机动画和提示音直接回到待机画面；需要跨睡眠保留的少量状态放在RTC内存中
+//
+// 唤醒延迟从应用启动（esp_timer起点）计到首个可交互画面（V3.0版本为V3.0菜单的首帧，
+// V3.0加载期间只显示开机动画），不含ROM和二级引导程序的时间，
+// 可在sdkconfig打开CONFIG_BOOTLOADER_SKIP_VALIDATE_IN_DEEP_SLEEP缩短后者
+
+#define DEEP_SLEEP_RTC_MAGIC        0x534C5031  // "SLP1"
+
+// 跨深度睡眠保留的状态（上电时magic无效则清零）
+typedef struct {
+    uint32_t magic;
+    uint32_t sleep_count;           // 累计睡眠次数
+    int64_t sleep_time_us;          // 入睡时的RTC时间（gettimeofday，深度睡眠期间继续计时）
+    uint32_t awake_ms;              // 上次唤醒到入睡的时长
+    uint8_t motion_armed;           // 入睡时是否启用了动作唤醒
+    uint8_t latency_count;
+    uint8_t latency_head;
+    uint16_t latency_ms[DEEP_SLEEP_LATENCY_HISTORY];
+} deep_sleep_rtc_t;
+
+RTC_DATA_ATTR static deep_sleep_rtc_t deep_sleep_rtc;
+
+static deep_sleep_wake_t deep_sleep_wake = DEEP_SLEEP_WAKE_NONE;
+static uint32_t deep_sleep_slept_s = 0;             // 本次唤醒前的睡眠时长
+static bool deep_sleep_enabled = DEEP_SLEEP_ENABLED;
+static uint32_t deep_sleep_timeout_ms = DEEP_SLEEP_DEFAULT_TIMEOUT_S * 1000UL;
+static volatile uint32_t deep_sleep_last_activity = 0;
+static volatile bool deep_sleep_requested = false;  // 串口命令sleep now
+static volatile bool deep_sleep_parking = false;
+static bool deep_sleep_latency_recorded = false;
+static EventGroupHandle_t deep_sleep_events = NULL;
+
+static const char* deep_sleep_wake_name(deep_sleep_wake_t wake) {
+    switch (wake) {
+        case DEEP_SLEEP_WAKE_BUTTON: return "按键";
+        case DEEP_SLEEP_WAKE_MOTION: return "动作";
+        case DEEP_SLEEP_WAKE_OTHER: return "其它";
+        default: return "上电/复位";
+    }
+}
+
+static int64_t deep_sleep_rtc_time_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+// 按唤醒原因和唤醒引脚区分唤醒源
+static deep_sleep_wake_t deep_sleep_read_wake_source(void) {
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+#if CONFIG_IDF_TARGET_ESP32C3
+    if (cause == ESP_SLEEP_WAKEUP_GPIO) {
+        uint64_t pins = esp_sleep_get_gpio_wakeup_status();
+        if (pins & (1ULL << BUTTON_PIN)) return DEEP_SLEEP_WAKE_BUTTON;
+        if (pins & (1ULL << MPU_INT_PIN)) return DEEP_SLEEP_WAKE_MOTION;
+        return DEEP_SLEEP_WAKE_OTHER;
+    }
+#else
+    if (cause == ESP_SLEEP_WAKEUP_EXT0) return DEEP_SLEEP_WAKE_BUTTON;
+    if (cause == ESP_SLEEP_WAKEUP_EXT1) return DEEP_SLEEP_WAKE_MOTION;
+#endif
+    return cause == ESP_SLEEP_WAKEUP_UNDEFINED ? DEEP_SLEEP_WAKE_NONE : DEEP_SLEEP_WAKE_OTHER;
+}
+
+void deep_sleep_init(void) {
+    deep_sleep_wake = deep_sleep_read_wake_source();
+    deep_sleep_last_activity = millis();
+    deep_sleep_events = xEventGroupCreate();
+
+    if (deep_sleep_rtc.magic != DEEP_SLEEP_RTC_MAGIC) {
+        memset(&deep_sleep_rtc, 0, sizeof(deep_sleep_rtc));
+        deep_sleep_rtc.magic = DEEP_SLEEP_RTC_MAGIC;
+    }
+
+    if (deep_sleep_wake != DEEP_SLEEP_WAKE_NONE) {
+        int64_t slept_us = deep_sleep_rtc_time_us() - deep_sleep_rtc.sleep_time_us;
+        deep_sleep_slept_s = slept_us > 0 ? (uint32_t)(slept_us / 1000000LL) : 0;
+        Serial.printf("🌅 从深度睡眠唤醒: %s, 睡眠 %lu 秒（第%lu次）\n",
+                     deep_sleep_wake_name(deep_sleep_wake), deep_sleep_slept_s, deep_sleep_rtc.sleep_count);
+    }
+}
+
+bool deep_sleep_is_resume(void) {
+    return deep_sleep_wake != DEEP_SLEEP_WAKE_NONE;
+}
+
+deep_sleep_wake_t deep_sleep_get_wake_source(void) {
+    return deep_sleep_wake;
+}
+
+void deep_sleep_set_policy(bool enabled, uint32_t timeout_s) {
+    deep_sleep_enabled = DEEP_SLEEP_ENABLED && enabled;
+    deep_sleep_timeout_ms = (timeout_s ? timeout_s : DEEP_SLEEP_DEFAULT_TIMEOUT_S) * 1000UL;
+}
+
+void deep_sleep_note_activity(void) {
+    deep_sleep_last_activity = millis();
+}
+
+// 首个画面出现后记录一次唤醒延迟
+static void deep_sleep_record_latency(void) {
+#ifdef JUMPING_ROCKET_V3
+    // V3.0加载结束前不记录：此时还没有可操作的菜单
+    if (V3_IS_LOADING()) return;
+#endif
+    uint32_t first_frame_ms = boot_get_phase_ms(BOOT_PHASE_FIRST_FRAME);
+    if (first_frame_ms == 0) return;
+    deep_sleep_latency_recorded = true;
+
+    if (!deep_sleep_is_resume()) return;
+
+    deep_sleep_rtc.latency_ms[deep_sleep_rtc.latency_head] = first_frame_ms > 0xFFFF ? 0xFFFF : first_frame_ms;
+    deep_sleep_rtc.latency_head = (deep_sleep_rtc.latency_head + 1) % DEEP_SLEEP_LATENCY_HISTORY;
+    if (deep_sleep_rtc.latency_count < DEEP_SLEEP_LATENCY_HISTORY) deep_sleep_rtc.latency_count++;
+
+    if (first_frame_ms > DEEP_SLEEP_WAKE_BUDGET_MS) {
+        Serial.printf("⚠️ 唤醒延迟 %lu ms，超过上限 %d ms（串口命令 boot 查看各阶段）\n",
+                     first_frame_ms, DEEP_SLEEP_WAKE_BUDGET_MS);
+    } else {
+        Serial.printf("⏱️ 唤醒延迟 %lu ms（上限 %d ms）\n", first_frame_ms, DEEP_SLEEP_WAKE_BUDGET_MS);
+    }
+#ifdef JUMPING_ROCKET_V3
+    uint32_t v3_ready_ms = boot_get_phase_ms("v3_ready");
+    if (v3_ready_ms > 0) {
+        Serial.printf("   其中V3.0数据加载完成于 %lu ms\n", v3_ready_ms);
+    }
+#endif
+}
+
+bool deep_sleep_update(void) {
+    if (!deep_sleep_latency_recorded) {
+        deep_sleep_record_latency();
+    }
+
+    if (deep_sleep_requested) {
+        deep_sleep_requested = false;
+        return true;
+    }
+    if (!deep_sleep_enabled) return false;
+
+    // 只在待机状态（包括V3.0菜单）计时，游戏中、结算等状态视为活动
+    if (current_state != GAME_STATE_IDLE) {
+        deep_sleep_note_activity();
+        return false;
+    }
+    return millis() - deep_sleep_last_activity >= deep_sleep_timeout_ms;
+}
+
+bool deep_sleep_pending(void) {
+    return deep_sleep_parking;
+}
+
+void deep_sleep_park(uint8_t task_bit) {
+    if (deep_sleep_events) {
+        xEventGroupSetBits(deep_sleep_events, task_bit);
+    }
+    // 睡眠前不再运行，唤醒后整个系统重新启动
+    while (1) {
+        vTaskSuspend(NULL);
+    }
+}
+
+void deep_sleep_prepare(void) {
+    Serial.printf("😴 空闲 %lu 秒，准备进入深度睡眠...\n", (millis() - deep_sleep_last_activity) / 1000);
+
+    deep_sleep_parking = true;
+    EventBits_t parked = 0;
+    if (deep_sleep_events) {
+        parked = xEventGroupWaitBits(deep_sleep_events, DEEP_SLEEP_PARK_ALL, pdFALSE, pdTRUE,
+                                     pdMS_TO_TICKS(DEEP_SLEEP_PARK_TIMEOUT_MS));
+    }
+    if ((parked & DEEP_SLEEP_PARK_ALL) != DEEP_SLEEP_PARK_ALL) {
+        // 初始化失败已退出的任务不会响应，继续睡眠
+        Serial.printf("⚠️ 部分任务未停止 (0x%02x)\n", (unsigned)(~parked & DEEP_SLEEP_PARK_ALL));
+    }
+    deep_sleep_rtc.motion_armed = (parked & DEEP_SLEEP_PARK_SENSOR) ? 1 : 0;
+}
+
+void deep_sleep_start(void) {
+    // 按键唤醒
+#if CONFIG_IDF_TARGET_ESP32C3
+    esp_deep_sleep_enable_gpio_wakeup(1ULL << BUTTON_PIN,
+        BUTTON_ACTIVE_LEVEL == HIGH ? ESP_GPIO_WAKEUP_GPIO_HIGH : ESP_GPIO_WAKEUP_GPIO_LOW);
+#else
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)BUTTON_PIN, BUTTON_ACTIVE_LEVEL == HIGH ? 1 : 0);
+#endif
+
+    // 动作唤醒（传感器任务已把INT配置为高电平锁存）
+    if (deep_sleep_rtc.motion_armed && esp_sleep_is_valid_wakeup_gpio((gpio_num_t)MPU_INT_PIN)) {
+#if CONFIG_IDF_TARGET_ESP32C3
+        esp_deep_sleep_enable_gpio_wakeup(1ULL << MPU_INT_PIN, ESP_GPIO_WAKEUP_GPIO_HIGH);
+#else
+        esp_sleep_enable_ext1_wakeup(1ULL << MPU_INT_PIN, ESP_EXT1_WAKEUP_ANY_HIGH);
+#endif
+    } else {
+        Serial.println("⚠️ 动作唤醒不可用，只能按键唤醒");
+        deep_sleep_rtc.motion_armed = 0;
+    }
+
+    deep_sleep_rtc.sleep_count++;
+    deep_sleep_rtc.awake_ms = millis();
+    deep_sleep_rtc.sleep_time_us = deep_sleep_rtc_time_us();
+
+    Serial.printf("😴 进入深度睡眠（唤醒: 按键%s）\n", deep_sleep_rtc.motion_armed ? "、动作" : "");
+    dlog_flush(200);
+    Serial.flush();
+
+    esp_deep_sleep_start();
+}
+
+void deep_sleep_print_report(void) {
+    uint32_t idle_s = (millis() - deep_sleep_last_activity) / 1000;
+
+    Serial.printf("😴 深度睡眠: %s", deep_sleep_enabled ? "已启用" : "已关闭");
+    if (deep_sleep_enabled) {
+        Serial.printf(", 超时 %lu 秒, 已空闲 %lu 秒", deep_sleep_timeout_ms / 1000, idle_s);
+    }
+    Serial.println();
+    Serial.printf("   累计睡眠 %lu 次, 本次启动: %s", deep_sleep_rtc.sleep_count, deep_sleep_wake_name(deep_sleep_wake));
+    if (deep_sleep_is_resume()) {
+        Serial.printf("（睡眠 %lu 秒，上次唤醒后运行 %lu 秒）", deep_sleep_slept_s, deep_sleep_rtc.awake_ms / 1000);
+    }
+    Serial.println();
+
+    if (deep_sleep_rtc.latency_count > 0) {
+        uint32_t sum = 0;
+        uint16_t min_ms = 0xFFFF, max_ms = 0;
+        for (uint8_t i = 0; i < deep_sleep_rtc.latency_count; i++) {
+            uint16_t ms = deep_sleep_rtc.latency_ms[i];
+            sum += ms;
+            if (ms < min_ms) min_ms = ms;
+            if (ms > max_ms) max_ms = ms;
+        }
+        Serial.printf("   唤醒延迟（最近%d次）: 平均 %lu ms, 最小 %u ms, 最大 %u ms, 上限 %d ms\n",
+                     deep_sleep_rtc.latency_count, sum / deep_sleep_rtc.latency_count,
+                     min_ms, max_ms, DEEP_SLEEP_WAKE_BUDGET_MS);
+    }
+}
+
+bool deep_sleep_handle_command(const char* command) {
+    if (strcmp(command, "sleep") == 0) {
+        deep_sleep_print_report();
+        return true;
+    }
+    if (strcmp(command, "sleep now") == 0) {
+        // 由loop在下一次检查时进入睡眠流程
+        deep_sleep_requested = true;
+        return true;
+    }
+    return false;
+}
@@ -1,4 +1,5 @@
 #include "jumping_rocket_simple.h"
+#include "dlog.h"
 
 // V3.0 UI集成
 #ifdef JUMPING_ROCKET_V3
@@ -30,6 +31,13 @@ static game_state_t last_display_state = GAME_STATE_IDLE;
 #define ROCKET_LAUNCH_DURATION      2000  // 火箭发射动画持续时间(ms)
 #define TRANSITION_DURATION         150   // 界面切换动画持续时间(ms)
 
+// 开机动画帧数（每帧300ms）：快速启动只播放一个波浪周期
+#if FAST_BOOT_ENABLED
+#define BOOT_ANIMATION_FRAMES       5
+#else
+#define BOOT_ANIMATION_FRAMES       15
+#endif
+
 // 字体定义 - 针对128x64优化
 #define FONT_TINY     u8g2_font_4x6_tf        // 4x6像素，用于小标签
 #define FONT_SMALL    u8g2_font_6x10_tf       // 6x10像素，用于数值
@@ -477,13 +485,13 @@ void oled_display_boot_animation(void) {
 
         // 每500ms输出一次动画状态（更频繁的调试）
         if (current_time - last_debug_time > 500) {
-            Serial.printf("🔄 开机动画状态: 活跃点%d/3, 周期%lums, 经过时间%lums\n", active_dot, dot_cycle, elapsed_time);
-            Serial.printf("📍 点状态: 点1(%s) 点2(%s) 点3(%s)\n",
-                         (active_dot == 0) ? "●实心" : "○空心",
-                         (active_dot == 1) ? "●实心" : "○空心",
-                         (active_dot == 2) ? "●实心" : "○空心");
-            Serial.printf("🧮 计算详情: 开始时间=%lu, 当前时间=%lu, 经过=%lu, 周期=%lu, 活跃点=%d\n",
-                         animation_start_time, current_millis, elapsed_time, dot_cycle, active_dot);
+            DLOG_D("🔄 开机动画状态: 活跃点%d/3, 周期%lums, 经过时间%lums\n", active_dot, dot_cycle, elapsed_time);
+            DLOG_D("📍 点状态: 点1(%s) 点2(%s) 点3(%s)\n",
+                   (active_dot == 0) ? "●实心" : "○空心",
+                   (active_dot == 1) ? "●实心" : "○空心",
+                   (active_dot == 2) ? "●实心" : "○空心");
+            DLOG_D("🧮 计算详情: 开始时间=%lu, 当前时间=%lu, 经过=%lu, 周期=%lu, 活跃点=%d\n",
+                   animation_start_time, current_millis, elapsed_time, dot_cycle, active_dot);
             last_debug_time = current_time;
         }
 
@@ -631,14 +639,10 @@ void oled_display_rocket_launch_animation(void) {
         int time_x = (time_width < 37) ? 3 : (40 - time_width);
         u8g2.drawStr(time_x, 25, time_text); // 与跳跃统计间距10像素
 
-        // 添加布局调试信息
-        static uint32_t last_debug_time = 0;
-        if (current_time - last_debug_time > 1000) { // 每秒输出一次
-            Serial.printf("🚀 发射动画布局修复: 高度(%d,%d) 标签(%d,%d) 跳跃(%d,15) 时间(%d,25)\n",
-                         height_x, height_y, label_x, label_y, jump_x, time_x);
-            Serial.printf("📐 字体高度: FONT_LARGE=20px, 高度占用15-35px, ALTITUDE在37px, 中央保护区40-88px\n");
-            last_debug_time = current_time;
-        }
+        // 添加布局调试信息（每秒输出一次）
+        DLOG_RATE_D(1000, "🚀 发射动画布局修复: 高度(%d,%d) 标签(%d,%d) 跳跃(%d,15) 时间(%d,25)\n",
+                    height_x, height_y, label_x, label_y, jump_x, time_x);
+        DLOG_RATE_D(1000, "📐 字体高度: FONT_LARGE=20px, 高度占用15-35px, ALTITUDE在37px, 中央保护区40-88px\n");
 
         u8g2.sendBuffer();
 
@@ -778,8 +782,8 @@ void oled_display_game_screen(void) {
     // 调试输出进度条计算
     static uint32_t last_debug_fuel = 999;
     if (game_data.fuel_progress != last_debug_fuel) {
-        Serial.printf("📊 进度条: 燃料=%lu%%, 可用宽度=%d, 填充宽度=%d\n",
-                     game_data.fuel_progress, available_width, fill_width);
+        DLOG_D("📊 进度条: 燃料=%lu%%, 可用宽度=%d, 填充宽度=%d\n",
+               game_data.fuel_progress, available_width, fill_width);
         last_debug_fuel = game_data.fuel_progress;
     }
 
@@ -1224,6 +1228,25 @@ void oled_display_difficulty_select_screen(void) {
     u8g2.sendBuffer();
 }
 
+// 深度睡眠提示，短暂显示后关闭屏幕（SSD1306进入省电模式，唤醒复位时重新初始化）
+void oled_display_sleep_screen(void) {
+    if (!display_initialized) return;
+
+    u8g2.clearBuffer();
+
+    u8g2.setFont(FONT_MEDIUM);
+    const char* title = "Sleeping...";
+    u8g2.drawStr((SCREEN_WIDTH - u8g2.getStrWidth(title)) / 2, 28, title);
+
+    u8g2.setFont(FONT_TINY);
+    const char* hint = "Move or press to wake";
+    u8g2.drawStr((SCREEN_WIDTH - u8g2.getStrWidth(hint)) / 2, 46, hint);
+
+    u8g2.sendBuffer();
+    delay(500);
+    u8g2.setPowerSave(1);
+}
+
 // 显示任务
 void display_task(void* pvParameters) {
     Serial.println("🖥️  显示任务启动");
@@ -1235,20 +1258,32 @@ void display_task(void* pvParameters) {
         vTaskDelete(NULL);
         return;
     }
-
-    // 显示开机动画
-    Serial.println("   播放开机动画...");
-    animation_frame = 0;
-    last_animation_time = millis();
-
-    for (int i = 0; i < 15; i++) {
-        oled_display_boot_animation();
-        delay(300);
+    boot_mark("oled");
+
+    // 显示开机动画（从深度睡眠唤醒时跳过，直接回到待机画面）
+    if (deep_sleep_is_resume()) {
+        Serial.println("   从深度睡眠唤醒，跳过开机动画");
+    } else {
+        Serial.println("   播放开机动画...");
+        animation_frame = 0;
+        last_animation_time = millis();
+
+        for (int i = 0; i < BOOT_ANIMATION_FRAMES; i++) {
+            oled_display_boot_animation();
+            delay(300);
+        }
     }
 
     Serial.println("✅ 显示任务初始化完成，开始主循环");
 
     while (1) {
+        telemetry_loop_tick(TELEMETRY_TASK_DISPLAY);
+
+        if (deep_sleep_pending()) {
+            oled_display_sleep_screen();
+            deep_sleep_park(DEEP_SLEEP_PARK_DISPLAY);
+        }
+
         // 检测界面切换
         bool state_changed = (current_state != last_display_state);
         if (state_changed) {
@@ -1259,9 +1294,9 @@ void display_task(void* pvParameters) {
         // V3.0 UI模式检查
 #ifdef JUMPING_ROCKET_V3
         if (V3_IS_IN_UI()) {
-            // V3.0 UI模式渲染
-            V3_RENDER_UI();
-            delay(100); // 10FPS更新
+            // V3.0 UI循环：按键事件立即唤醒，无按键时按10FPS节拍刷新动画
+            V3_RUN_UI();
+            boot_mark(BOOT_PHASE_FIRST_FRAME);     // V3.0版本的首个可交互画面是菜单
             continue;
         }
 #endif
@@ -1276,6 +1311,12 @@ void display_task(void* pvParameters) {
                     V3_ENTER_UI();
                     continue;
                 }
+                // V3.0仍在加载时继续显示开机动画，不画V2.0待机画面（不响应菜单操作，也不算首帧）
+                if (V3_IS_LOADING()) {
+                    oled_display_boot_animation();
+                    delay(100);
+                    continue;
+                }
 #endif
                 oled_display_idle_screen();
                 break;
@@ -1318,6 +1359,7 @@ void display_task(void* pvParameters) {
                 oled_display_result_screen();
                 break;
         }
+        boot_mark(BOOT_PHASE_FIRST_FRAME);
 
         delay(100); // 10FPS更新率，提供流畅体验
     }
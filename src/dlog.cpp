@@ -0,0 +1,183 @@
+#include "dlog.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// 多生产者单消费者环形缓冲区：生产者用CAS预留位置，写完后发布序号；
+// 输出任务按顺序等待每个位置的序号就绪（C3没有原子指令，CAS由编译器运行库以极短的关中断实现）
+typedef struct {
+    uint32_t sequence;          // 位置pos写完后为pos + 1
+    const char* format;
+    uint8_t argc;
+    uint16_t suppressed;
+    dlog_arg_t args[DLOG_MAX_ARGS];
+} dlog_entry_t;
+
+static dlog_entry_t dlog_ring[DLOG_RING_SIZE];
+static uint32_t dlog_head = 0;          // 下一个预留位置
+static uint32_t dlog_tail = 0;          // 下一个待输出位置（只有输出任务修改）
+static uint32_t dlog_dropped = 0;       // 未报告的丢弃条数
+static uint32_t dlog_dropped_total = 0;
+static TaskHandle_t dlog_task_handle = NULL;
+
+bool dlog_admit(dlog_site_t* site, uint16_t* suppressed) {
+    uint32_t now = millis();
+    if (site->last_ms != 0 && now - site->last_ms < site->interval_ms) {
+        if (site->suppressed < 0xFFFF) site->suppressed++;
+        return false;
+    }
+    site->last_ms = now ? now : 1;
+    *suppressed = site->suppressed;
+    site->suppressed = 0;
+    return true;
+}
+
+void dlog_push(const dlog_site_t* site, uint16_t suppressed, const dlog_arg_t* args, uint8_t argc) {
+    uint32_t pos = __atomic_load_n(&dlog_head, __ATOMIC_RELAXED);
+    do {
+        if (pos - __atomic_load_n(&dlog_tail, __ATOMIC_ACQUIRE) >= DLOG_RING_SIZE) {
+            __atomic_fetch_add(&dlog_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&dlog_head, &pos, pos + 1, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    dlog_entry_t& entry = dlog_ring[pos % DLOG_RING_SIZE];
+    entry.format = site->format;
+    entry.argc = argc;
+    entry.suppressed = suppressed;
+    memcpy(entry.args, args, argc * sizeof(dlog_arg_t));
+    __atomic_store_n(&entry.sequence, pos + 1, __ATOMIC_RELEASE);
+}
+
+// 按格式串逐个转换说明符格式化，参数类型由转换字符决定（长度修饰符忽略，所有整数均为32位）
+static void dlog_format(char* line, size_t size, const dlog_entry_t& entry) {
+    const char* p = entry.format;
+    size_t pos = 0;
+    uint8_t next_arg = 0;
+
+    while (*p && pos < size - 1) {
+        if (*p != '%') {
+            line[pos++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            line[pos++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // 复制一个转换说明，去掉长度修饰符
+        char spec[16];
+        size_t spec_len = 0;
+        const char* start = p;
+        spec[spec_len++] = *p++;
+        while (*p && strchr("-+ #0123456789.*lhzjtL", *p)) {
+            if (!strchr("lhzjtL", *p) && spec_len < sizeof(spec) - 2) spec[spec_len++] = *p;
+            p++;
+        }
+        char conversion = *p;
+        if (!conversion) break;
+        p++;
+        spec[spec_len++] = conversion;
+        spec[spec_len] = '\0';
+
+        int written;
+        if (next_arg >= entry.argc || strchr(spec, '*')) {
+            // 参数不足或不支持的说明符，原样输出
+            written = snprintf(line + pos, size - pos, "%.*s", (int)(p - start), start);
+        } else {
+            const dlog_arg_t& arg = entry.args[next_arg++];
+            switch (conversion) {
+                case 'd': case 'i': case 'c':
+                    written = snprintf(line + pos, size - pos, spec, (int)arg.i);
+                    break;
+                case 'u': case 'o': case 'x': case 'X':
+                    written = snprintf(line + pos, size - pos, spec, (unsigned int)arg.u);
+                    break;
+                case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+                    written = snprintf(line + pos, size - pos, spec, (double)arg.f);
+                    break;
+                case 's':
+                    written = snprintf(line + pos, size - pos, spec, arg.s ? arg.s : "(null)");
+                    break;
+                default:
+                    written = snprintf(line + pos, size - pos, "%.*s", (int)(p - start), start);
+                    break;
+            }
+        }
+        if (written < 0) break;
+        pos += (size_t)written < size - pos ? (size_t)written : size - pos - 1;
+    }
+    line[pos] = '\0';
+
+    // 限速丢弃的条数附加在行尾（换行之前）
+    if (entry.suppressed > 0) {
+        bool newline = pos > 0 && line[pos - 1] == '\n';
+        if (newline) line[--pos] = '\0';
+        snprintf(line + pos, size - pos, " (+%u)%s", entry.suppressed, newline ? "\n" : "");
+    }
+}
+
+// 输出一条，缓冲区为空或下一条尚未写完时返回false
+static bool dlog_drain_one(void) {
+    uint32_t tail = dlog_tail;
+    const dlog_entry_t& slot = dlog_ring[tail % DLOG_RING_SIZE];
+    if (__atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE) != tail + 1) return false;
+
+    // 先复制并释放位置，格式化和串口输出期间生产者可以继续写入
+    dlog_entry_t entry = slot;
+    __atomic_store_n(&dlog_tail, tail + 1, __ATOMIC_RELEASE);
+
+    char line[DLOG_LINE_MAX];
+    dlog_format(line, sizeof(line), entry);
+    Serial.print(line);
+    return true;
+}
+
+static void dlog_drain(void) {
+    while (dlog_drain_one()) {
+    }
+
+    uint32_t dropped = __atomic_exchange_n(&dlog_dropped, 0, __ATOMIC_RELAXED);
+    if (dropped > 0) {
+        dlog_dropped_total += dropped;
+        Serial.printf("⚠️ 日志缓冲区已满，丢弃 %lu 条\n", dropped);
+    }
+}
+
+static void dlog_task(void* pvParameters) {
+    while (1) {
+        dlog_drain();
+        vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_MS));
+    }
+}
+
+void dlog_init(void) {
+    if (dlog_task_handle) return;
+
+    xTaskCreate(dlog_task, "dlog_task", DLOG_TASK_STACK, NULL, DLOG_TASK_PRIORITY, &dlog_task_handle);
+    if (dlog_task_handle == NULL) {
+        Serial.println("❌ 日志输出任务创建失败");
+        return;
+    }
+    Serial.printf("📝 延迟日志: 级别 %d, 缓冲 %d 条\n", DLOG_LEVEL, DLOG_RING_SIZE);
+}
+
+bool dlog_flush(uint32_t timeout_ms) {
+    // 输出任务未启动时由调用方直接输出（此时没有其它消费者）
+    if (dlog_task_handle == NULL) {
+        dlog_drain();
+        return __atomic_load_n(&dlog_head, __ATOMIC_ACQUIRE) == dlog_tail;
+    }
+
+    uint32_t start = millis();
+    while (__atomic_load_n(&dlog_head, __ATOMIC_ACQUIRE) != __atomic_load_n(&dlog_tail, __ATOMIC_ACQUIRE)) {
+        if (millis() - start >= timeout_ms) return false;
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+uint32_t dlog_get_dropped(void) {
+    return dlog_dropped_total + __atomic_load_n(&dlog_dropped, __ATOMIC_RELAXED);
+}
@@ -1,4 +1,5 @@
 #include "jumping_rocket_simple.h"
+#include "dlog.h"
 
 // V3.0 集成
 #ifdef JUMPING_ROCKET_V3
@@ -178,8 +179,8 @@ static void calculate_fuel_progress(void) {
     // 调试输出燃料计算
     static uint32_t last_fuel_debug = 0;
     if (game_data.fuel_progress != last_fuel_debug) {
-        Serial.printf("⛽ 燃料充能: %lu次跳跃 × %d = %lu%% (最大%d%%)\n",
-                     game_data.jump_count, FUEL_PER_JUMP, game_data.fuel_progress, MAX_FUEL);
+        DLOG_D("⛽ 燃料充能: %lu次跳跃 × %d = %lu%% (最大%d%%)\n",
+               game_data.jump_count, FUEL_PER_JUMP, game_data.fuel_progress, MAX_FUEL);
         last_fuel_debug = game_data.fuel_progress;
     }
 }
@@ -222,12 +223,8 @@ void game_update_data(void) {
         // 调试输出计时信息（每5秒输出一次）
         static uint32_t last_debug_time = 0;
         if (current_time - last_debug_time >= 5000) {
-            Serial.printf("⏰ 计时调试 - 当前时间: %lu ms\n", current_time);
-            Serial.printf("   游戏开始时间: %lu ms\n", game_start_time);
-            Serial.printf("   原始游戏时长: %lu ms\n", total_elapsed);
-            Serial.printf("   总暂停时间: %lu ms\n", total_pause_time);
-            Serial.printf("   净游戏时长: %lu ms (%lu秒)\n",
-                         game_data.game_time_ms, game_data.game_time_ms / 1000);
+            DLOG_D("⏰ 计时调试 - 当前: %lu ms, 开始: %lu ms, 原始时长: %lu ms, 暂停: %lu ms, 净时长: %lu ms\n",
+                   current_time, game_start_time, total_elapsed, total_pause_time, game_data.game_time_ms);
             last_debug_time = current_time;
         }
 
@@ -241,14 +238,9 @@ bool should_start_rocket_launch(void) {
     // 获取当前难度的燃料阈值
     uint32_t fuel_threshold = get_difficulty_fuel_threshold(game_data.difficulty);
 
-    // 调试输出当前难度信息（每次检查时输出）
-    static uint32_t last_debug_time = 0;
-    uint32_t current_time = millis();
-    if (current_time - last_debug_time > 3000) { // 每3秒输出一次
-        Serial.printf("🎯 难度检查: 当前难度=%s, 燃料阈值=%lu%%, 当前燃料=%lu%%\n",
-                     get_difficulty_name(game_data.difficulty), fuel_threshold, game_data.fuel_progress);
-        last_debug_time = current_time;
-    }
+    // 调试输出当前难度信息（每3秒输出一次）
+    DLOG_RATE_D(3000, "🎯 难度检查: 当前难度=%s, 燃料阈值=%lu%%, 当前燃料=%lu%%\n",
+                get_difficulty_name(game_data.difficulty), fuel_threshold, game_data.fuel_progress);
 
     // 条件1: 燃料达到难度阈值
     if (game_data.fuel_progress >= fuel_threshold) {
@@ -353,6 +345,11 @@ void game_task(void* pvParameters) {
     game_reset();
     
     while (1) {
+        telemetry_loop_tick(TELEMETRY_TASK_GAME);
+        if (deep_sleep_pending()) {
+            deep_sleep_park(DEEP_SLEEP_PARK_GAME);
+        }
+
         // 执行状态机
         game_state_machine();
         
@@ -361,6 +358,9 @@ void game_task(void* pvParameters) {
         if (button_event != BUTTON_EVENT_NONE) {
             handle_button_event(button_event);
         }
+
+        // 按状态切换功耗模式
+        power_update();
         
         // 任务延时
         delay(50); // 20Hz更新频率
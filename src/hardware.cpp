@@ -106,11 +106,18 @@ bool hardware_init(void) {
     Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
     uint32_t i2c_freq = board_get_i2c_frequency();
     Wire.setClock(i2c_freq);
+#if !FAST_BOOT_ENABLED
     delay(100);
+#endif
     Serial.printf("I2C总线初始化完成 (频率: %d Hz)\n", i2c_freq);
 
+#if FAST_BOOT_ENABLED
+    // 快速启动不扫描（112个地址约需0.6秒），设备缺失由各自任务的初始化报告，需要时用串口命令i2c扫描
+    Serial.println("⏭️ 快速启动：跳过I2C扫描");
+#else
     // 扫描I2C设备
     i2c_scan();
+#endif
 
     // 初始化蜂鸣器（先初始化，用于状态指示）
     Serial.println("1. 初始化蜂鸣器...");
@@ -120,11 +127,13 @@ bool hardware_init(void) {
     }
     Serial.println("✅ 蜂鸣器初始化成功");
 
+#if !FAST_BOOT_ENABLED
     // 播放初始化音效
     digitalWrite(BUZZER_PIN, HIGH);
     delay(100);
     digitalWrite(BUZZER_PIN, LOW);
     delay(100);
+#endif
 
     // 初始化按钮
     Serial.println("2. 初始化按钮...");
@@ -141,6 +150,10 @@ bool hardware_init(void) {
     Serial.println("4. OLED显示屏将在显示任务中初始化");
     Serial.println("✅ OLED初始化准备完成");
 
+#if FAST_BOOT_ENABLED
+    // 快速启动时开机音效在音效任务启动后播放，不阻塞初始化
+    Serial.println("⏭️ 快速启动：开机音效由音效任务播放");
+#else
     // 播放成功音效
     Serial.println("播放初始化成功音效...");
     int success_melody[] = {262, 330, 392, 523}; // C-E-G-C
@@ -154,6 +167,7 @@ bool hardware_init(void) {
         }
         delay(100);
     }
+#endif
 
     Serial.println("========================================");
     Serial.println("✅ 所有硬件初始化完成！");
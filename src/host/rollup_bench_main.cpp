@@ -0,0 +1,189 @@
+// 主机端分层汇总基准测试入口（pio run -e native_rollup_bench -t exec）
+// 模拟多年使用：每天写入明细文件和日期索引，再按设备上的策略删除旧明细并压缩为周/月汇总，
+// 对比不分层（保留全部明细、统计时全量扫描）时的存储占用和全部时间统计耗时
+#ifdef V3_HOST_BUILD
+
+#include "v3/storage_backend_v3.h"
+#include "v3/history_index_v3.h"
+#include "v3/rollup_store_v3.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#define BENCH_FIRST_DAY         19000       // 2022-01-08
+#define BENCH_QUERY_ROUNDS      20
+
+static uint64_t now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static std::string detail_path(uint32_t day) {
+    char path[32];
+    snprintf(path, sizeof(path), "/daily_%u.bin", day);
+    return path;
+}
+
+// 生成一天的模拟数据：0-4次游戏，明细大小与MessagePack每日记录相当
+static day_totals_v3_t simulate_day(uint32_t day, std::vector<uint8_t>* detail) {
+    day_totals_v3_t totals;
+    memset(&totals, 0, sizeof(totals));
+    uint32_t sessions = (day * 7 + rand()) % 5;
+    for (uint32_t i = 0; i < sessions; i++) {
+        uint32_t jumps = 40 + rand() % 160;
+        totals.jumps += jumps;
+        totals.duration += 120 + rand() % 240;
+        totals.calories_x10 += jumps * 2;
+        totals.sessions++;
+        totals.targets += rand() % 2;
+        uint16_t score = (uint16_t)(jumps * 3 + rand() % 50);
+        if (score > totals.best_score) totals.best_score = score;
+    }
+    // 明细：汇总放在文件头，其后每次游戏约110字节
+    detail->assign(64 + sessions * 110, 0);
+    memcpy(detail->data(), &totals, sizeof(totals));
+    return totals;
+}
+
+typedef struct {
+    uint32_t files;
+    size_t bytes;
+} usage_t;
+
+static void usage_cb(const char* path, size_t size, void* ctx) {
+    (void)path;
+    usage_t* usage = (usage_t*)ctx;
+    usage->files++;
+    usage->bytes += size;
+}
+
+static void detail_cb(const char* path, size_t size, void* ctx) {
+    (void)size;
+    std::vector<std::string>* files = (std::vector<std::string>*)ctx;
+    if (strncmp(path, "/daily_", 7) == 0) files->push_back(path);
+}
+
+static usage_t measure_usage(StorageBackendV3* backend) {
+    usage_t usage = {0, 0};
+    backend->list("/", usage_cb, &usage);
+    return usage;
+}
+
+// 不分层时的全部时间统计：逐个读取每日明细
+static uint64_t scan_lifetime(StorageBackendV3* backend, uint32_t* jumps) {
+    std::vector<std::string> files;
+    backend->list("/", detail_cb, &files);
+    uint64_t total = 0;
+    for (const std::string& file : files) {
+        day_totals_v3_t totals;
+        if (backend->readAt(file.c_str(), 0, (uint8_t*)&totals, sizeof(totals)) == sizeof(totals)) {
+            total += totals.jumps;
+        }
+    }
+    *jumps = (uint32_t)total;
+    return files.size();
+}
+
+// 删除超出明细窗口的每日文件（汇总已在日期索引中）
+static void prune_details(StorageBackendV3* backend, uint32_t today) {
+    std::vector<std::string> files;
+    backend->list("/", detail_cb, &files);
+    for (const std::string& file : files) {
+        uint32_t day = (uint32_t)strtoul(file.c_str() + 7, nullptr, 10);
+        if (day + V3_DETAIL_DAYS <= today) backend->remove(file.c_str());
+    }
+}
+
+static bool run_case(StorageBackendV3* backend, uint32_t days, bool tiered) {
+    backend->format();
+    srand(days);
+
+    HistoryIndexV3 index;
+    RollupStoreV3 rollups;
+    index.begin(backend);
+    rollups.begin(backend);
+
+    uint64_t expected_jumps = 0;
+    uint64_t compact_us = 0;
+    uint64_t max_compact_us = 0;
+    std::vector<uint8_t> detail;
+
+    for (uint32_t day = BENCH_FIRST_DAY; day < BENCH_FIRST_DAY + days; day++) {
+        day_totals_v3_t totals = simulate_day(day, &detail);
+        expected_jumps += totals.jumps;
+        if (!backend->writeAll(detail_path(day).c_str(), detail.data(), detail.size()) ||
+            !index.setDay(day, totals)) {
+            printf("❌ %s: 第 %u 天写入失败（存储已满）\n", backend->name(), day - BENCH_FIRST_DAY);
+            return false;
+        }
+
+        if (tiered) {
+            uint64_t start = now_us();
+            prune_details(backend, day);
+            rollups.compact(index, day, V3_DETAIL_DAYS);
+            uint64_t elapsed = now_us() - start;
+            compact_us += elapsed;
+            if (elapsed > max_compact_us) max_compact_us = elapsed;
+        }
+    }
+
+    // 全部时间统计
+    uint32_t lifetime_jumps = 0;
+    uint64_t start = now_us();
+    for (int i = 0; i < BENCH_QUERY_ROUNDS; i++) {
+        if (tiered) {
+            rollup_record_t lifetime;
+            rollups.getLifetime(index, &lifetime);
+            lifetime_jumps = lifetime.jumps;
+        } else {
+            scan_lifetime(backend, &lifetime_jumps);
+        }
+    }
+    uint64_t lifetime_us = (now_us() - start) / BENCH_QUERY_ROUNDS;
+
+    // 最近一年区间汇总
+    uint32_t last_day = BENCH_FIRST_DAY + days - 1;
+    day_totals_v3_t year;
+    start = now_us();
+    for (int i = 0; i < BENCH_QUERY_ROUNDS; i++) {
+        rollups.getRange(index, last_day >= 364 ? last_day - 364 : 0, last_day, &year);
+    }
+    uint64_t range_us = (now_us() - start) / BENCH_QUERY_ROUNDS;
+
+    usage_t usage = measure_usage(backend);
+    printf("   %-5s %5u天 %-4s | 文件 %5u 个 %8zu B | 索引 %4u天 周 %3zu 月 %3zu | "
+           "全部统计 %7llu us | 年度区间 %5llu us | 压缩 平均 %5llu / 最大 %6llu us | %s\n",
+           backend->name(), days, tiered ? "分层" : "全量",
+           usage.files, usage.bytes, index.dayCount(), rollups.weekCount(), rollups.monthCount(),
+           (unsigned long long)lifetime_us, (unsigned long long)range_us,
+           (unsigned long long)(tiered ? compact_us / days : 0), (unsigned long long)max_compact_us,
+           lifetime_jumps == (uint32_t)expected_jumps ? "✅" : "❌ 总数不一致");
+    return lifetime_jumps == (uint32_t)expected_jumps;
+}
+
+int main() {
+    // 全量对照组需要远超分区的容量才能存下多年明细
+    RamStorageBackendV3 ram_unbounded(64 * 1024 * 1024);
+    RamStorageBackendV3 ram(V3_POSIX_STORAGE_QUOTA);
+    PosixStorageBackendV3 posix;
+    const uint32_t years[] = {1, 3, 5, 10};
+
+    printf("📊 分层汇总基准测试（明细 %d 天, 日期层 %d 天, 周 %d 条, 月 %d 条）\n",
+           V3_DETAIL_DAYS, V3_DAY_TIER_DAYS, V3_WEEK_TIER_WEEKS, V3_MONTH_TIER_MONTHS);
+
+    bool ok = ram_unbounded.begin(true) && ram.begin(true) && posix.begin(true);
+    for (uint32_t y : years) {
+        uint32_t days = y * 365;
+        ok = run_case(&ram_unbounded, days, false) && ok;
+        ok = run_case(&ram, days, true) && ok;
+        ok = run_case(&posix, days, true) && ok;
+    }
+    posix.format();
+    return ok ? 0 : 1;
+}
+
+#endif // V3_HOST_BUILD
@@ -0,0 +1,31 @@
+// 主机端存储基准测试入口（pio run -e native_storage_bench -t exec）
+#ifdef V3_HOST_BUILD
+
+#include "v3/storage_backend_v3.h"
+#include "v3/storage_bench_v3.h"
+#include <stdio.h>
+
+static bool run_backend(StorageBackendV3* backend) {
+    if (!backend->begin(true)) {
+        printf("❌ %s 挂载失败\n", backend->name());
+        return false;
+    }
+
+    storage_bench_result_t result;
+    bool ok = runStorageBenchmarkV3(backend, &result);
+    printStorageBenchmarkV3(&result);
+    backend->end();
+    return ok;
+}
+
+int main() {
+    // RAM后端使用与分区相同的容量，便于和POSIX结果对比
+    RamStorageBackendV3 ram(V3_POSIX_STORAGE_QUOTA);
+    PosixStorageBackendV3 posix;
+
+    bool ok = run_backend(&ram);
+    ok = run_backend(&posix) && ok;
+    return ok ? 0 : 1;
+}
+
+#endif // V3_HOST_BUILD
@@ -0,0 +1,103 @@
+// 主机端事件日志环形缓冲检查（pio run -e native_trace_check -t exec）
+// 检查写满后回绕覆盖最旧记录、重新打开后从最大序号继续写入，以及原始文件解码
+#ifdef V3_HOST_BUILD
+
+#include "v3/storage_backend_v3.h"
+#include "v3/trace_log_v3.h"
+#include <stdio.h>
+#include <vector>
+
+#define TRACE_CHECK_PATH        "/trace_check.log"
+#define TRACE_CHECK_CAPACITY    8
+
+static int check_failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        printf("   ❌ %s\n", what);
+        check_failures++;
+    }
+}
+
+static void append_and_write(TraceLogV3* trace, uint32_t count) {
+    trace_record_v3_t records[V3_TRACE_BUFFER_SIZE];
+    for (uint32_t i = 0; i < count; i++) {
+        trace->append(V3_TRACE_SESSION_SAVED, 0, i, (uint16_t)i, i);
+        if (trace->pendingCount() == V3_TRACE_BUFFER_SIZE) {
+            trace->writeRecords(records, trace->takePending(records, V3_TRACE_BUFFER_SIZE));
+        }
+    }
+    trace->writeRecords(records, trace->takePending(records, V3_TRACE_BUFFER_SIZE));
+}
+
+// 有效记录应为 [first_seq, last_seq] 连续递增
+static void check_window(TraceLogV3* trace, uint32_t first_seq, uint32_t last_seq) {
+    std::vector<trace_record_v3_t> records;
+    check(trace->readAll(&records), "读取日志");
+    check(records.size() == last_seq - first_seq + 1, "有效记录数");
+    for (size_t i = 0; i < records.size(); i++) {
+        if (records[i].seq != first_seq + i) {
+            check(false, "记录按序号连续");
+            break;
+        }
+    }
+}
+
+static bool run_backend(StorageBackendV3* backend) {
+    int failures_before = check_failures;
+    printf("📜 事件日志检查 [%s]\n", backend->name());
+    if (!backend->begin(true)) {
+        printf("   ❌ 挂载失败\n");
+        return false;
+    }
+    backend->remove(TRACE_CHECK_PATH);
+
+    // 写入超过容量的记录：只保留最新的capacity条
+    TraceLogV3 trace;
+    check(trace.begin(backend, TRACE_CHECK_PATH, TRACE_CHECK_CAPACITY), "创建日志");
+    append_and_write(&trace, 20);
+    check_window(&trace, 20 - TRACE_CHECK_CAPACITY + 1, 20);
+
+    size_t size = 0;
+    check(backend->stat(TRACE_CHECK_PATH, &size) &&
+          size == sizeof(trace_header_v3_t) + TRACE_CHECK_CAPACITY * sizeof(trace_record_v3_t),
+          "回绕后文件大小不变");
+
+    // 重新打开（模拟重启）：扫描恢复写入位置，继续覆盖最旧的槽位
+    TraceLogV3 reopened;
+    check(reopened.begin(backend, TRACE_CHECK_PATH, TRACE_CHECK_CAPACITY), "重新打开日志");
+    check(reopened.nextSeq() == 21, "重新打开后恢复序号");
+    append_and_write(&reopened, 3);
+    check_window(&reopened, 23 - TRACE_CHECK_CAPACITY + 1, 23);
+
+    // 原始文件直接解码（与解码工具的输入一致）
+    std::vector<uint8_t> raw(size);
+    std::vector<trace_record_v3_t> decoded;
+    check(backend->readAt(TRACE_CHECK_PATH, 0, raw.data(), raw.size()) == raw.size() &&
+          TraceLogV3::decode(raw.data(), raw.size(), &decoded) &&
+          decoded.size() == TRACE_CHECK_CAPACITY && decoded.back().seq == 23,
+          "解码原始文件");
+
+    // 容量改变时重建文件
+    TraceLogV3 resized;
+    check(resized.begin(backend, TRACE_CHECK_PATH, TRACE_CHECK_CAPACITY * 2) && resized.nextSeq() == 1,
+          "容量改变后重建");
+
+    backend->remove(TRACE_CHECK_PATH);
+    backend->end();
+
+    bool ok = check_failures == failures_before;
+    printf("   %s\n", ok ? "✅ 通过" : "❌ 失败");
+    return ok;
+}
+
+int main() {
+    RamStorageBackendV3 ram(V3_POSIX_STORAGE_QUOTA);
+    PosixStorageBackendV3 posix;
+
+    bool ok = run_backend(&ram);
+    ok = run_backend(&posix) && ok;
+    return ok ? 0 : 1;
+}
+
+#endif // V3_HOST_BUILD
@@ -0,0 +1,93 @@
+// 主机端事件日志解码工具（pio run -e native_trace_decode，再运行生成的程序）
+// 输入可以是从flash导出的/system.log原始文件，也可以是包含串口命令 trace hex 输出的串口日志
+// 用法: trace_decode <文件>   （省略文件时从标准输入读取）
+#ifdef V3_HOST_BUILD
+
+#include "v3/trace_log_v3.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static bool read_all(FILE* in, std::vector<uint8_t>* out) {
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        out->insert(out->end(), buf, buf + n);
+    }
+    return !ferror(in);
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 从串口日志中取出TRACE_BEGIN和TRACE_END之间的十六进制行
+static bool extract_hex_dump(const std::vector<uint8_t>& text, std::vector<uint8_t>* out) {
+    std::string s(text.begin(), text.end());
+    size_t begin = s.find("TRACE_BEGIN");
+    if (begin == std::string::npos) return false;
+    size_t end = s.find("TRACE_END", begin);
+    if (end == std::string::npos) end = s.size();
+
+    out->clear();
+    int high = -1;
+    for (size_t i = s.find('\n', begin); i < end; i++) {
+        int v = hex_value(s[i]);
+        if (v < 0) continue;
+        if (high < 0) {
+            high = v;
+        } else {
+            out->push_back((uint8_t)(high << 4 | v));
+            high = -1;
+        }
+    }
+    return !out->empty();
+}
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            fprintf(stderr, "无法打开文件: %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> data;
+    bool ok = read_all(in, &data);
+    if (in != stdin) fclose(in);
+    if (!ok) {
+        fprintf(stderr, "读取失败\n");
+        return 1;
+    }
+
+    // 原始文件以'J' 'L'开头，否则按串口十六进制输出处理
+    std::vector<uint8_t> raw;
+    if (data.size() >= 2 && data[0] == 'J' && data[1] == 'L') {
+        raw.swap(data);
+    } else if (!extract_hex_dump(data, &raw)) {
+        fprintf(stderr, "未找到事件日志（需要原始文件或TRACE_BEGIN/TRACE_END十六进制输出）\n");
+        return 1;
+    }
+
+    std::vector<trace_record_v3_t> records;
+    if (!TraceLogV3::decode(raw.data(), raw.size(), &records)) {
+        fprintf(stderr, "日志文件头无效\n");
+        return 1;
+    }
+
+    char line[160];
+    for (const trace_record_v3_t& record : records) {
+        TraceLogV3::formatRecord(record, line, sizeof(line));
+        printf("%s\n", line);
+    }
+    fprintf(stderr, "%zu 条记录\n", records.size());
+    return 0;
+}
+
+#endif // V3_HOST_BUILD
@@ -1,17 +1,19 @@
 #include "jumping_rocket_simple.h"
+#include "dlog.h"
 
 // V3.0 功能集成
 #ifdef JUMPING_ROCKET_V3
 #include "v3/board_config_v3.h"
 #include "v3/game_integration_v3.h"
 #include "v3/ui_views_v3.h"
+#include "v3/file_system_v3.h"
 
 // V3.0 外部函数声明
 extern bool initializeV3System();
 extern void loopV3();
 extern void testV3System();
 extern void printV3SystemInfo();
-extern void shutdownV3System();
+extern bool shutdownV3System();
 #endif
 
 // 任务句柄
@@ -29,14 +31,172 @@ extern "C" {
     void update_game_statistics(void);
 }
 
+static bool handle_serial_command(const char* line) {
+    if (telemetry_handle_command(line)) return true;
+    if (power_handle_command(line)) return true;
+    if (deep_sleep_handle_command(line)) return true;
+
+    if (strcmp(line, "boot") == 0) {
+        boot_print_timeline();
+        return true;
+    }
+    if (strcmp(line, "sensor") == 0) {
+        sensor_print_stats();
+        return true;
+    }
+    if (strcmp(line, "i2c") == 0) {
+        i2c_scan();
+        return true;
+    }
+#ifdef JUMPING_ROCKET_V3
+    if (strcmp(line, "selftest") == 0) {
+        // 系统测试会写入测试会话
+        Serial.println("⚠️ 系统测试会向今日数据写入测试会话");
+        testV3System();
+        return true;
+    }
+    if (strcmp(line, "info") == 0) {
+        printV3SystemInfo();
+        return true;
+    }
+    if (strcmp(line, "trace") == 0) {
+        fileSystemV3.printTraceLog();
+        return true;
+    }
+    if (strcmp(line, "trace hex") == 0) {
+        // 十六进制输出，保存串口日志后用主机端native_trace_decode解码
+        fileSystemV3.dumpTraceLogHex();
+        return true;
+    }
+#endif
+    return false;
+}
+
+// 串口命令：按行读取，交给各模块处理
+static void process_serial_commands() {
+    static char line[32];
+    static uint8_t length = 0;
+
+    while (Serial.available() > 0) {
+        char c = Serial.read();
+        if (c != '\r' && c != '\n') {
+            if (length < sizeof(line) - 1) {
+                line[length++] = c;
+            }
+            continue;
+        }
+        if (length == 0) continue;
+
+        line[length] = '\0';
+        length = 0;
+        if (!handle_serial_command(line)) {
+            Serial.printf("❓ 未知命令: %s（可用: tasks, tasks now, tasks history, power, sleep, sleep now, sensor, boot, i2c%s）\n", line,
+#ifdef JUMPING_ROCKET_V3
+                         ", selftest, info, trace, trace hex"
+#else
+                         ""
+#endif
+                         );
+        }
+    }
+}
+
+#ifdef JUMPING_ROCKET_V3
+// 初始化V3.0系统（快速启动时在任务创建之后执行，与OLED、传感器初始化和开机动画并行）
+static void setup_v3_system() {
+    Serial.println("🔧 初始化V3.0系统...");
+    if (!initializeV3System()) {
+        Serial.println("❌ V3.0系统初始化失败，继续使用V2.0模式");
+        markV3SetupFinished();
+        return;
+    }
+    Serial.println("✅ V3.0系统初始化成功");
+
+#if FAST_BOOT_ENABLED
+    // 系统测试会向真实数据写入测试会话，快速启动时改为串口命令
+    Serial.println("⏭️ 快速启动：跳过V3.0系统测试（串口命令 selftest / info）");
+#else
+    // 运行V3.0系统测试
+    Serial.println("🧪 运行V3.0系统测试...");
+    testV3System();
+
+    // 显示V3.0系统信息
+    printV3SystemInfo();
+
+    // 初始化V3.0游戏集成
+    Serial.println(" 初始化V3.0游戏集成...");
+    if (initGameIntegrationV3()) {
+        Serial.println("✅ V3.0游戏集成初始化成功");
+    } else {
+        Serial.println("❌ V3.0游戏集成初始化失败");
+    }
+#endif
+
+    // 检查V3.0兼容性
+    checkV3Compatibility();
+    boot_mark("v3_ready");
+    markV3SetupFinished();
+}
+#endif
+
+static bool create_tasks() {
+    Serial.println("创建任务...");
+    
+    // 任务遥测（各任务启动后登记循环周期）
+    telemetry_init();
+    
+    // 创建传感器任务
+    xTaskCreate(sensor_task, "sensor_task", 4096, NULL, 5, &sensor_task_handle);
+    if (sensor_task_handle == NULL) {
+        Serial.println("传感器任务创建失败");
+        return false;
+    }
+
+    // 创建显示任务
+    xTaskCreate(display_task, "display_task", 4096, NULL, 4, &display_task_handle);
+    if (display_task_handle == NULL) {
+        Serial.println("显示任务创建失败");
+        return false;
+    }
+
+    // 创建音效任务
+    xTaskCreate(sound_task, "sound_task", 4096, NULL, 3, &sound_task_handle);
+    if (sound_task_handle == NULL) {
+        Serial.println("音效任务创建失败");
+        return false;
+    }
+
+    // 创建按钮任务
+    xTaskCreate(button_task, "button_task", 2048, NULL, 6, &button_task_handle);
+    if (button_task_handle == NULL) {
+        Serial.println("按钮任务创建失败");
+        return false;
+    }
+
+    // 创建游戏任务
+    xTaskCreate(game_task, "game_task", 4096, NULL, 5, &game_task_handle);
+    if (game_task_handle == NULL) {
+        Serial.println("游戏任务创建失败");
+        return false;
+    }
+    
+    Serial.println("所有任务创建成功");
+    boot_mark("tasks");
+    return true;
+}
+
 void setup() {
     #ifdef UART_RX_PIN
     Serial.begin(115200, SERIAL_8N1, UART_RX_PIN, UART_TX_PIN);
     #else
     Serial.begin(115200);
     #endif
+    boot_mark("setup");
+    deep_sleep_init();
     
+#if !FAST_BOOT_ENABLED
     delay(2000); // 等待串口稳定
+#endif
     Serial.println("\n\n========================================");
     Serial.println("🚀 蹦跳小火箭 V2.0 启动 - 调试模式");
     Serial.println("========================================");
@@ -48,6 +208,10 @@ void setup() {
     Serial.printf("CPU频率: %d MHz\n", ESP.getCpuFreqMHz());
     Serial.printf("空闲堆内存: %d bytes\n", ESP.getFreeHeap());
     Serial.printf("开发板类型: %s\n", BOARD_NAME);
+    Serial.printf("启动模式: %s\n", FAST_BOOT_ENABLED ? "快速启动" : "完整启动");
+
+    // 热路径日志由低优先级任务输出
+    dlog_init();
 
 #ifdef JUMPING_ROCKET_V3
     Serial.printf("🚀 V3.0功能: 启用\n");
@@ -66,33 +230,10 @@ void setup() {
             Serial.println("系统已停止，请检查硬件连接");
         }
     }
+    boot_mark("hardware");
 
-#ifdef JUMPING_ROCKET_V3
-    // 初始化V3.0系统
-    Serial.println("🔧 初始化V3.0系统...");
-    if (!initializeV3System()) {
-        Serial.println("❌ V3.0系统初始化失败，继续使用V2.0模式");
-    } else {
-        Serial.println("✅ V3.0系统初始化成功");
-
-        // 运行V3.0系统测试
-        Serial.println("🧪 运行V3.0系统测试...");
-        testV3System();
-
-        // 显示V3.0系统信息
-        printV3SystemInfo();
-
-        // 初始化V3.0游戏集成
-        Serial.println(" 初始化V3.0游戏集成...");
-        if (initGameIntegrationV3()) {
-            Serial.println("✅ V3.0游戏集成初始化成功");
-        } else {
-            Serial.println("❌ V3.0游戏集成初始化失败");
-        }
-
-        // 检查V3.0兼容性
-        checkV3Compatibility();
-    }
+#if defined(JUMPING_ROCKET_V3) && !FAST_BOOT_ENABLED
+    setup_v3_system();
 #endif
 
     // 初始化数据处理器
@@ -103,46 +244,27 @@ void setup() {
     Serial.println("🎯 初始化游戏数据...");
     game_data_init();
 
-    Serial.println("🎮 准备启动游戏任务...");
-    
-    Serial.println("创建任务...");
-    
-    // 创建传感器任务
-    xTaskCreate(sensor_task, "sensor_task", 4096, NULL, 5, &sensor_task_handle);
-    if (sensor_task_handle == NULL) {
-        Serial.println("传感器任务创建失败");
-        return;
-    }
+    // 电源管理（游戏任务按状态切换功耗模式）
+    power_init();
 
-    // 创建显示任务
-    xTaskCreate(display_task, "display_task", 4096, NULL, 4, &display_task_handle);
-    if (display_task_handle == NULL) {
-        Serial.println("显示任务创建失败");
+    Serial.println("🎮 准备启动游戏任务...");
+    if (!create_tasks()) {
         return;
     }
 
-    // 创建音效任务
-    xTaskCreate(sound_task, "sound_task", 4096, NULL, 3, &sound_task_handle);
-    if (sound_task_handle == NULL) {
-        Serial.println("音效任务创建失败");
-        return;
+#if FAST_BOOT_ENABLED
+    // 音效任务已创建（优先级高于setup所在任务，创建后立即运行并建立队列），从深度睡眠唤醒时不播放
+    if (!deep_sleep_is_resume()) {
+        play_sound_effect(SOUND_BOOT);
     }
 
-    // 创建按钮任务
-    xTaskCreate(button_task, "button_task", 2048, NULL, 6, &button_task_handle);
-    if (button_task_handle == NULL) {
-        Serial.println("按钮任务创建失败");
-        return;
-    }
+#ifdef JUMPING_ROCKET_V3
+    // 显示任务初始化OLED和播放开机动画、传感器任务初始化MPU6050的同时加载V3.0数据
+    setup_v3_system();
+#endif
+#endif
 
-    // 创建游戏任务
-    xTaskCreate(game_task, "game_task", 4096, NULL, 5, &game_task_handle);
-    if (game_task_handle == NULL) {
-        Serial.println("游戏任务创建失败");
-        return;
-    }
-    
-    Serial.println("所有任务创建成功");
+    boot_mark("setup_done");
     Serial.println("=== 蹦跳小火箭 V2.0 启动完成 ===");
 }
 
@@ -190,20 +312,26 @@ void loop() {
         last_info_time = current_time;
     }
     
-    delay(1000); // 1秒检查一次
+    // 任务遥测采样和串口查询
+    telemetry_update();
+    process_serial_commands();
 
+    // 待机空闲超时：各任务停止、写出数据后进入深度睡眠（不返回）
+    if (deep_sleep_update()) {
+        deep_sleep_prepare();
 #ifdef JUMPING_ROCKET_V3
-    // V3.0主循环处理
-    loopV3();
-
-    // V3.0 UI模式检查和处理
-    if (V3_SHOULD_ENTER_UI()) {
-        V3_ENTER_UI();
+        // 写回任务退出前不能卸载文件系统，否则睡眠前的写入会损坏
+        while (!shutdownV3System()) {
+            delay(100);
+        }
+#endif
+        deep_sleep_start();
     }
+    
+    delay(1000); // 1秒检查一次
 
-    // V3.0 UI模式更新
-    if (V3_IS_IN_UI()) {
-        V3_UPDATE_UI();
-    }
+#ifdef JUMPING_ROCKET_V3
+    // V3.0主循环处理（UI的进入、按键、更新和渲染都在显示任务的UI循环中）
+    loopV3();
 #endif
 }
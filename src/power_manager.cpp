@@ -0,0 +1,206 @@
+#include "jumping_rocket_simple.h"
+#include "dlog.h"
+#include <esp_pm.h>
+
+// 电源管理：按游戏状态切换功耗模式。游戏中和发射动画期间持有锁，保持最高频率且不进入浅睡眠，
+// 保证20ms传感器采样和跳跃检测的时序；其它状态（待机、结算、菜单）释放锁，
+// 由ESP-IDF动态调频在各任务轮询的间隙降到最低频率，sdkconfig支持时自动进入浅睡眠
+//
+// 注意：
+// - 需要sdkconfig打开CONFIG_PM_ENABLE，自动浅睡眠还需要CONFIG_FREERTOS_USE_TICKLESS_IDLE，
+//   不支持时退回只调频或不管理
+// - 当前发布的构建（platformio.ini中framework = arduino）使用Arduino预编译的sdkconfig，
+//   没有开启tickless idle，因此只有动态调频、不会自动浅睡眠（启动日志和power命令会显示“只调频”）；
+//   根目录的sdkconfig不参与该构建
+// - 浅睡眠期间串口接收会丢字符，调试串口命令时可用-DPOWER_MANAGEMENT_ENABLED=0关闭
+// - 估算电流按数据手册典型值和固定的CPU占空比计算，只用于比较各状态，不代替实测
+
+// 估算用电流（mA）：CPU部分参考ESP32-C3数据手册（射频关闭），外设为典型值
+#define POWER_EST_RUN_MAX_MA        23.0f   // 最高频率运行
+#define POWER_EST_IDLE_MAX_MA       16.0f   // 最高频率空闲（等待中断）
+#define POWER_EST_RUN_MIN_MA        17.0f   // 最低频率运行
+#define POWER_EST_IDLE_MIN_MA       13.0f   // 最低频率空闲
+#define POWER_EST_LIGHT_SLEEP_MA    0.13f   // 浅睡眠
+#define POWER_EST_PERIPHERAL_MA     12.0f   // OLED（约8mA）+ MPU6050（约4mA）
+#define POWER_EST_CPU_DUTY          0.2f    // 估计的CPU忙碌比例（各任务轮询+屏幕刷新）
+
+#define POWER_STATE_COUNT           (GAME_STATE_RESULT + 1)
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+typedef esp_pm_config_t power_pm_config_t;
+#elif CONFIG_IDF_TARGET_ESP32C3
+typedef esp_pm_config_esp32c3_t power_pm_config_t;
+#else
+typedef esp_pm_config_esp32_t power_pm_config_t;
+#endif
+
+static const char* const power_state_names[POWER_STATE_COUNT] = {
+    "IDLE", "DIFFICULTY", "PLAYING", "PAUSED", "RESET", "LAUNCHING", "RESULT"
+};
+
+static bool power_dfs_enabled = false;
+static bool power_light_sleep_enabled = false;
+static uint32_t power_max_mhz = 0;
+static power_mode_t power_mode = POWER_MODE_PERFORMANCE;   // 初始化前按最高频率估算
+static game_state_t power_last_state = GAME_STATE_IDLE;
+static uint32_t power_last_ms = 0;
+static uint32_t power_state_ms[POWER_STATE_COUNT];          // 各状态累计停留时间
+static portMUX_TYPE power_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t power_cpu_lock = NULL;          // 保持最高频率
+static esp_pm_lock_handle_t power_sleep_lock = NULL;        // 禁止浅睡眠
+#endif
+
+static power_mode_t power_mode_for_state(game_state_t state) {
+    return (state == GAME_STATE_PLAYING || state == GAME_STATE_LAUNCHING) ?
+           POWER_MODE_PERFORMANCE : POWER_MODE_ECO;
+}
+
+static void power_set_mode(power_mode_t mode) {
+    if (mode == power_mode) return;
+
+#if CONFIG_PM_ENABLE
+    if (power_dfs_enabled) {
+        if (mode == POWER_MODE_PERFORMANCE) {
+            esp_pm_lock_acquire(power_cpu_lock);
+            esp_pm_lock_acquire(power_sleep_lock);
+        } else {
+            esp_pm_lock_release(power_sleep_lock);
+            esp_pm_lock_release(power_cpu_lock);
+        }
+    }
+#endif
+    power_mode = mode;
+}
+
+void power_init(void) {
+    memset(power_state_ms, 0, sizeof(power_state_ms));
+    power_max_mhz = getCpuFrequencyMhz();
+    power_last_state = current_state;
+    power_last_ms = millis();
+
+#if POWER_MANAGEMENT_ENABLED && CONFIG_PM_ENABLE
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "game_cpu", &power_cpu_lock) != ESP_OK ||
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "game_sleep", &power_sleep_lock) != ESP_OK) {
+        Serial.println("❌ 电源管理锁创建失败，保持固定频率");
+        return;
+    }
+
+    // 先持有锁再打开调频，当前状态需要低功耗时由power_update释放
+    esp_pm_lock_acquire(power_cpu_lock);
+    esp_pm_lock_acquire(power_sleep_lock);
+
+    power_pm_config_t config = {};
+    config.max_freq_mhz = power_max_mhz;
+    config.min_freq_mhz = POWER_CPU_MIN_MHZ;
+    config.light_sleep_enable = true;
+
+    esp_err_t err = esp_pm_configure(&config);
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        // sdkconfig未打开tickless idle，只做动态调频
+        config.light_sleep_enable = false;
+        err = esp_pm_configure(&config);
+    }
+    if (err != ESP_OK) {
+        esp_pm_lock_release(power_sleep_lock);
+        esp_pm_lock_release(power_cpu_lock);
+        Serial.printf("❌ 动态调频配置失败: %s，保持固定频率\n", esp_err_to_name(err));
+        return;
+    }
+
+    power_dfs_enabled = true;
+    power_light_sleep_enabled = config.light_sleep_enable;
+    power_mode = POWER_MODE_PERFORMANCE;
+    power_set_mode(power_mode_for_state(current_state));
+
+    Serial.printf("⚡ 电源管理: 动态调频 %d-%lu MHz, 自动浅睡眠%s\n", POWER_CPU_MIN_MHZ, power_max_mhz,
+                 power_light_sleep_enabled ? "已启用" : "不可用（未开启tickless idle）");
+#elif POWER_MANAGEMENT_ENABLED
+    Serial.printf("⚠️ 电源管理不可用（sdkconfig未开启CONFIG_PM_ENABLE），固定 %lu MHz\n", power_max_mhz);
+#else
+    Serial.printf("⚡ 电源管理已关闭，固定 %lu MHz\n", power_max_mhz);
+#endif
+}
+
+// 把上次更新以来的时间计入上一个状态（调用方持有power_mux）
+static void power_account(uint32_t now) {
+    if (power_last_state < POWER_STATE_COUNT) {
+        power_state_ms[power_last_state] += now - power_last_ms;
+    }
+    power_last_ms = now;
+}
+
+// 由游戏任务周期调用
+void power_update(void) {
+    game_state_t state = current_state;
+
+    portENTER_CRITICAL(&power_mux);
+    power_account(millis());
+    game_state_t last_state = power_last_state;
+    power_last_state = state;
+    portEXIT_CRITICAL(&power_mux);
+
+    if (state != last_state) {
+        power_mode_t mode = power_mode_for_state(state);
+        if (mode != power_mode) {
+            DLOG_D("⚡ 功耗模式: %s (%s)\n", mode == POWER_MODE_PERFORMANCE ? "性能" : "节能",
+                   state < POWER_STATE_COUNT ? power_state_names[state] : "?");
+        }
+        power_set_mode(mode);
+    }
+}
+
+power_mode_t power_get_mode(void) {
+    return power_mode;
+}
+
+// 某状态下的估算电流
+static float power_estimate_ma(game_state_t state) {
+    float run_ma, rest_ma;
+    if (!power_dfs_enabled || power_mode_for_state(state) == POWER_MODE_PERFORMANCE) {
+        run_ma = POWER_EST_RUN_MAX_MA;
+        rest_ma = POWER_EST_IDLE_MAX_MA;
+    } else {
+        run_ma = POWER_EST_RUN_MIN_MA;
+        rest_ma = power_light_sleep_enabled ? POWER_EST_LIGHT_SLEEP_MA : POWER_EST_IDLE_MIN_MA;
+    }
+    return POWER_EST_CPU_DUTY * run_ma + (1.0f - POWER_EST_CPU_DUTY) * rest_ma + POWER_EST_PERIPHERAL_MA;
+}
+
+void power_print_report(void) {
+    uint32_t state_ms[POWER_STATE_COUNT];
+    portENTER_CRITICAL(&power_mux);
+    power_account(millis());
+    memcpy(state_ms, power_state_ms, sizeof(state_ms));
+    portEXIT_CRITICAL(&power_mux);
+
+    Serial.printf("⚡ 电源管理: %s, 当前 %lu MHz, 模式 %s\n",
+                 power_dfs_enabled ? (power_light_sleep_enabled ? "调频+浅睡眠" : "只调频") : "固定频率",
+                 getCpuFrequencyMhz(), power_mode == POWER_MODE_PERFORMANCE ? "性能" : "节能");
+    Serial.println("   状态          时长(s)  模式  估算电流");
+
+    uint32_t total_ms = 0;
+    float total_mas = 0;    // mA·s
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        game_state_t state = (game_state_t)i;
+        float ma = power_estimate_ma(state);
+        Serial.printf("   %-12s %8lu  %s  %5.1f mA\n", power_state_names[i], state_ms[i] / 1000,
+                     power_mode_for_state(state) == POWER_MODE_PERFORMANCE ? "性能" : "节能", ma);
+        total_ms += state_ms[i];
+        total_mas += ma * (state_ms[i] / 1000.0f);
+    }
+
+    if (total_ms > 0) {
+        Serial.printf("   平均 %.1f mA, 累计 %.2f mAh（按典型值估算）\n",
+                     total_mas / (total_ms / 1000.0f), total_mas / 3600.0f);
+    }
+}
+
+bool power_handle_command(const char* command) {
+    if (strcmp(command, "power") == 0) {
+        power_print_report();
+        return true;
+    }
+    return false;
+}
@@ -1,4 +1,5 @@
 #include "jumping_rocket_simple.h"
+#include "dlog.h"
 
 // V3.0 集成
 #ifdef JUMPING_ROCKET_V3
@@ -18,9 +19,12 @@ Adafruit_MPU6050 mpu;
 // 滤波器参数
 #define FILTER_ALPHA            0.7f    // 低通滤波器系数 - 调整响应性
 
-// 调试输出控制
-#define DEBUG_SENSOR_DATA       false   // 是否输出详细传感器数据
-#define DEBUG_JUMP_DETECTION    true    // 是否输出跳跃检测调试信息
+// 自适应采样：游戏中、以及待机中检测到动作后的一段时间全速读取；其它时间MPU6050处于低功耗循环模式，
+// 传感器任务等待动作中断，不读I2C
+#define SENSOR_SAMPLE_MS        20      // 全速采样周期(50Hz)
+#define SENSOR_LP_WAIT_MS       100     // 低功耗时检查游戏状态的周期（只读内存）
+#define SENSOR_LP_POLL_MS       1000    // 低功耗时读一次中断状态，INT未接线或漏掉边沿时兜底
+#define SENSOR_ACTIVE_HOLD_MS   3000    // 待机中动作后保持全速的时间（覆盖连续两次跳跃的2秒间隔）
 
 // 传感器数据
 sensor_data_t sensor_data = {0};
@@ -38,6 +42,19 @@ static uint32_t jump_start_time = 0;
 static uint32_t last_jump_time = 0;
 static float filtered_magnitude = 1.0f;
 
+// 自适应采样状态
+static TaskHandle_t sensor_task_self = NULL;
+static bool sensor_low_power = false;
+static uint32_t sensor_last_motion_ms = 0;
+static uint32_t sensor_lp_enter_ms = 0;
+static uint32_t sensor_lp_last_poll_ms = 0;
+
+// 统计（串口命令sensor）
+static uint32_t sensor_stat_reads = 0;          // 全速读取次数
+static uint32_t sensor_stat_wakeups = 0;        // 低功耗→全速切换次数
+static uint32_t sensor_stat_polls = 0;          // 低功耗时的中断状态查询次数
+static uint32_t sensor_stat_lp_ms = 0;          // 累计低功耗时间
+
 // 低通滤波器
 static float low_pass_filter(float current_value, float previous_filtered) {
     return FILTER_ALPHA * previous_filtered + (1.0f - FILTER_ALPHA) * current_value;
@@ -59,15 +76,9 @@ bool detect_jump(float accel_x, float accel_y, float accel_z) {
     sensor_data.accel_z = accel_z;
     sensor_data.magnitude = filtered_magnitude;
 
-    // 调试输出传感器数据
-    if (DEBUG_SENSOR_DATA) {
-        static uint32_t last_debug_time = 0;
-        if (current_time - last_debug_time >= 1000) { // 每秒输出一次
-            Serial.printf("传感器数据 - X:%.2f Y:%.2f Z:%.2f 幅值:%.2f 滤波:%.2f\n",
-                         accel_x, accel_y, accel_z, magnitude, filtered_magnitude);
-            last_debug_time = current_time;
-        }
-    }
+    // 调试输出传感器数据（每秒一次）
+    DLOG_RATE_V(1000, "传感器数据 - X:%.2f Y:%.2f Z:%.2f 幅值:%.2f 滤波:%.2f\n",
+                accel_x, accel_y, accel_z, magnitude, filtered_magnitude);
 
     bool jump_detected = false;
 
@@ -77,10 +88,8 @@ bool detect_jump(float accel_x, float accel_y, float accel_z) {
             if (filtered_magnitude > JUMP_THRESHOLD_HIGH) {
                 jump_state = JUMP_STATE_RISING;
                 jump_start_time = current_time;
-                if (DEBUG_JUMP_DETECTION) {
-                    Serial.printf("🚀 跳跃开始检测，幅值: %.2f (阈值: %.2f)\n",
-                                 filtered_magnitude, JUMP_THRESHOLD_HIGH);
-                }
+                DLOG_D("🚀 跳跃开始检测，幅值: %.2f (阈值: %.2f)\n",
+                       filtered_magnitude, JUMP_THRESHOLD_HIGH);
             }
             break;
 
@@ -88,17 +97,13 @@ bool detect_jump(float accel_x, float accel_y, float accel_z) {
             // 检测跳跃峰值后的下降
             if (filtered_magnitude < JUMP_THRESHOLD_LOW) {
                 jump_state = JUMP_STATE_FALLING;
-                if (DEBUG_JUMP_DETECTION) {
-                    Serial.printf("📉 跳跃下降阶段，幅值: %.2f (阈值: %.2f)\n",
-                                 filtered_magnitude, JUMP_THRESHOLD_LOW);
-                }
+                DLOG_D("📉 跳跃下降阶段，幅值: %.2f (阈值: %.2f)\n",
+                       filtered_magnitude, JUMP_THRESHOLD_LOW);
             } else if (current_time - jump_start_time > JUMP_MAX_DURATION) {
                 // 超时，重置状态
                 jump_state = JUMP_STATE_IDLE;
-                if (DEBUG_JUMP_DETECTION) {
-                    Serial.printf("⏰ 跳跃检测超时，重置状态 (持续时间: %lu ms)\n",
-                                 current_time - jump_start_time);
-                }
+                DLOG_D("⏰ 跳跃检测超时，重置状态 (持续时间: %lu ms)\n",
+                       current_time - jump_start_time);
             }
             break;
 
@@ -113,29 +118,23 @@ bool detect_jump(float accel_x, float accel_y, float accel_z) {
                     if (current_time - last_jump_time >= JUMP_COOLDOWN) {
                         jump_detected = true;
                         last_jump_time = current_time;
-                        Serial.printf("✅ 跳跃检测成功！持续时间: %lu ms, 幅值: %.2f\n",
-                                     jump_duration, filtered_magnitude);
+                        DLOG_I("✅ 跳跃检测成功！持续时间: %lu ms, 幅值: %.2f\n",
+                               jump_duration, filtered_magnitude);
                     } else {
-                        if (DEBUG_JUMP_DETECTION) {
-                            Serial.printf("❄️ 跳跃在冷却期内，忽略 (剩余: %lu ms)\n",
-                                         JUMP_COOLDOWN - (current_time - last_jump_time));
-                        }
+                        DLOG_D("❄️ 跳跃在冷却期内，忽略 (剩余: %lu ms)\n",
+                               JUMP_COOLDOWN - (current_time - last_jump_time));
                     }
                 } else {
-                    if (DEBUG_JUMP_DETECTION) {
-                        Serial.printf("⚠️ 跳跃持续时间不符合要求: %lu ms (要求: %d-%d ms)\n",
-                                     jump_duration, JUMP_MIN_DURATION, JUMP_MAX_DURATION);
-                    }
+                    DLOG_D("⚠️ 跳跃持续时间不符合要求: %lu ms (要求: %d-%d ms)\n",
+                           jump_duration, JUMP_MIN_DURATION, JUMP_MAX_DURATION);
                 }
 
                 jump_state = JUMP_STATE_COOLDOWN;
             } else if (current_time - jump_start_time > JUMP_MAX_DURATION) {
                 // 超时，重置状态
                 jump_state = JUMP_STATE_IDLE;
-                if (DEBUG_JUMP_DETECTION) {
-                    Serial.printf("⏰ 跳跃着地检测超时，重置状态 (持续时间: %lu ms)\n",
-                                 current_time - jump_start_time);
-                }
+                DLOG_D("⏰ 跳跃着地检测超时，重置状态 (持续时间: %lu ms)\n",
+                       current_time - jump_start_time);
             }
             break;
 
@@ -143,9 +142,7 @@ bool detect_jump(float accel_x, float accel_y, float accel_z) {
             // 冷却期，等待状态稳定
             if (current_time - last_jump_time >= JUMP_COOLDOWN) {
                 jump_state = JUMP_STATE_IDLE;
-                if (DEBUG_JUMP_DETECTION) {
-                    Serial.println("🔄 跳跃冷却完成，状态重置");
-                }
+                DLOG_D("🔄 跳跃冷却完成，状态重置\n");
             }
             break;
     }
@@ -205,6 +202,121 @@ bool mpu6050_init_sensor(void) {
     return true;
 }
 
+// 陀螺仪和温度传感器待机，加速度计进入低功耗循环模式；高通滤波后的加速度超过阈值时
+// INT输出高电平并锁存，读中断状态寄存器清除
+static void mpu6050_enter_cycle(mpu6050_cycle_rate_t rate) {
+    mpu.setHighPassFilter(MPU6050_HIGHPASS_0_63_HZ);    // 去掉重力分量
+    mpu.setMotionDetectionThreshold(MPU6050_MOTION_THRESHOLD);
+    mpu.setMotionDetectionDuration(MPU6050_MOTION_DURATION);
+    mpu.setInterruptPinPolarity(false);                 // 高电平有效
+    mpu.setInterruptPinLatch(true);
+    mpu.getMotionInterruptStatus();                     // 清除之前锁存的中断
+    ulTaskNotifyTake(pdTRUE, 0);                        // 先丢弃旧通知，启用后的动作不会被清掉
+    mpu.setMotionInterrupt(true);
+
+    mpu.setGyroStandby(true, true, true);
+    mpu.setTemperatureStandby(true);
+    mpu.setCycleRate(rate);
+    mpu.enableCycle(true);
+}
+
+// 恢复连续测量
+static void mpu6050_exit_cycle(void) {
+    mpu.enableCycle(false);
+    mpu.setMotionInterrupt(false);
+    mpu.getMotionInterruptStatus();
+    mpu.setGyroStandby(false, false, false);
+    mpu.setTemperatureStandby(false);
+}
+
+// 深度睡眠前调用（传感器任务中）：INT锁存到下次复位（ESP32唤醒后重新初始化时清除）
+bool mpu6050_enable_wake_on_motion(void) {
+    Wire.beginTransmission(MPU6050_ADDR);
+    if (Wire.endTransmission() != 0) {
+        Serial.println("❌ MPU6050无响应，无法启用动作唤醒");
+        return false;
+    }
+
+    mpu6050_enter_cycle(MPU6050_CYCLE_5_HZ);
+
+    Serial.printf("✅ MPU6050动作唤醒已启用: 5Hz循环, 阈值 %dmg, INT->GPIO%d\n",
+                 MPU6050_MOTION_THRESHOLD * 2, MPU_INT_PIN);
+    return true;
+}
+
+// MPU6050 INT上升沿：唤醒等待动作的传感器任务
+static void IRAM_ATTR mpu6050_int_isr(void) {
+    BaseType_t woken = pdFALSE;
+    if (sensor_task_self) {
+        vTaskNotifyGiveFromISR(sensor_task_self, &woken);
+    }
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// 游戏中始终全速；待机时动作后保持一段时间全速，用于识别连续两次跳跃；其它状态（菜单、结算等）不使用跳跃检测
+static bool sensor_needs_full_rate(uint32_t now) {
+    if (current_state == GAME_STATE_PLAYING) return true;
+    return current_state == GAME_STATE_IDLE && now - sensor_last_motion_ms < SENSOR_ACTIVE_HOLD_MS;
+}
+
+static void sensor_enter_low_power(uint32_t now) {
+    mpu6050_enter_cycle(MPU6050_CYCLE_40_HZ);           // 其中丢弃全速期间的通知
+    sensor_low_power = true;
+    sensor_lp_enter_ms = now;
+    sensor_lp_last_poll_ms = now;
+    DLOG_D("💤 传感器进入低功耗循环模式\n");
+}
+
+static void sensor_exit_low_power(uint32_t now, bool motion) {
+    mpu6050_exit_cycle();
+    sensor_low_power = false;
+    sensor_stat_lp_ms += now - sensor_lp_enter_ms;
+    sensor_stat_wakeups++;
+
+    // 低功耗期间滤波器和跳跃状态已过时，从头开始
+    jump_state = JUMP_STATE_IDLE;
+    filtered_magnitude = 1.0f;
+
+    if (motion) {
+        sensor_last_motion_ms = now;
+        deep_sleep_note_activity();
+    }
+    DLOG_D("⚡ 传感器恢复全速采样（%s）\n", motion ? "动作" : "游戏开始");
+}
+
+// 低功耗时等待动作中断，返回true表示已恢复全速采样
+static bool sensor_wait_for_motion(void) {
+    bool motion = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SENSOR_LP_WAIT_MS)) > 0;
+    uint32_t now = millis();
+
+    if (!motion && now - sensor_lp_last_poll_ms >= SENSOR_LP_POLL_MS) {
+        sensor_lp_last_poll_ms = now;
+        sensor_stat_polls++;
+        motion = mpu.getMotionInterruptStatus();
+    }
+    if (!motion && !sensor_needs_full_rate(now)) return false;
+
+    sensor_exit_low_power(now, motion);
+    return true;
+}
+
+bool sensor_is_low_power(void) {
+    return sensor_low_power;
+}
+
+void sensor_print_stats(void) {
+    uint32_t now = millis();
+    uint32_t lp_ms = sensor_stat_lp_ms + (sensor_low_power ? now - sensor_lp_enter_ms : 0);
+
+    Serial.printf("📡 传感器: %s, 自适应采样%s\n", sensor_low_power ? "低功耗循环(40Hz)" : "全速(50Hz)",
+                 SENSOR_ADAPTIVE_SAMPLING ? "已启用" : "已关闭");
+    Serial.printf("   全速读取 %lu 次, 低功耗 %lu 秒（占 %lu%%）, 动作唤醒 %lu 次, 中断状态查询 %lu 次\n",
+                 sensor_stat_reads, lp_ms / 1000, now ? (uint32_t)((uint64_t)lp_ms * 100 / now) : 0,
+                 sensor_stat_wakeups, sensor_stat_polls);
+}
+
 // 读取MPU6050加速度数据（使用Adafruit库）
 bool mpu6050_read_accel(float* accel_x, float* accel_y, float* accel_z) {
     sensors_event_t a, g, temp;
@@ -230,15 +342,50 @@ void sensor_task(void* pvParameters) {
         vTaskDelete(NULL);
         return;
     }
+    boot_mark("mpu");
+
+#if SENSOR_ADAPTIVE_SAMPLING
+    sensor_task_self = xTaskGetCurrentTaskHandle();
+    sensor_last_motion_ms = millis();
+    pinMode(MPU_INT_PIN, INPUT_PULLDOWN);   // INT高电平有效，未接或MPU6050未驱动时不悬空（GPIO34-39无内部下拉，需外接）
+    attachInterrupt(digitalPinToInterrupt(MPU_INT_PIN), mpu6050_int_isr, RISING);
+#endif
 
     while (1) {
+        telemetry_loop_tick(TELEMETRY_TASK_SENSOR);
+
+        // 深度睡眠前切换到动作唤醒，失败时不报告停止（只能按键唤醒）
+        if (deep_sleep_pending()) {
+            if (mpu6050_enable_wake_on_motion()) {
+                deep_sleep_park(DEEP_SLEEP_PARK_SENSOR);
+            }
+            vTaskSuspend(NULL);
+        }
+
+#if SENSOR_ADAPTIVE_SAMPLING
+        if (sensor_low_power) {
+            if (!sensor_wait_for_motion()) continue;
+        } else if (!sensor_needs_full_rate(millis())) {
+            sensor_enter_low_power(millis());
+            continue;
+        }
+#endif
+
         float accel_x, accel_y, accel_z;
 
         // 读取加速度数据
         if (mpu6050_read_accel(&accel_x, &accel_y, &accel_z)) {
+            sensor_stat_reads++;
+
             // 执行跳跃检测
             bool jump_detected = detect_jump(accel_x, accel_y, accel_z);
 
+            // 拿起、晃动等动作推迟深度睡眠
+            if (jump_detected || fabsf(sensor_data.magnitude - 1.0f) > DEEP_SLEEP_MOTION_G) {
+                sensor_last_motion_ms = millis();
+                deep_sleep_note_activity();
+            }
+
             // 如果检测到跳跃
             if (jump_detected) {
                 // 如果在待机状态，需要更严格的条件才能启动游戏
@@ -257,7 +404,7 @@ void sensor_task(void* pvParameters) {
                     idle_jump_count++;
                     last_idle_jump_time = current_time;
 
-                    Serial.printf("🔍 待机状态跳跃检测: 第%lu次，需要连续2次明确跳跃才能启动游戏\n", idle_jump_count);
+                    DLOG_I("🔍 待机状态跳跃检测: 第%lu次，需要连续2次明确跳跃才能启动游戏\n", idle_jump_count);
 
                     // 需要连续2次明确的跳跃才能进入难度选择
                     if (idle_jump_count >= 2) {
@@ -271,7 +418,7 @@ void sensor_task(void* pvParameters) {
                         // 重置待机跳跃计数
                         idle_jump_count = 0;
                     } else {
-                        Serial.printf("   等待更多跳跃确认 (%lu/2)\n", idle_jump_count);
+                        DLOG_I("   等待更多跳跃确认 (%lu/2)\n", idle_jump_count);
                     }
                 }
                 // 如果游戏正在进行，更新跳跃计数
@@ -283,8 +430,8 @@ void sensor_task(void* pvParameters) {
                     // 播放跳跃音效
                     play_sound_effect(SOUND_JUMP);
 
-                    Serial.printf("⬆️ 跳跃计数: %lu，时间: %lu ms\n",
-                                 game_data.jump_count, millis());
+                    DLOG_I("⬆️ 跳跃计数: %lu，时间: %lu ms\n",
+                           game_data.jump_count, millis());
 
 #ifdef JUMPING_ROCKET_V3
                     // V3.0跳跃检测事件
@@ -293,7 +440,7 @@ void sensor_task(void* pvParameters) {
                 }
             }
         } else {
-            Serial.println("读取传感器数据失败");
+            DLOG_RATE_W(1000, "读取传感器数据失败\n");
         }
 
         // 重置跳跃标志
@@ -302,6 +449,6 @@ void sensor_task(void* pvParameters) {
         }
 
         // 等待下次采样
-        delay(20); // 50Hz采样率
+        delay(SENSOR_SAMPLE_MS); // 50Hz采样率
     }
 }
@@ -168,6 +168,7 @@ void sound_task(void* pvParameters) {
     while (1) {
         // 等待音效请求
         if (xQueueReceive(sound_queue, &sound_type, portMAX_DELAY) == pdTRUE) {
+            telemetry_loop_tick(TELEMETRY_TASK_SOUND);
             Serial.printf("播放音效: %d\n", sound_type);
             
             switch (sound_type) {
@@ -0,0 +1,295 @@
+#include "jumping_rocket_simple.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// 任务遥测：定期采样FreeRTOS运行时间统计、各任务栈最小剩余和主循环周期，
+// 保存在固定大小的环形缓冲区中，通过串口命令查询（用于确定任务栈大小、找出占用单核C3的任务）
+
+// 运行时间统计需要sdkconfig打开trace facility和run time stats，否则只记录栈和循环周期
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+#define TELEMETRY_RUNTIME_STATS     1
+#else
+#define TELEMETRY_RUNTIME_STATS     0
+#endif
+
+#define TELEMETRY_CPU_UNKNOWN       0xFFFF
+#define TELEMETRY_STATUS_SLOTS      (TELEMETRY_MAX_TASKS + 8)   // uxTaskGetSystemState数组不够大时返回0
+
+// 单个任务的采样
+typedef struct {
+    char name[TELEMETRY_NAME_LEN];
+    uint16_t cpu_permille;      // 采样窗口内的CPU占用（千分比），TELEMETRY_CPU_UNKNOWN表示不可用
+    uint16_t stack_free;        // 栈历史最小剩余（字节）
+    uint8_t priority;
+    uint8_t loop_task;          // 登记了循环周期的任务编号+1，0表示未登记
+    uint32_t loop_avg_us;       // 窗口内平均循环周期
+    uint32_t loop_max_us;       // 窗口内最大循环周期
+    uint32_t loop_count;        // 窗口内循环次数
+} telemetry_task_sample_t;
+
+// 一次采样
+typedef struct {
+    uint32_t time_ms;
+    uint32_t window_ms;
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    uint8_t task_count;
+    telemetry_task_sample_t tasks[TELEMETRY_MAX_TASKS];
+} telemetry_sample_t;
+
+// 各任务循环周期累计（由任务自己在循环开头调用telemetry_loop_tick更新）
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t last_us;
+    uint32_t sum_us;
+    uint32_t max_us;
+    uint32_t count;
+} telemetry_loop_t;
+
+static telemetry_sample_t telemetry_ring[TELEMETRY_RING_SIZE];
+static uint8_t telemetry_head = 0;          // 下一次写入的位置
+static uint8_t telemetry_count = 0;
+static uint32_t telemetry_last_sample_ms = 0;
+static uint32_t telemetry_stack_warned = 0; // 已报警过的登记任务（按位）
+
+static telemetry_loop_t telemetry_loops[TELEMETRY_TASK_COUNT];
+static portMUX_TYPE telemetry_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if TELEMETRY_RUNTIME_STATS
+static TaskStatus_t telemetry_status[TELEMETRY_STATUS_SLOTS];
+static struct {
+    TaskHandle_t handle;
+    uint32_t run_time;
+} telemetry_prev_run[TELEMETRY_STATUS_SLOTS];
+static uint8_t telemetry_prev_count = 0;
+static uint32_t telemetry_prev_total = 0;
+#endif
+
+void telemetry_init(void) {
+    memset(telemetry_ring, 0, sizeof(telemetry_ring));
+    memset(telemetry_loops, 0, sizeof(telemetry_loops));
+    telemetry_head = 0;
+    telemetry_count = 0;
+    telemetry_last_sample_ms = millis();
+
+    Serial.printf("📈 任务遥测: 每%d秒采样, 保留%d次, CPU占用统计%s\n",
+                 TELEMETRY_SAMPLE_MS / 1000, TELEMETRY_RING_SIZE,
+                 TELEMETRY_RUNTIME_STATS ? "可用" : "不可用（未开启run time stats）");
+}
+
+void telemetry_loop_tick(telemetry_task_t task) {
+    if (task >= TELEMETRY_TASK_COUNT) return;
+
+    uint32_t now_us = micros();
+    portENTER_CRITICAL(&telemetry_mux);
+    telemetry_loop_t& loop = telemetry_loops[task];
+    if (loop.handle == NULL) {
+        loop.handle = xTaskGetCurrentTaskHandle();
+    } else {
+        uint32_t interval = now_us - loop.last_us;
+        loop.sum_us += interval;
+        if (interval > loop.max_us) loop.max_us = interval;
+        loop.count++;
+    }
+    loop.last_us = now_us;
+    portEXIT_CRITICAL(&telemetry_mux);
+}
+
+static void telemetry_copy_name(char* dst, const char* src) {
+    strncpy(dst, src ? src : "?", TELEMETRY_NAME_LEN - 1);
+    dst[TELEMETRY_NAME_LEN - 1] = '\0';
+}
+
+// 把循环周期统计填入对应任务的采样
+static void telemetry_fill_loop(telemetry_task_sample_t& task, TaskHandle_t handle,
+                                const telemetry_loop_t* loops) {
+    for (int i = 0; i < TELEMETRY_TASK_COUNT; i++) {
+        if (loops[i].handle == handle) {
+            task.loop_task = i + 1;
+            task.loop_count = loops[i].count;
+            task.loop_max_us = loops[i].max_us;
+            task.loop_avg_us = loops[i].count ? loops[i].sum_us / loops[i].count : 0;
+            return;
+        }
+    }
+}
+
+static void telemetry_take_sample(uint32_t now_ms) {
+    telemetry_sample_t& sample = telemetry_ring[telemetry_head];
+    memset(&sample, 0, sizeof(sample));
+    sample.time_ms = now_ms;
+    sample.window_ms = now_ms - telemetry_last_sample_ms;
+    sample.free_heap = ESP.getFreeHeap();
+    sample.min_free_heap = ESP.getMinFreeHeap();
+
+    // 取出本窗口的循环周期统计并清零
+    telemetry_loop_t loops[TELEMETRY_TASK_COUNT];
+    portENTER_CRITICAL(&telemetry_mux);
+    memcpy(loops, telemetry_loops, sizeof(loops));
+    for (int i = 0; i < TELEMETRY_TASK_COUNT; i++) {
+        telemetry_loops[i].sum_us = 0;
+        telemetry_loops[i].max_us = 0;
+        telemetry_loops[i].count = 0;
+    }
+    portEXIT_CRITICAL(&telemetry_mux);
+
+#if TELEMETRY_RUNTIME_STATS
+    uint32_t total_run_time = 0;
+    UBaseType_t n = uxTaskGetSystemState(telemetry_status, TELEMETRY_STATUS_SLOTS, &total_run_time);
+    uint32_t total_delta = total_run_time - telemetry_prev_total;
+
+    for (UBaseType_t i = 0; i < n && sample.task_count < TELEMETRY_MAX_TASKS; i++) {
+        const TaskStatus_t& status = telemetry_status[i];
+        telemetry_task_sample_t& task = sample.tasks[sample.task_count++];
+        telemetry_copy_name(task.name, status.pcTaskName);
+        task.priority = status.uxCurrentPriority;
+        task.stack_free = status.usStackHighWaterMark > 0xFFFF ? 0xFFFF : status.usStackHighWaterMark;
+
+        // 与上次采样的运行时间计数相减得到本窗口的占用，新任务从0开始计
+        uint32_t prev_run = 0;
+        for (uint8_t j = 0; j < telemetry_prev_count; j++) {
+            if (telemetry_prev_run[j].handle == status.xHandle) {
+                prev_run = telemetry_prev_run[j].run_time;
+                break;
+            }
+        }
+        uint32_t run_delta = status.ulRunTimeCounter - prev_run;
+        task.cpu_permille = total_delta ? (uint16_t)((uint64_t)run_delta * 1000 / total_delta) : 0;
+
+        telemetry_fill_loop(task, status.xHandle, loops);
+    }
+
+    telemetry_prev_count = n;
+    for (UBaseType_t i = 0; i < n; i++) {
+        telemetry_prev_run[i].handle = telemetry_status[i].xHandle;
+        telemetry_prev_run[i].run_time = telemetry_status[i].ulRunTimeCounter;
+    }
+    telemetry_prev_total = total_run_time;
+#else
+    // 只能查询已登记循环周期的任务
+    for (int i = 0; i < TELEMETRY_TASK_COUNT && sample.task_count < TELEMETRY_MAX_TASKS; i++) {
+        TaskHandle_t handle = loops[i].handle;
+        if (handle == NULL) continue;
+
+        telemetry_task_sample_t& task = sample.tasks[sample.task_count++];
+        telemetry_copy_name(task.name, pcTaskGetName(handle));
+        task.priority = uxTaskPriorityGet(handle);
+        UBaseType_t stack_free = uxTaskGetStackHighWaterMark(handle);
+        task.stack_free = stack_free > 0xFFFF ? 0xFFFF : stack_free;
+        task.cpu_permille = TELEMETRY_CPU_UNKNOWN;
+        telemetry_fill_loop(task, handle, loops);
+    }
+#endif
+
+    // 登记任务的栈余量过低时报警一次
+    for (uint8_t i = 0; i < sample.task_count; i++) {
+        const telemetry_task_sample_t& task = sample.tasks[i];
+        if (task.loop_task && task.stack_free < TELEMETRY_STACK_WARN_BYTES &&
+            !(telemetry_stack_warned & (1UL << task.loop_task))) {
+            telemetry_stack_warned |= 1UL << task.loop_task;
+            Serial.printf("⚠️ 任务栈余量过低: %s 仅剩 %u bytes\n", task.name, task.stack_free);
+        }
+    }
+
+    telemetry_head = (telemetry_head + 1) % TELEMETRY_RING_SIZE;
+    if (telemetry_count < TELEMETRY_RING_SIZE) telemetry_count++;
+    telemetry_last_sample_ms = now_ms;
+}
+
+void telemetry_update(void) {
+    uint32_t now = millis();
+    if (now - telemetry_last_sample_ms >= TELEMETRY_SAMPLE_MS) {
+        telemetry_take_sample(now);
+    }
+}
+
+// 从旧到新第index次采样
+static const telemetry_sample_t* telemetry_get_sample(uint8_t index) {
+    if (index >= telemetry_count) return NULL;
+    uint8_t oldest = (telemetry_head + TELEMETRY_RING_SIZE - telemetry_count) % TELEMETRY_RING_SIZE;
+    return &telemetry_ring[(oldest + index) % TELEMETRY_RING_SIZE];
+}
+
+static void telemetry_format_cpu(char* buf, size_t len, uint16_t permille) {
+    if (permille == TELEMETRY_CPU_UNKNOWN) {
+        snprintf(buf, len, "  --");
+    } else {
+        snprintf(buf, len, "%3u.%u", permille / 10, permille % 10);
+    }
+}
+
+void telemetry_print_latest(void) {
+    const telemetry_sample_t* sample = telemetry_get_sample(telemetry_count - 1);
+    if (!sample) {
+        Serial.println("📈 任务遥测: 暂无采样");
+        return;
+    }
+
+    Serial.printf("📈 任务遥测 (t=%lu s, 窗口 %lu ms, 空闲堆 %lu bytes, 最低 %lu bytes):\n",
+                 sample->time_ms / 1000, sample->window_ms, sample->free_heap, sample->min_free_heap);
+    Serial.println("   任务             优先级  CPU%   栈剩余  循环平均/最大(ms)  次数");
+    for (uint8_t i = 0; i < sample->task_count; i++) {
+        const telemetry_task_sample_t& task = sample->tasks[i];
+        char cpu[8];
+        telemetry_format_cpu(cpu, sizeof(cpu), task.cpu_permille);
+        if (task.loop_task) {
+            Serial.printf("   %-16s %3u  %s%%  %6u  %7.1f/%7.1f  %5lu\n",
+                         task.name, task.priority, cpu, task.stack_free,
+                         task.loop_avg_us / 1000.0f, task.loop_max_us / 1000.0f, task.loop_count);
+        } else {
+            Serial.printf("   %-16s %3u  %s%%  %6u\n", task.name, task.priority, cpu, task.stack_free);
+        }
+    }
+}
+
+void telemetry_print_history(void) {
+    const telemetry_sample_t* latest = telemetry_get_sample(telemetry_count - 1);
+    if (!latest) {
+        Serial.println("📈 任务遥测: 暂无采样");
+        return;
+    }
+
+    // 每个任务一行：各次采样的CPU占用（从旧到新）和所有采样中的最小栈剩余
+    Serial.printf("📈 任务遥测历史 (%d 次采样, 每次 %d 秒, CPU%% 从旧到新):\n",
+                 telemetry_count, TELEMETRY_SAMPLE_MS / 1000);
+    for (uint8_t i = 0; i < latest->task_count; i++) {
+        const char* name = latest->tasks[i].name;
+        uint16_t min_stack = 0xFFFF;
+        char line[160];
+        int pos = snprintf(line, sizeof(line), "   %-16s", name);
+
+        for (uint8_t s = 0; s < telemetry_count && pos < (int)sizeof(line); s++) {
+            const telemetry_sample_t* sample = telemetry_get_sample(s);
+            const telemetry_task_sample_t* task = NULL;
+            for (uint8_t j = 0; j < sample->task_count; j++) {
+                if (strcmp(sample->tasks[j].name, name) == 0) {
+                    task = &sample->tasks[j];
+                    break;
+                }
+            }
+            char cpu[8];
+            telemetry_format_cpu(cpu, sizeof(cpu), task ? task->cpu_permille : TELEMETRY_CPU_UNKNOWN);
+            pos += snprintf(line + pos, sizeof(line) - pos, " %s", cpu);
+            if (task && task->stack_free < min_stack) min_stack = task->stack_free;
+        }
+        Serial.printf("%s  栈最小剩余 %u\n", line, min_stack);
+    }
+}
+
+bool telemetry_handle_command(const char* command) {
+    if (strcmp(command, "tasks") == 0) {
+        telemetry_print_latest();
+        return true;
+    }
+    if (strcmp(command, "tasks history") == 0) {
+        telemetry_print_history();
+        return true;
+    }
+    if (strcmp(command, "tasks now") == 0) {
+        // 立即采样（窗口为距上次采样的时间）
+        telemetry_take_sample(millis());
+        telemetry_print_latest();
+        return true;
+    }
+    return false;
+}
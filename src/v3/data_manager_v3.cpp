@@ -1,13 +1,60 @@
 #include "v3/data_manager_v3.h"
+#include "v3/ntp_time_v3.h"
 #include <time.h>
+#include <algorithm>
 
 // 全局数据管理器实例
 DataManagerV3 dataManagerV3;
 
+// DailyTotalV3与索引定长汇总之间的转换
+static day_totals_v3_t toIndexTotals(const DailyTotalV3& total) {
+    day_totals_v3_t out;
+    out.jumps = total.total_jumps;
+    out.duration = total.total_duration;
+    out.calories_x10 = (uint32_t)(total.total_calories * 10.0f + 0.5f);
+    out.sessions = total.session_count;
+    out.targets = total.targets_achieved;
+    out.best_score = total.best_score;
+    return out;
+}
+
+static DailyTotalV3 fromIndexTotals(const day_totals_v3_t& totals) {
+    DailyTotalV3 out;
+    out.total_jumps = totals.jumps;
+    out.total_duration = totals.duration;
+    out.total_calories = totals.calories_x10 / 10.0f;
+    out.session_count = totals.sessions > 255 ? 255 : totals.sessions;
+    out.targets_achieved = totals.targets > 255 ? 255 : totals.targets;
+    out.best_score = totals.best_score;
+    return out;
+}
+
 DataManagerV3::DataManagerV3() : 
     fs(nullptr), 
     initialized(false),
-    current_date("") {
+    current_day(-1),
+    last_save_us(0),
+    data_mutex(nullptr),
+    tier_mutex(nullptr),
+    flush_task_handle(nullptr),
+    flush_task_stop(false),
+    flush_task_exited(nullptr),
+    dirty_mask(0),
+    dirty_since(0),
+    dirty_updates(0),
+    flush_count(0),
+    cache_tick(0),
+    cache_hits(0),
+    cache_misses(0),
+    background_allowed(false),
+    last_compaction_day(-1),
+    last_compaction_ms(0),
+    last_retention_check_ms(0),
+    prefetch_state(V3_PREFETCH_IDLE),
+    prefetch_days(0),
+    prefetch_count(0),
+    prefetch_day(-1),
+    prefetch_version(0) {
 }
 
 DataManagerV3::~DataManagerV3() {
@@ -28,9 +75,16 @@ bool DataManagerV3::init(FileSystemV3* filesystem) {
     }
 
     fs = filesystem;
+    
+    if (!data_mutex) {
+        data_mutex = xSemaphoreCreateRecursiveMutex();
+    }
+    if (!tier_mutex) {
+        tier_mutex = xSemaphoreCreateRecursiveMutex();
+    }
 
-    // 初始化NTP时间同步
-    initNTPTime();
+    // 恢复保存的时间并在后台启动NTP同步（不阻塞启动）
+    ntpTimeV3.init(filesystem);
     
     // 加载系统配置
     if (!loadSystemConfig()) {
@@ -49,48 +103,79 @@ bool DataManagerV3::init(FileSystemV3* filesystem) {
         resetTargetSettings();
     }
     
-    // 加载历史统计
+    // 加载日期索引，缺失或损坏时从每日数据重建
+    if (!history_index.begin(fs->getBackend())) {
+        Serial.println("⚠️ 日期索引不可用，从每日数据重建");
+        rebuildHistoryIndex();
+    }
+    
+    // 加载周/月汇总，损坏时丢弃（日期索引和明细不受影响）
+    if (!rollup_store.begin(fs->getBackend())) {
+        Serial.println("⚠️ 分层汇总文件损坏，已忽略");
+    }
+    
+    // 加载历史统计，缺失或损坏时从每日数据重建
     if (!loadHistoryStats()) {
-        Serial.println("⚠️ 初始化历史统计数据");
-        resetHistoryStats();
+        Serial.println("⚠️ 历史统计不可用，从每日数据重建");
+        rebuildHistoryStats();
     }
     
     // 更新当前日期并加载当日数据
     updateCurrentDate();
     if (!loadCurrentDayData()) {
         Serial.println("📅 创建新的每日数据");
-        current_day_data = DailyDataV3(current_date);
+        current_day_data = DailyDataV3(current_day);
         saveCurrentDayData();
     }
     
+    // 一次性填充滚动汇总和趋势序列，之后只做增量更新
+    loadRollingTotals();
+    loadTrendSeries();
+    
     initialized = true;
+    
+    // 启动后台写回任务
+    startFlushTask();
+    
     Serial.println("✅ V3.0数据管理器初始化成功");
     
     printDataSummary();
     return true;
 }
 
-void DataManagerV3::deinit() {
+bool DataManagerV3::deinit() {
     if (initialized) {
-        // 保存当前数据
-        saveCurrentDayData();
-        saveSystemConfig(system_config);
-        saveHistoryStats();
-        saveTargetSettings(target_settings);
+        // 停止写回任务，只写出仍然是脏的记录；任务仍在写文件时不能并发写出或释放文件系统
+        if (!stopFlushTask()) {
+            Serial.println("⚠️ 写回任务仍在运行，数据管理器暂不关闭");
+            return false;
+        }
+        flushPendingWrites(true);
+        ntpTimeV3.deinit();
+        fs->flushTrace();
         
         initialized = false;
         fs = nullptr;
         Serial.println("数据管理器已关闭");
     }
+    return true;
 }
 
 bool DataManagerV3::saveSystemConfig(const SystemConfigV3& config) {
     if (!fs || !fs->isAvailable()) return false;
     
+    lock();
     system_config = config;
-    String json_data = config.toJsonString();
+    markDirty(V3_DIRTY_CONFIG);
+    unlock();
+    return true;
+}
+
+bool DataManagerV3::writeSystemConfig(const SystemConfigV3& config) {
+    JsonDocument doc;
+    config.toJson(doc);
     
-    bool success = fs->writeFile(V3_CONFIG_FILE, json_data);
+    bool success = fs->writeRecord(V3_CONFIG_FILE, doc);
     if (success) {
         Serial.println("✅ 系统配置保存成功");
     } else {
@@ -108,13 +193,13 @@ bool DataManagerV3::loadSystemConfig() {
         return false;
     }
     
-    String json_data = fs->readFile(V3_CONFIG_FILE);
-    if (json_data.isEmpty()) {
-        Serial.println("❌ 系统配置文件为空");
+    JsonDocument doc;
+    if (!fs->readRecord(V3_CONFIG_FILE, doc)) {
+        Serial.println("❌ 系统配置文件读取失败");
         return false;
     }
     
-    bool success = system_config.fromJsonString(json_data);
+    bool success = system_config.fromJson(doc);
     if (success) {
         Serial.println("✅ 系统配置加载成功");
     } else {
@@ -133,26 +218,26 @@ void DataManagerV3::resetSystemConfig() {
 bool DataManagerV3::saveGameSession(const GameSessionV3& session) {
     if (!initialized) return false;
 
+    uint32_t start_us = micros();
+    lock();
+
     // 检查并更新当前日期
     updateCurrentDate();
 
-    // 添加到当日数据
+    // 只更新内存记录，落盘由写回任务完成
     current_day_data.addSession(session);
-
-    // 保存当日数据
-    bool success = saveCurrentDayData();
+    history_stats.addSession(session, current_day_data);
+    rolling_totals.setDay(0, current_day_data.daily_total);
+    trend_series.addToday(session.jump_count);
+    markDirty(V3_DIRTY_DAILY | V3_DIRTY_STATS);
     
-    if (success) {
-        // 更新历史统计
-        updateHistoryStats();
-        
-        Serial.printf("✅ 游戏会话保存成功: %d次跳跃, %.1f卡路里, %d分\n",
-                     session.jump_count, session.calories, session.score);
-    } else {
-        Serial.println("❌ 游戏会话保存失败");
-    }
+    unlock();
+    last_save_us = micros() - start_us;
+    fs->trace(V3_TRACE_SESSION_SAVED, session.jump_count, session.score);
     
-    return success;
+    Serial.printf("✅ 游戏会话保存成功: %d次跳跃, %.1f卡路里, %d分 (耗时 %lu μs)\n",
+                 session.jump_count, session.getCalories(), session.score, last_save_us);
+    return true;
 }
 
 GameSessionV3 DataManagerV3::createGameSession(game_difficulty_t difficulty, 
@@ -160,67 +245,398 @@ GameSessionV3 DataManagerV3::createGameSession(game_difficulty_t difficulty,
                                               uint32_t duration) {
     GameSessionV3 session;
     
-    session.start_time = DataUtilsV3::getCurrentTimeString();
-    session.duration = duration;
+    float avg_frequency = DataUtilsV3::calculateAvgFrequency(jump_count, duration);
+    session.start_epoch = DataUtilsV3::getCurrentEpochSeconds();
+    session.duration = duration > 65535 ? 65535 : duration;
     session.difficulty = difficulty;
-    session.jump_count = jump_count;
-    session.calories = DataUtilsV3::jumpsToCalories(jump_count, difficulty);
-    session.avg_frequency = DataUtilsV3::calculateAvgFrequency(jump_count, duration);
-    session.max_height = DataUtilsV3::calculateMaxHeight(session.avg_frequency);
+    session.jump_count = jump_count > 65535 ? 65535 : jump_count;
+    session.setCalories(DataUtilsV3::jumpsToCalories(jump_count, difficulty));
+    session.setAvgFrequency(avg_frequency);
+    session.setMaxHeight(DataUtilsV3::calculateMaxHeight(avg_frequency));
     session.score = DataUtilsV3::calculateGameScore(jump_count, duration, difficulty);
-    session.target_achieved = isSessionTargetAchieved(session);
+    session.setTargetAchieved(isSessionTargetAchieved(session));
     
     return session;
 }
 
-bool DataManagerV3::loadDailyData(const String& date, DailyDataV3& data) {
-    if (!fs || !fs->isAvailable()) return false;
+bool DataManagerV3::loadDailyData(int32_t epoch_day, DailyDataV3& data) {
+    if (!fs || !fs->isAvailable() || epoch_day < 0) return false;
+    
+    if (cacheLookup(epoch_day, data)) return true;
     
-    String file_path = fs->getDailyDataPath(date);
+    char file_path[V3_DAILY_PATH_SIZE];
+    FileSystemV3::formatDailyDataPath(epoch_day, file_path, sizeof(file_path));
     
     if (!fs->fileExists(file_path)) {
-        Serial.printf("⚠️ 日期 %s 的数据文件不存在\n", date.c_str());
+        Serial.printf("⚠️ 数据文件不存在: %s\n", file_path);
         return false;
     }
     
-    String json_data = fs->readFile(file_path);
-    if (json_data.isEmpty()) {
-        Serial.printf("❌ 日期 %s 的数据文件为空\n", date.c_str());
+    JsonDocument doc;
+    if (!fs->readRecord(file_path, doc)) {
+        Serial.printf("❌ 数据文件读取失败: %s\n", file_path);
         return false;
     }
     
-    bool success = data.fromJsonString(json_data);
+    bool success = data.fromJson(doc);
     if (success) {
-        Serial.printf("✅ 日期 %s 的数据加载成功\n", date.c_str());
+        cacheStore(data);
+        Serial.printf("✅ 数据加载成功: %s\n", file_path);
     } else {
-        Serial.printf("❌ 日期 %s 的数据解析失败\n", date.c_str());
+        Serial.printf("❌ 数据解析失败: %s\n", file_path);
     }
     
     return success;
 }
 
+bool DataManagerV3::loadDailySummary(int32_t epoch_day, DailyTotalV3& total) {
+    if (!fs || !fs->isAvailable() || epoch_day < 0) return false;
+    
+    DailyDataV3 cached;
+    if (cacheLookup(epoch_day, cached)) {
+        total = cached.daily_total;
+        return true;
+    }
+    
+    char file_path[V3_DAILY_PATH_SIZE];
+    FileSystemV3::formatDailyDataPath(epoch_day, file_path, sizeof(file_path));
+    if (!fs->fileExists(file_path)) return false;
+    
+    // 过滤掉sessions数组，不为每个会话分配对象和字符串
+    JsonDocument filter;
+    DailyDataV3::summaryFilter(filter);
+    
+    JsonDocument doc;
+    if (!fs->readRecord(file_path, doc, &filter)) {
+        Serial.printf("❌ 汇总读取失败: %s\n", file_path);
+        return false;
+    }
+    
+    DailyDataV3 summary;
+    if (!summary.fromJsonSummary(doc)) return false;
+    total = summary.daily_total;
+    return true;
+}
+
 bool DataManagerV3::saveDailyData(const DailyDataV3& data) {
     if (!fs || !fs->isAvailable()) return false;
     
-    String file_path = fs->getDailyDataPath(data.date);
-    String json_data = data.toJsonString();
+    if (data.epoch_day < 0) return false;
+    
+    char file_path[V3_DAILY_PATH_SIZE];
+    FileSystemV3::formatDailyDataPath(data.epoch_day, file_path, sizeof(file_path));
+    JsonDocument doc;
+    data.toJson(doc);
+    
+    cacheInvalidate(data.epoch_day);
     
-    bool success = fs->writeFile(file_path, json_data);
+    bool success = fs->writeRecord(file_path, doc);
     if (success) {
-        Serial.printf("✅ 日期 %s 的数据保存成功\n", data.date.c_str());
+        // 同步更新日期索引（已压缩为周/月汇总的日期不再进入日期层）
+        if (data.epoch_day >= 0 && (uint32_t)data.epoch_day >= rollup_store.dayTierStart()) {
+            lockTier();
+            history_index.setDay(data.epoch_day, toIndexTotals(data.daily_total));
+            unlockTier();
+        }
+        Serial.printf("✅ 数据保存成功: %s\n", file_path);
     } else {
-        Serial.printf("❌ 日期 %s 的数据保存失败\n", data.date.c_str());
+        Serial.printf("❌ 数据保存失败: %s\n", file_path);
     }
     
     return success;
 }
 
 bool DataManagerV3::loadCurrentDayData() {
-    return loadDailyData(current_date, current_day_data);
+    return loadDailyData(current_day, current_day_data);
 }
 
 bool DataManagerV3::saveCurrentDayData() {
-    return saveDailyData(current_day_data);
+    if (!fs || !fs->isAvailable()) return false;
+    
+    markDirty(V3_DIRTY_DAILY);
+    return true;
+}
+
+bool DataManagerV3::cacheLookup(int32_t epoch_day, DailyDataV3& data) {
+    lock();
+    for (DailyCacheEntryV3& entry : daily_cache) {
+        if (entry.last_used != 0 && entry.data.epoch_day == epoch_day) {
+            entry.last_used = ++cache_tick;
+            data = entry.data;
+            cache_hits++;
+            unlock();
+            return true;
+        }
+    }
+    cache_misses++;
+    unlock();
+    return false;
+}
+
+void DataManagerV3::cacheStore(const DailyDataV3& data) {
+    lock();
+    // 优先复用同日期槽位，否则替换空槽或最久未使用的条目
+    DailyCacheEntryV3* victim = &daily_cache[0];
+    for (DailyCacheEntryV3& entry : daily_cache) {
+        if (entry.last_used != 0 && entry.data.epoch_day == data.epoch_day) {
+            victim = &entry;
+            break;
+        }
+        if (entry.last_used < victim->last_used) {
+            victim = &entry;
+        }
+    }
+    victim->data = data;
+    victim->last_used = ++cache_tick;
+    unlock();
+}
+
+void DataManagerV3::cacheInvalidate(int32_t epoch_day) {
+    lock();
+    for (DailyCacheEntryV3& entry : daily_cache) {
+        if (entry.last_used != 0 && entry.data.epoch_day == epoch_day) {
+            entry.last_used = 0;
+        }
+    }
+    unlock();
+}
+
+void DataManagerV3::clearDailyCache() {
+    lock();
+    for (DailyCacheEntryV3& entry : daily_cache) {
+        entry.last_used = 0;
+    }
+    cache_hits = 0;
+    cache_misses = 0;
+    unlock();
+}
+
+void DataManagerV3::lock() const {
+    if (data_mutex) xSemaphoreTakeRecursive(data_mutex, portMAX_DELAY);
+}
+
+void DataManagerV3::unlock() const {
+    if (data_mutex) xSemaphoreGiveRecursive(data_mutex);
+}
+
+void DataManagerV3::lockTier() const {
+    if (tier_mutex) xSemaphoreTakeRecursive(tier_mutex, portMAX_DELAY);
+}
+
+void DataManagerV3::unlockTier() const {
+    if (tier_mutex) xSemaphoreGiveRecursive(tier_mutex);
+}
+
+uint16_t DataManagerV3::loadIndexedDays(int32_t last_day, uint16_t count, DailyTotalV3* out, uint8_t* found) {
+    for (uint16_t i = 0; i < count; i++) {
+        out[i] = DailyTotalV3();
+        found[i] = 0;
+    }
+    if (last_day < 0 || count == 0) return 0;
+    
+    uint16_t loaded = 0;
+    lockTier();
+    if (history_index.isLoaded() && !history_index.isEmpty()) {
+        int32_t first = last_day - count + 1;
+        if (first < (int32_t)history_index.firstDay()) first = history_index.firstDay();
+        if (first <= last_day) {
+            std::vector<day_totals_v3_t> days(last_day - first + 1);
+            uint32_t read = history_index.getDays(first, days.size(), days.data());
+            for (uint32_t j = 0; j < read; j++) {
+                int32_t i = last_day - (first + (int32_t)j);
+                out[i] = fromIndexTotals(days[j]);
+                found[i] = 1;
+                loaded++;
+            }
+        }
+    }
+    unlockTier();
+    return loaded;
+}
+
+void DataManagerV3::markDirty(uint8_t mask) {
+    lock();
+    if (dirty_mask == 0) {
+        dirty_since = millis();
+    }
+    dirty_mask |= mask;
+    dirty_updates++;
+    unlock();
+}
+
+bool DataManagerV3::flushPendingWrites(bool force) {
+    if (!fs || !fs->isAvailable()) return false;
+    
+    // 在锁内拍快照并清除脏标记，文件写入在锁外进行，不阻塞会话保存
+    lock();
+    if (dirty_mask == 0 || (!force && millis() - dirty_since < V3_WRITE_BEHIND_STALENESS_MS)) {
+        unlock();
+        return true;
+    }
+    
+    uint8_t mask = dirty_mask;
+    dirty_mask = 0;
+    
+    DailyDataV3 day_snapshot;
+    DailyDataV3 prev_snapshot;
+    HistoryStatsV3 stats_snapshot;
+    SystemConfigV3 config_snapshot;
+    TargetSettingsV3 targets_snapshot;
+    if (mask & V3_DIRTY_PREV_DAY) prev_snapshot = previous_day_data;
+    if (mask & V3_DIRTY_DAILY) day_snapshot = current_day_data;
+    if (mask & V3_DIRTY_STATS) stats_snapshot = history_stats;
+    if (mask & V3_DIRTY_CONFIG) config_snapshot = system_config;
+    if (mask & V3_DIRTY_TARGETS) targets_snapshot = target_settings;
+    uint32_t coalesced = dirty_updates;
+    dirty_updates = 0;
+    unlock();
+    
+    uint8_t failed = 0;
+    if ((mask & V3_DIRTY_PREV_DAY) && !saveDailyData(prev_snapshot)) failed |= V3_DIRTY_PREV_DAY;
+    if ((mask & V3_DIRTY_DAILY) && !saveDailyData(day_snapshot)) failed |= V3_DIRTY_DAILY;
+    if ((mask & V3_DIRTY_STATS) && !writeHistoryStats(stats_snapshot)) failed |= V3_DIRTY_STATS;
+    if ((mask & V3_DIRTY_CONFIG) && !writeSystemConfig(config_snapshot)) failed |= V3_DIRTY_CONFIG;
+    if ((mask & V3_DIRTY_TARGETS) && !writeTargetSettings(targets_snapshot)) failed |= V3_DIRTY_TARGETS;
+    
+    flush_count++;
+    Serial.printf("💾 写回完成: 合并 %lu 次修改, 标记 0x%02X%s\n",
+                 coalesced, mask, failed ? " (部分失败，稍后重试)" : "");
+    
+    // 写入失败的记录重新标脏，下个周期重试
+    if (failed) {
+        markDirty(failed);
+        return false;
+    }
+    return true;
+}
+
+void DataManagerV3::startFlushTask() {
+    if (flush_task_handle) return;
+    
+    if (!flush_task_exited) {
+        flush_task_exited = xSemaphoreCreateBinary();
+    }
+    flush_task_stop = false;
+    xTaskCreate(flushTaskEntry, "v3_flush_task", V3_FLUSH_TASK_STACK_SIZE, this,
+                V3_FLUSH_TASK_PRIORITY, &flush_task_handle);
+    if (flush_task_handle == NULL) {
+        Serial.println("⚠️ 写回任务创建失败，数据将在关闭时写出");
+    }
+}
+
+bool DataManagerV3::stopFlushTask() {
+    TaskHandle_t task = flush_task_handle;
+    if (!task) return true;
+    
+    // 通知任务退出并立即唤醒，等待进行中的刷新/压缩完成（任务退出前释放信号量并清空句柄）
+    flush_task_stop = true;
+    xTaskNotifyGive(task);
+    if (xSemaphoreTake(flush_task_exited, pdMS_TO_TICKS(V3_FLUSH_TASK_STOP_TIMEOUT_MS)) != pdTRUE) {
+        return false;
+    }
+    return true;
+}
+
+void DataManagerV3::flushTaskEntry(void* param) {
+    DataManagerV3* manager = (DataManagerV3*)param;
+    while (!manager->flush_task_stop) {
+        // 预取请求通过任务通知立即唤醒，否则按检查间隔轮询
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(V3_WRITE_BEHIND_CHECK_MS));
+        manager->runPrefetch();
+        manager->flushPendingWrites(false);
+        manager->runScheduledCompaction();
+        manager->runScheduledRetention();
+        if (manager->fs) manager->fs->flushTrace();
+    }
+    manager->flush_task_handle = nullptr;
+    xSemaphoreGive(manager->flush_task_exited);
+    vTaskDelete(NULL);
+}
+
+void DataManagerV3::runScheduledCompaction() {
+    // 只在空闲（非游戏中）且没有待写回数据时执行，每天一次
+    if (!initialized || !background_allowed || dirty_mask != 0) return;
+    if (millis() < V3_COMPACTION_BOOT_DELAY_MS) return;
+    
+    int32_t today = getTodayEpochDay();
+    if (today < 0 || today == last_compaction_day) return;
+    
+    if (runCompaction()) {
+        last_compaction_day = today;
+    }
+}
+
+void DataManagerV3::runScheduledRetention() {
+    // 使用率超过高水位时不等每日压缩，立即按保留策略清理
+    if (!initialized || !background_allowed || dirty_mask != 0) return;
+    if (millis() - last_retention_check_ms < V3_RETENTION_CHECK_MS) return;
+    last_retention_check_ms = millis();
+    
+    if (fs->isAboveHighWater()) {
+        Serial.printf("⚠️ 存储使用率 %.1f%% 超过高水位，执行保留策略\n", fs->getUsagePercent());
+        fs->cleanupOldFiles(V3_DETAIL_DAYS, V3_RETENTION_BYTE_BUDGET, retentionGuard, this);
+    }
+}
+
+bool DataManagerV3::runCompaction() {
+    if (!fs || !fs->isAvailable()) return false;
+    
+    int32_t today = getTodayEpochDay();
+    if (today < 0) return false;
+    
+    uint32_t start_ms = millis();
+    retention_result_t retention = fs->cleanupOldFiles(V3_DETAIL_DAYS, V3_RETENTION_BYTE_BUDGET,
+                                                       retentionGuard, this);
+    uint16_t pruned = retention.files_deleted;
+    
+    // 只持有索引/汇总锁：压缩期间会话保存、滚动汇总和趋势查询不受影响
+    lockTier();
+    int steps = rollup_store.compact(history_index, today, V3_COMPACTION_MAX_STEPS);
+    unlockTier();
+    
+    last_compaction_ms = millis() - start_ms;
+    if (pruned > 0 || steps > 0) {
+        fs->trace(V3_TRACE_COMPACTION, steps, last_compaction_ms);
+        Serial.printf("🗜️ 分层压缩: 删除明细 %d 个, 汇总 %d 步, 索引 %d 天, 周 %d 条, 月 %d 条, 耗时 %lu ms\n",
+                     pruned, steps, history_index.dayCount(), rollup_store.weekCount(),
+                     rollup_store.monthCount(), last_compaction_ms);
+    }
+    
+    // 步数用满说明还有积压，留到下次空闲继续
+    return steps < V3_COMPACTION_MAX_STEPS;
+}
+
+bool DataManagerV3::retentionGuard(int32_t epoch_day, void* ctx) {
+    return ((DataManagerV3*)ctx)->ensureDayCovered(epoch_day);
+}
+
+bool DataManagerV3::ensureDayCovered(int32_t epoch_day) {
+    // 删除明细前确认当天汇总已进入日期索引或周/月汇总
+    lockTier();
+    bool covered = (uint32_t)epoch_day < rollup_store.dayTierStart() ||
+                   (!history_index.isEmpty() &&
+                    (uint32_t)epoch_day >= history_index.firstDay() &&
+                    (uint32_t)epoch_day <= history_index.lastDay());
+    unlockTier();
+    if (!covered) {
+        DailyTotalV3 total;
+        if (!loadDailySummary(epoch_day, total)) return false;
+        lockTier();
+        covered = history_index.setDay(epoch_day, toIndexTotals(total));
+        unlockTier();
+        if (!covered) return false;
+    }
+    
+    cacheInvalidate(epoch_day);
+    return true;
+}
+
+void DataManagerV3::cleanupOldData(uint8_t keep_days) {
+    if (!fs || !fs->isAvailable()) return;
+    
+    Serial.printf("🧹 清理 %d 天前的明细（预算 %d KB）...\n", keep_days, V3_RETENTION_BYTE_BUDGET / 1024);
+    retention_result_t result = fs->cleanupOldFiles(keep_days, V3_RETENTION_BYTE_BUDGET, retentionGuard, this);
+    Serial.printf("✅ 清理完成，删除了 %d 个明细文件\n", result.files_deleted);
 }
 
 std::vector<DailyDataV3> DataManagerV3::getHistoryData(uint8_t days) {
@@ -228,20 +644,36 @@ std::vector<DailyDataV3> DataManagerV3::getHistoryData(uint8_t days) {
 
     if (!fs || !fs->isAvailable()) return history;
 
+    int32_t today = getTodayEpochDay();
+    if (today < 0) return history;
+    
+    // 先从日期索引一次读出全部日期的汇总，用于跳过没有记录的日期
+    bool use_index = history_index.isLoaded();
+    std::vector<DailyTotalV3> indexed(days);
+    std::vector<uint8_t> found(days);
+    if (use_index) {
+        loadIndexedDays(today, days, indexed.data(), found.data());
+    }
+    
     for (int i = 0; i < days; i++) {
-        // 生成日期字符串（从今天往前推）
-        String date = DataUtilsV3::getDateString(-i); // 使用新的日期计算函数
-
-        DailyDataV3 daily_data;
-        if (loadDailyData(date, daily_data)) {
+        // 从今天往前推
+        int32_t epoch_day = today - i;
+
+        DailyDataV3 daily_data(epoch_day);
+        if (i == 0 && current_day_data.epoch_day == epoch_day) {
+            // 今天直接使用内存数据
+            history.push_back(current_day_data);
+        } else if (use_index && epoch_day != today &&
+                   (!found[i] || indexed[i].session_count == 0)) {
+            // 索引中没有记录的日期不再访问文件系统
+            history.push_back(daily_data);
+        } else if (loadDailyData(epoch_day, daily_data)) {
             history.push_back(daily_data);
             Serial.printf("📊 加载历史数据: %s (%d次游戏)\n",
-                         date.c_str(), daily_data.daily_total.session_count);
+                         daily_data.dateString().c_str(), daily_data.daily_total.session_count);
         } else {
             // 如果没有数据，创建空的日期记录
-            daily_data.date = date;
-            history.push_back(daily_data);
-            Serial.printf("📊 创建空历史记录: %s\n", date.c_str());
+            history.push_back(DailyDataV3(epoch_day));
         }
     }
 
@@ -249,23 +681,358 @@ std::vector<DailyDataV3> DataManagerV3::getHistoryData(uint8_t days) {
     return history;
 }
 
-bool DataManagerV3::updateHistoryStats() {
-    // 重新计算历史统计
-    history_stats.reset();
+std::vector<DailySummaryV3> DataManagerV3::getHistorySummaries(uint8_t days) {
+    std::vector<DailySummaryV3> history;
+    if (!fs || !fs->isAvailable()) return history;
+    
+    int32_t today = getTodayEpochDay();
+    if (today < 0) return history;
     
-    std::vector<DailyDataV3> history = getHistoryData(30); // 最近30天
-    for (const auto& daily_data : history) {
-        history_stats.updateWithDailyData(daily_data);
+    // 滚动汇总覆盖不到的日期从日期索引一次读出
+    bool use_rolling = rolling_totals.today == current_day;
+    std::vector<DailyTotalV3> indexed(days);
+    std::vector<uint8_t> found(days);
+    if (!use_rolling || days > V3_ROLLING_DAYS) {
+        loadIndexedDays(today, days, indexed.data(), found.data());
     }
     
+    history.reserve(days);
+    for (int i = 0; i < days; i++) {
+        DailySummaryV3 summary(today - i, DailyTotalV3());
+        // 依次尝试：内存中的滚动汇总、日期索引、每日缓存或只解析汇总的文件读取
+        if (i < V3_ROLLING_DAYS && use_rolling) {
+            lock();
+            summary.total = rolling_totals.getDay(i);
+            unlock();
+        } else if (i == 0) {
+            getDayTotals(today, summary.total);     // 今天以内存数据为准
+        } else if (found[i]) {
+            summary.total = indexed[i];
+        } else {
+            loadDailySummary(summary.epoch_day, summary.total);
+        }
+        history.push_back(summary);
+    }
+    return history;
+}
+
+void DataManagerV3::prefetchHistorySummaries(uint8_t days) {
+    if (!initialized) return;
+    if (days > V3_HISTORY_DAYS) days = V3_HISTORY_DAYS;
+    
+    lock();
+    bool fresh = prefetch_state == V3_PREFETCH_READY && prefetch_days == days &&
+                 prefetch_day == current_day && prefetch_version == dirty_updates;
+    if (!fresh && prefetch_state != V3_PREFETCH_REQUESTED) {
+        prefetch_days = days;
+        prefetch_state = V3_PREFETCH_REQUESTED;
+    }
+    unlock();
+    
+    if (prefetch_state == V3_PREFETCH_REQUESTED && flush_task_handle) {
+        xTaskNotifyGive(flush_task_handle);
+    }
+}
+
+bool DataManagerV3::takeHistorySummaries(std::vector<DailySummaryV3>& out, uint32_t* version) {
+    if (prefetch_state != V3_PREFETCH_READY) return false;
+    
+    lock();
+    bool valid = prefetch_state == V3_PREFETCH_READY &&
+                 prefetch_day == current_day && prefetch_version == dirty_updates;
+    // 调用方已持有同一版本时不再复制
+    if (valid && version && *version == prefetch_version) {
+        valid = false;
+    }
+    if (valid) {
+        out.assign(prefetch_buffer, prefetch_buffer + prefetch_count);
+        if (version) *version = prefetch_version;
+    }
+    unlock();
+    return valid;
+}
+
+void DataManagerV3::runPrefetch() {
+    if (prefetch_state != V3_PREFETCH_REQUESTED) return;
+    
+    uint32_t start_ms = millis();
+    lock();
+    uint8_t days = prefetch_days;
+    int32_t day = current_day;
+    uint32_t version = dirty_updates;
+    unlock();
+    
+    // 文件读取在锁外进行，只在写入暂存区时加锁
+    std::vector<DailySummaryV3> summaries = getHistorySummaries(days);
+    
+    lock();
+    prefetch_count = 0;
+    for (const DailySummaryV3& summary : summaries) {
+        if (prefetch_count >= V3_HISTORY_DAYS) break;
+        prefetch_buffer[prefetch_count++] = summary;
+    }
+    prefetch_day = day;
+    prefetch_version = version;     // 加载期间数据有修改时，取数据时按版本号判为过期并重新请求
+    prefetch_state = V3_PREFETCH_READY;
+    unlock();
+    
+    Serial.printf("📊 历史汇总预取完成: %d 天, 耗时 %lu ms\n", prefetch_count, millis() - start_ms);
+}
+
+bool DataManagerV3::loadRollingTotals() {
+    rolling_totals.reset(current_day);
+    rolling_totals.setDay(0, current_day_data.daily_total);
+    
+    if (!fs || !fs->isAvailable()) return false;
+    
+    uint8_t loaded = 0;
+    int32_t today = getTodayEpochDay();
+    
+    // 优先从日期索引一次读出，不打开每日数据文件
+    if (history_index.isLoaded() && today >= 0) {
+        std::vector<DailyTotalV3> indexed(V3_ROLLING_DAYS - 1);
+        std::vector<uint8_t> found(V3_ROLLING_DAYS - 1);
+        loadIndexedDays(today - 1, V3_ROLLING_DAYS - 1, indexed.data(), found.data());
+        for (uint8_t i = 1; i < V3_ROLLING_DAYS; i++) {
+            if (found[i - 1] && indexed[i - 1].session_count > 0) {
+                rolling_totals.setDay(i, indexed[i - 1]);
+                loaded++;
+            }
+        }
+        Serial.printf("📊 滚动汇总已加载: %d/%d 天有数据\n", loaded + (current_day_data.isEmpty() ? 0 : 1), V3_ROLLING_DAYS);
+        return true;
+    }
+    
+    for (uint8_t i = 1; i < V3_ROLLING_DAYS; i++) {
+        DailyTotalV3 total;
+        if (today >= 0 && loadDailySummary(today - i, total)) {
+            rolling_totals.setDay(i, total);
+            loaded++;
+        }
+    }
+    
+    Serial.printf("📊 滚动汇总已加载: %d/%d 天有数据\n", loaded + (current_day_data.isEmpty() ? 0 : 1), V3_ROLLING_DAYS);
+    return true;
+}
+
+bool DataManagerV3::loadTrendSeries() {
+    trend_series.reset(current_day);
+    
+    // 最近V3_ROLLING_DAYS天直接取滚动汇总（包含尚未写入索引的今天）
+    uint16_t from_rolling = 0;
+    if (rolling_totals.today == current_day) {
+        from_rolling = V3_ROLLING_DAYS < V3_TREND_DAYS ? V3_ROLLING_DAYS : V3_TREND_DAYS;
+        for (uint16_t i = 0; i < from_rolling; i++) {
+            trend_series.setDay(i, rolling_totals.getDay(i).total_jumps);
+        }
+    } else {
+        trend_series.setDay(0, current_day_data.daily_total.total_jumps);
+        from_rolling = 1;
+    }
+    
+    // 更早的日期从日期索引顺序读取（一次打开文件），早于索引起点的日期保持为0
+    uint32_t loaded = 0;
+    lockTier();
+    if (current_day >= 0 && from_rolling < V3_TREND_DAYS && history_index.isLoaded() && !history_index.isEmpty()) {
+        int32_t first = current_day - (V3_TREND_DAYS - 1);
+        int32_t last = current_day - from_rolling;
+        if (first < (int32_t)history_index.firstDay()) first = history_index.firstDay();
+        if (last >= first) {
+            std::vector<day_totals_v3_t> days(last - first + 1);
+            loaded = history_index.getDays(first, days.size(), days.data());
+            for (uint32_t i = 0; i < loaded; i++) {
+                trend_series.setDay(current_day - (first + (int32_t)i), days[i].jumps);
+            }
+        }
+    }
+    unlockTier();
+    
+    trend_series.rescaleAll();
+    Serial.printf("📈 趋势序列已加载: %d 天（索引 %lu 天）\n", V3_TREND_DAYS, loaded);
+    return true;
+}
+
+bool DataManagerV3::rebuildHistoryIndex() {
+    if (!fs || !fs->isAvailable()) return false;
+    
+    Serial.println("🔧 重建日期索引...");
+    uint32_t start_ms = millis();
+    
+    lockTier();
+    history_index.begin(fs->getBackend());
+    history_index.clear();
+    unlockTier();
+    
+    // 按日期升序写入，索引只做追加
+    std::vector<int32_t> days;
+    std::vector<String> files = fs->listFiles("/");
+    for (const String& file : files) {
+        int32_t epoch_day = FileSystemV3::parseDailyDataPath(file.c_str());
+        // 已压缩进周/月汇总的日期不重复索引
+        if (epoch_day >= 0 && (uint32_t)epoch_day >= rollup_store.dayTierStart()) {
+            days.push_back(epoch_day);
+        }
+    }
+    std::sort(days.begin(), days.end());
+    
+    uint16_t indexed = 0;
+    for (int32_t epoch_day : days) {
+        DailyTotalV3 total;
+        if (!loadDailySummary(epoch_day, total)) continue;
+        
+        lockTier();
+        if (history_index.setDay(epoch_day, toIndexTotals(total))) {
+            indexed++;
+        }
+        unlockTier();
+    }
+    
+    Serial.printf("✅ 日期索引重建完成: %d 天, %d bytes, 耗时 %lu ms\n",
+                 indexed, history_index.fileSize(), millis() - start_ms);
+    return true;
+}
+
+int32_t DataManagerV3::getTodayEpochDay() const {
+    return current_day;
+}
+
+bool DataManagerV3::getDayTotals(int32_t epoch_day, DailyTotalV3& totals) {
+    totals = DailyTotalV3();
+    if (epoch_day < 0) return false;
+    
+    // 今天以内存数据为准（写回前索引可能滞后）
+    if (epoch_day == getTodayEpochDay()) {
+        lock();
+        totals = current_day_data.daily_total;
+        unlock();
+        return true;
+    }
+    
+    day_totals_v3_t index_totals;
+    lockTier();
+    bool found = history_index.getDay(epoch_day, &index_totals);
+    unlockTier();
+    if (found) {
+        totals = fromIndexTotals(index_totals);
+    }
+    return found;
+}
+
+bool DataManagerV3::getRangeTotals(int32_t first_day, int32_t last_day, DailyTotalV3& totals) {
+    totals = DailyTotalV3();
+    if (first_day < 0 || last_day < first_day) return false;
+    
+    int32_t today = getTodayEpochDay();
+    int32_t index_last = (today >= 0 && last_day >= today) ? today - 1 : last_day;
+    
+    day_totals_v3_t index_totals;
+    memset(&index_totals, 0, sizeof(index_totals));
+    bool ok = true;
+    if (index_last >= first_day) {
+        lockTier();
+        ok = rollup_store.getRange(history_index, first_day, index_last, &index_totals);
+        unlockTier();
+    }
+    totals = fromIndexTotals(index_totals);
+    totals.best_score = 0;
+    
+    // 区间包含今天时叠加内存中的当日数据
+    if (today >= first_day && today <= last_day) {
+        const DailyTotalV3& day = current_day_data.daily_total;
+        totals.total_jumps += day.total_jumps;
+        totals.total_duration += day.total_duration;
+        totals.total_calories += day.total_calories;
+        totals.session_count += day.session_count;
+        totals.targets_achieved += day.targets_achieved;
+    }
+    return ok;
+}
+
+DailyTotalV3 DataManagerV3::getRecentTotals(uint16_t days) {
+    DailyTotalV3 totals;
+    int32_t today = getTodayEpochDay();
+    if (days > 0 && today >= 0) {
+        getRangeTotals(today - days + 1, today, totals);
+    }
+    return totals;
+}
+
+void DataManagerV3::checkDayRollover() {
+    if (!initialized) return;
+    lock();
+    updateCurrentDate();
+    unlock();
+}
+
+bool DataManagerV3::rebuildHistoryStats() {
+    if (!fs || !fs->isAvailable()) return false;
+    
+    Serial.println("🔧 全量重建历史统计...");
+    uint32_t start_ms = millis();
+    
+    // 由累计/月/周/日期索引各层汇总，代价与使用年限无关
+    rollup_record_t lifetime;
+    uint32_t best_day = 0;
+    int32_t last_active_day = -1;
+    uint8_t streak_days = 0;
+    lockTier();
+    rollup_store.getLifetime(history_index, &lifetime, &best_day);
+    unlockTier();
+    
+    // 从今天（今天没有运动则从昨天）往前数连续运动天数，最多追溯到日期索引起点；
+    // 连续天数上限255，一次读出足够的天数，不逐日打开索引文件
+    int32_t today = getTodayEpochDay();
+    if (today >= 0) {
+        const uint16_t window = 257;
+        std::vector<DailyTotalV3> indexed(window);
+        std::vector<uint8_t> found(window);
+        loadIndexedDays(today, window, indexed.data(), found.data());
+        auto has_data = [&](int32_t day) {
+            int32_t i = today - day;
+            return i >= 0 && i < window && found[i] && indexed[i].session_count > 0;
+        };
+        int32_t day = has_data(today) ? today : today - 1;
+        if (has_data(day)) {
+            last_active_day = day;
+        }
+        while (streak_days < 255 && has_data(day)) {
+            streak_days++;
+            day--;
+        }
+    }
+    
+    lock();
+    history_stats.reset();
+    history_stats.total_games = lifetime.sessions;
+    history_stats.total_jumps = lifetime.jumps;
+    history_stats.total_time = lifetime.duration;
+    history_stats.total_calories = lifetime.calories_x10 / 10.0f;
+    history_stats.best_score = lifetime.best_score;
+    history_stats.best_jumps = lifetime.max_day_jumps;
+    if (lifetime.best_score > 0) {
+        // 周/月汇总中的最佳得分只精确到所在周/月的起始日
+        history_stats.best_day = best_day;
+    }
+    history_stats.last_active_day = last_active_day;
+    history_stats.streak_days = streak_days;
+    unlock();
+    
+    Serial.printf("✅ 历史统计重建完成: %lu天有运动, 耗时 %lu ms\n",
+                 (unsigned long)lifetime.active_days, millis() - start_ms);
     return saveHistoryStats();
 }
 
 bool DataManagerV3::saveHistoryStats() {
     if (!fs || !fs->isAvailable()) return false;
     
-    String json_data = history_stats.toJsonString();
-    return fs->writeFile(V3_STATS_FILE, json_data);
+    markDirty(V3_DIRTY_STATS);
+    return true;
+}
+
+bool DataManagerV3::writeHistoryStats(const HistoryStatsV3& stats) {
+    JsonDocument doc;
+    stats.toJson(doc);
+    return fs->writeRecord(V3_STATS_FILE, doc);
 }
 
 bool DataManagerV3::loadHistoryStats() {
@@ -275,8 +1042,16 @@ bool DataManagerV3::loadHistoryStats() {
         return false;
     }
     
-    String json_data = fs->readFile(V3_STATS_FILE);
-    return history_stats.fromJsonString(json_data);
+    JsonDocument doc;
+    if (!fs->readRecord(V3_STATS_FILE, doc)) {
+        return false;
+    }
+    return history_stats.fromJson(doc);
+}
+
+bool DataManagerV3::repairCorruptedData() {
+    // 目前可修复的派生数据只有历史统计
+    return rebuildHistoryStats();
 }
 
 void DataManagerV3::resetHistoryStats() {
@@ -285,17 +1060,20 @@ void DataManagerV3::resetHistoryStats() {
 }
 
 bool DataManagerV3::saveTargetSettings(const TargetSettingsV3& settings) {
+    lock();
     target_settings = settings;
-    
+    markDirty(V3_DIRTY_TARGETS);
+    unlock();
+    return true;
+}
+
+bool DataManagerV3::writeTargetSettings(const TargetSettingsV3& settings) {
     // 将目标设置保存到系统配置中
     JsonDocument doc;
     JsonObject target_obj = doc["target"].to<JsonObject>();
-    target_settings.toJson(target_obj);
-    
-    String json_data;
-    serializeJson(doc, json_data);
+    settings.toJson(target_obj);
     
-    return fs->writeFile("/targets.json", json_data);
+    return fs->writeRecord("/targets.json", doc);
 }
 
 bool DataManagerV3::loadTargetSettings() {
@@ -303,10 +1081,8 @@ bool DataManagerV3::loadTargetSettings() {
         return false;
     }
 
-    String json_data = fs->readFile("/targets.json");
     JsonDocument doc;
-    
-    if (deserializeJson(doc, json_data) != DeserializationError::Ok) {
+    if (!fs->readRecord("/targets.json", doc)) {
         return false;
     }
     
@@ -339,50 +1115,93 @@ uint16_t DataManagerV3::getBestScoreToday() const {
     return current_day_data.daily_total.best_score;
 }
 
-// 周统计数据实现
+// 周统计数据实现（由内存中的滚动汇总计算）
 uint32_t DataManagerV3::getWeeklyWorkouts() const {
-    std::vector<DailyDataV3> week_data = const_cast<DataManagerV3*>(this)->getHistoryData(7);
-    uint32_t total = 0;
-    for (const auto& day : week_data) {
-        total += day.daily_total.session_count;
-    }
-    return total;
+    lock();
+    uint32_t value = rolling_totals.sum(7).session_count;
+    unlock();
+    return value;
 }
 
 uint32_t DataManagerV3::getWeeklyJumps() const {
-    std::vector<DailyDataV3> week_data = const_cast<DataManagerV3*>(this)->getHistoryData(7);
-    uint32_t total = 0;
-    for (const auto& day : week_data) {
-        total += day.daily_total.total_jumps;
-    }
-    return total;
+    lock();
+    uint32_t value = rolling_totals.sum(7).total_jumps;
+    unlock();
+    return value;
 }
 
 float DataManagerV3::getWeeklyCalories() const {
-    std::vector<DailyDataV3> week_data = const_cast<DataManagerV3*>(this)->getHistoryData(7);
-    float total = 0.0f;
-    for (const auto& day : week_data) {
-        total += day.daily_total.total_calories;
-    }
-    return total;
+    lock();
+    float value = rolling_totals.sum(7).total_calories;
+    unlock();
+    return value;
 }
 
 uint32_t DataManagerV3::getWeeklyTime() const {
-    std::vector<DailyDataV3> week_data = const_cast<DataManagerV3*>(this)->getHistoryData(7);
-    uint32_t total = 0;
-    for (const auto& day : week_data) {
-        total += day.daily_total.total_duration;
-    }
-    return total;
+    lock();
+    uint32_t value = rolling_totals.sum(7).total_duration;
+    unlock();
+    return value;
 }
 
 uint8_t DataManagerV3::getWeeklyGoalsAchieved() const {
-    std::vector<DailyDataV3> week_data = const_cast<DataManagerV3*>(this)->getHistoryData(7);
-    uint8_t total = 0;
-    for (const auto& day : week_data) {
-        total += day.daily_total.targets_achieved;
+    lock();
+    uint8_t value = rolling_totals.sum(7).targets_achieved;
+    unlock();
+    return value;
+}
+
+uint8_t DataManagerV3::getStreakDays() const {
+    lock();
+    uint8_t streak = rolling_totals.streak();
+    // 连续天数覆盖整个窗口时，更早的部分以历史统计为准
+    if (streak >= V3_ROLLING_DAYS - 1 && history_stats.streak_days > streak) {
+        streak = history_stats.streak_days;
+    }
+    unlock();
+    return streak;
+}
+
+std::vector<uint32_t> DataManagerV3::getJumpsTrend(uint8_t days) const {
+    std::vector<uint32_t> trend;
+    if (days > V3_TREND_DAYS) days = V3_TREND_DAYS;
+    for (int i = days - 1; i >= 0; i--) {
+        trend.push_back(trend_series.getDay(i));
     }
-    return total;
+    return trend;
+}
+
+std::vector<float> DataManagerV3::getCaloriesTrend(uint8_t days) const {
+    std::vector<float> trend;
+    if (days > V3_ROLLING_DAYS) days = V3_ROLLING_DAYS;
+    for (int i = days - 1; i >= 0; i--) {
+        trend.push_back(rolling_totals.getDay(i).total_calories);
+    }
+    return trend;
+}
+
+std::vector<uint16_t> DataManagerV3::getScoresTrend(uint8_t days) const {
+    std::vector<uint16_t> trend;
+    if (days > V3_ROLLING_DAYS) days = V3_ROLLING_DAYS;
+    for (int i = days - 1; i >= 0; i--) {
+        trend.push_back(rolling_totals.getDay(i).best_score);
+    }
+    return trend;
+}
+
+bool DataManagerV3::getTrendWindow(trend_window_v3_t which, TrendWindowV3& out, uint32_t* version) {
+    if (which >= V3_TREND_WINDOW_COUNT) return false;
+    
+    lock();
+    uint32_t current = trend_series.version();
+    if (version && *version == current) {
+        unlock();
+        return false;
+    }
+    out = trend_series.window(which);
+    if (version) *version = current;
+    unlock();
+    return true;
 }
 
 bool DataManagerV3::isTodayTargetAchieved() const {
@@ -415,34 +1234,70 @@ float DataManagerV3::getTodayTargetProgress() const {
 
 void DataManagerV3::printDataSummary() {
     Serial.println("📊 V3.0数据管理器状态:");
-    Serial.printf("   当前日期: %s\n", current_date.c_str());
+    char date_str[16];
+    DataUtilsV3::formatEpochDay(current_day, date_str, sizeof(date_str));
+    Serial.printf("   当前日期: %s\n", date_str);
     Serial.printf("   今日游戏: %d 次\n", getTotalGamesToday());
     Serial.printf("   今日跳跃: %d 次\n", getTotalJumpsToday());
     Serial.printf("   今日卡路里: %.1f\n", getTotalCaloriesToday());
     Serial.printf("   今日时长: %s\n", DataUtilsV3::formatTime(getTotalTimeToday()).c_str());
     Serial.printf("   今日最佳: %d 分\n", getBestScoreToday());
     Serial.printf("   目标进度: %.1f%%\n", getTodayTargetProgress() * 100);
+    if (last_save_us > 0) {
+        Serial.printf("   最近保存耗时: %lu μs\n", last_save_us);
+    }
+    Serial.printf("   写回: 已刷新 %lu 次, 待写回标记 0x%02X\n", flush_count, dirty_mask);
+    Serial.printf("   每日缓存: %d 条, 命中 %lu / 未命中 %lu\n",
+                 V3_DAILY_CACHE_SIZE, cache_hits, cache_misses);
+    Serial.printf("   分层汇总: 索引 %d 天 (%d bytes), 周 %d 条, 月 %d 条 (%d bytes)\n",
+                 history_index.dayCount(), history_index.fileSize(),
+                 rollup_store.weekCount(), rollup_store.monthCount(), rollup_store.fileSize());
     
     if (fs) {
-        Serial.printf("   存储使用: %.1f%%\n", fs->getUsagePercent());
+        Serial.printf("   存储使用: %.1f%% (高水位 %.0f%%)\n", fs->getUsagePercent(), V3_FS_HIGH_WATER_PERCENT);
     }
 }
 
 void DataManagerV3::updateCurrentDate() {
-    // 使用基于millis()的日期计算
-    String new_date = DataUtilsV3::getCurrentDateString();
+    // 时间未同步时按启动后经过的天数推算
+    int32_t new_day = DataUtilsV3::getEpochDay();
 
     // 如果日期变化，保存昨天的数据并创建新的当日数据
-    if (current_day_data.date != new_date && !current_day_data.date.isEmpty()) {
-        Serial.printf("📅 日期变化: %s -> %s\n", current_day_data.date.c_str(), new_date.c_str());
-        saveCurrentDayData();
-        current_day_data = DailyDataV3(new_date);
+    if (current_day_data.epoch_day != new_day && current_day_data.epoch_day >= 0) {
+        char old_str[16], new_str[16];
+        DataUtilsV3::formatEpochDay(current_day_data.epoch_day, old_str, sizeof(old_str));
+        DataUtilsV3::formatEpochDay(new_day, new_str, sizeof(new_str));
+        Serial.printf("📅 日期变化: %s -> %s\n", old_str, new_str);
+        if (fs) fs->trace(V3_TRACE_DAY_ROLLOVER, 0, (uint32_t)new_day);
+        
+        // 前一天的数据交给写回任务；若上一次跨天的数据还没写出则先同步写出
+        if (dirty_mask & V3_DIRTY_PREV_DAY) {
+            saveDailyData(previous_day_data);
+        }
+        previous_day_data = current_day_data;
+        markDirty(V3_DIRTY_PREV_DAY);
+        
+        // 滚动汇总窗口前进；时间回退等异常情况从文件重新加载
+        int32_t elapsed = new_day - current_day_data.epoch_day;
+        bool rolled = elapsed > 0 && rolling_totals.today == current_day;
+        if (rolled) {
+            rolling_totals.advance(elapsed, new_day);
+            trend_series.advance(new_day);
+        }
+        
+        current_day_data = DailyDataV3(new_day);
         saveCurrentDayData(); // 创建新日期的空数据文件
-    } else if (current_day_data.date.isEmpty()) {
-        current_day_data.date = new_date;
+        current_day = new_day;
+        
+        if (!rolled && initialized) {
+            loadRollingTotals();
+            loadTrendSeries();
+        }
+    } else if (current_day_data.epoch_day < 0) {
+        current_day_data.epoch_day = new_day;
     }
 
-    current_date = new_date;
+    current_day = new_day;
 }
 
 bool DataManagerV3::generateDemoData(uint8_t days) {
@@ -453,20 +1308,33 @@ bool DataManagerV3::generateDemoData(uint8_t days) {
 
     Serial.printf("🎯 开始生成 %d 天的演示数据...\n", days);
 
+    // 今天本地零点对应的epoch秒（时间未同步时会话时间只记录当天秒数）
+    uint32_t now_epoch = DataUtilsV3::getCurrentEpochSeconds();
+    uint32_t today_start = 0;
+    if (now_epoch >= 86400) {
+        time_t now = now_epoch;
+        struct tm timeinfo;
+        localtime_r(&now, &timeinfo);
+        today_start = now_epoch - (timeinfo.tm_hour * 3600 + timeinfo.tm_min * 60 + timeinfo.tm_sec);
+    }
+
     // 为过去几天生成演示数据
-    for (int i = 1; i < days; i++) { // 从昨天开始，不覆盖今天的数据
-        String date = DataUtilsV3::getDateString(-i);
+    uint8_t generated = 0;
+    for (int i = days - 1; i >= 1; i--) { // 从最早一天写到昨天（索引顺序追加），不覆盖今天的数据
+        int32_t epoch_day = current_day - i;
+        if (epoch_day < 0) continue;
+        
+        // 创建演示数据
+        DailyDataV3 demo_data(epoch_day);
+        String date = demo_data.dateString();
 
         // 检查是否已有数据，如果有就跳过
-        DailyDataV3 existing_data;
-        if (loadDailyData(date, existing_data) && !existing_data.isEmpty()) {
+        DailyTotalV3 existing_total;
+        if (loadDailySummary(epoch_day, existing_total) && existing_total.session_count > 0) {
             Serial.printf("⏭️ 跳过 %s，已有数据\n", date.c_str());
             continue;
         }
 
-        // 创建演示数据
-        DailyDataV3 demo_data(date);
-
         // 根据天数生成不同的数据模式
         int base_sessions = 2 + (i % 3); // 2-4次游戏
         int base_jumps = 80 + (i * 15) + (rand() % 40); // 80-200次跳跃
@@ -478,19 +1346,18 @@ bool DataManagerV3::generateDemoData(uint8_t days) {
             int hour = 8 + session * 4 + (rand() % 2); // 分散在一天中
             int minute = rand() % 60;
             int second = rand() % 60;
-            char time_str[9];
-            snprintf(time_str, sizeof(time_str), "%02d:%02d:%02d", hour, minute, second);
-            demo_session.start_time = String(time_str);
+            uint32_t time_of_day = hour * 3600 + minute * 60 + second;
+            demo_session.start_epoch = today_start ? today_start - i * 86400 + time_of_day : time_of_day;
 
             // 生成游戏数据
-            demo_session.difficulty = (game_difficulty_t)(rand() % DIFFICULTY_COUNT);
+            demo_session.difficulty = rand() % DIFFICULTY_COUNT;
             demo_session.jump_count = base_jumps + (rand() % 30) - 15; // 添加随机变化
             demo_session.duration = 180 + (rand() % 120); // 3-5分钟
-            demo_session.calories = DataUtilsV3::jumpsToCalories(demo_session.jump_count, demo_session.difficulty);
-            demo_session.avg_frequency = DataUtilsV3::calculateAvgFrequency(demo_session.jump_count, demo_session.duration);
-            demo_session.max_height = DataUtilsV3::calculateMaxHeight(demo_session.avg_frequency);
-            demo_session.score = DataUtilsV3::calculateGameScore(demo_session.jump_count, demo_session.duration, demo_session.difficulty);
-            demo_session.target_achieved = (rand() % 100) < 70; // 70%概率达成目标
+            demo_session.setCalories(DataUtilsV3::jumpsToCalories(demo_session.jump_count, demo_session.getDifficulty()));
+            demo_session.setAvgFrequency(DataUtilsV3::calculateAvgFrequency(demo_session.jump_count, demo_session.duration));
+            demo_session.setMaxHeight(DataUtilsV3::calculateMaxHeight(demo_session.getAvgFrequency()));
+            demo_session.score = DataUtilsV3::calculateGameScore(demo_session.jump_count, demo_session.duration, demo_session.getDifficulty());
+            demo_session.setTargetAchieved((rand() % 100) < 70); // 70%概率达成目标
 
             demo_data.addSession(demo_session);
         }
@@ -500,6 +1367,7 @@ bool DataManagerV3::generateDemoData(uint8_t days) {
 
         // 保存演示数据
         if (saveDailyData(demo_data)) {
+            generated++;
             Serial.printf("✅ %s: %d次游戏, %d次跳跃, %.1f卡路里\n",
                          date.c_str(),
                          demo_data.daily_total.session_count,
@@ -510,44 +1378,17 @@ bool DataManagerV3::generateDemoData(uint8_t days) {
         }
     }
 
-    // 更新历史统计
-    updateHistoryStats();
-
-    Serial.println("🎉 演示数据生成完成！");
-    return true;
-}
-
-void DataManagerV3::initNTPTime() {
-    Serial.println("🕐 初始化NTP时间同步...");
-
-    // 配置时区为中国标准时间 (UTC+8)
-    configTime(8 * 3600, 0, "pool.ntp.org", "time.nist.gov", "cn.pool.ntp.org");
-
-    // 等待时间同步（最多等待10秒）
-    Serial.print("⏳ 等待NTP时间同步");
-    int retry_count = 0;
-    time_t now = 0;
-
-    while (now < 946684800 && retry_count < 20) { // 2000-01-01 00:00:00 UTC
-        delay(500);
-        Serial.print(".");
-        time(&now);
-        retry_count++;
+    // 每次启动都会调用，已有数据时不重建统计（重建需要扫描所有历史文件）
+    if (generated == 0) {
+        Serial.println("⏭️ 演示数据已存在，无需生成");
+        return true;
     }
-    Serial.println();
 
-    if (now > 946684800) {
-        struct tm timeinfo;
-        localtime_r(&now, &timeinfo);
+    // 批量写入了历史文件，重建统计
+    rebuildHistoryStats();
+    loadRollingTotals();
+    loadTrendSeries();
 
-        Serial.printf("✅ NTP时间同步成功: %04d-%02d-%02d %02d:%02d:%02d\n",
-                     timeinfo.tm_year + 1900,
-                     timeinfo.tm_mon + 1,
-                     timeinfo.tm_mday,
-                     timeinfo.tm_hour,
-                     timeinfo.tm_min,
-                     timeinfo.tm_sec);
-    } else {
-        Serial.println("⚠️ NTP时间同步失败，将使用备用时间计算");
-    }
+    Serial.println("🎉 演示数据生成完成！");
+    return true;
 }
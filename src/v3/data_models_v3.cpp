@@ -1,43 +1,82 @@
 #include "v3/data_models_v3.h"
+#include "v3/ntp_time_v3.h"
 #include <math.h>
 
 // GameSessionV3 实现
-void GameSessionV3::toJson(JsonObject& obj) const {
-    obj["start_time"] = start_time;
+void GameSessionV3::setCalories(float calories) {
+    float scaled = calories * 10.0f + 0.5f;
+    calories_x10 = scaled <= 0.0f ? 0 : (scaled >= 65535.0f ? 65535 : (uint16_t)scaled);
+}
+
+void GameSessionV3::setAvgFrequency(float frequency) {
+    float scaled = frequency * 100.0f + 0.5f;
+    avg_frequency_x100 = scaled <= 0.0f ? 0 : (scaled >= 65535.0f ? 65535 : (uint16_t)scaled);
+}
+
+void GameSessionV3::setMaxHeight(float height) {
+    float scaled = height * 1000.0f + 0.5f;
+    max_height_mm = scaled <= 0.0f ? 0 : (scaled >= 65535.0f ? 65535 : (uint16_t)scaled);
+}
+
+void GameSessionV3::setTargetAchieved(bool achieved) {
+    if (achieved) {
+        flags |= V3_SESSION_FLAG_TARGET;
+    } else {
+        flags &= ~V3_SESSION_FLAG_TARGET;
+    }
+}
+
+void GameSessionV3::toJson(JsonObject& obj, bool for_export) const {
+    obj["start_epoch"] = start_epoch;
+    if (for_export) {
+        char time_str[9];
+        DataUtilsV3::formatTimeOfDay(start_epoch, time_str, sizeof(time_str));
+        obj["start_time"] = time_str;
+    }
     obj["duration"] = duration;
-    obj["difficulty"] = (int)difficulty;
+    obj["difficulty"] = difficulty;
     obj["jump_count"] = jump_count;
-    obj["calories"] = calories;
-    obj["max_height"] = max_height;
-    obj["avg_frequency"] = avg_frequency;
+    obj["calories"] = getCalories();
+    obj["max_height"] = getMaxHeight();
+    obj["avg_frequency"] = getAvgFrequency();
     obj["score"] = score;
-    obj["target_achieved"] = target_achieved;
+    obj["target_achieved"] = isTargetAchieved();
 }
 
 bool GameSessionV3::fromJson(const JsonObject& obj) {
-    if (!obj["start_time"].is<String>() || !obj["duration"].is<uint32_t>()) {
+    if (!obj["duration"].is<uint32_t>()) {
         return false;
     }
     
-    start_time = obj["start_time"].as<String>();
-    duration = obj["duration"];
-    difficulty = (game_difficulty_t)obj["difficulty"].as<int>();
-    jump_count = obj["jump_count"];
-    calories = obj["calories"];
-    max_height = obj["max_height"];
-    avg_frequency = obj["avg_frequency"];
+    if (obj["start_epoch"].is<uint32_t>()) {
+        start_epoch = obj["start_epoch"];
+    } else {
+        // 旧版记录只有"HH:MM:SS"，按当天秒数保存
+        const char* time_str = obj["start_time"] | "00:00:00";
+        int h = 0, m = 0, sec = 0;
+        sscanf(time_str, "%d:%d:%d", &h, &m, &sec);
+        start_epoch = (uint32_t)(h * 3600 + m * 60 + sec) % 86400;
+    }
+    uint32_t value = obj["duration"];
+    duration = value > 65535 ? 65535 : value;
+    difficulty = obj["difficulty"].as<uint8_t>();
+    value = obj["jump_count"];
+    jump_count = value > 65535 ? 65535 : value;
+    setCalories(obj["calories"].as<float>());
+    setMaxHeight(obj["max_height"].as<float>());
+    setAvgFrequency(obj["avg_frequency"].as<float>());
     score = obj["score"];
-    target_achieved = obj["target_achieved"];
+    setTargetAchieved(obj["target_achieved"].as<bool>());
     
     return true;
 }
 
 uint16_t GameSessionV3::calculateScore() const {
-    return DataUtilsV3::calculateGameScore(jump_count, duration, difficulty);
+    return DataUtilsV3::calculateGameScore(jump_count, duration, getDifficulty());
 }
 
 float GameSessionV3::calculateCalories() const {
-    return DataUtilsV3::jumpsToCalories(jump_count, difficulty);
+    return DataUtilsV3::jumpsToCalories(jump_count, getDifficulty());
 }
 
 // DailyTotalV3 实现
@@ -71,33 +110,52 @@ void DailyTotalV3::reset() {
 
 void DailyTotalV3::addSession(const GameSessionV3& session) {
     total_jumps += session.jump_count;
-    total_calories += session.calories;
+    total_calories += session.getCalories();
     total_duration += session.duration;
-    session_count++;
+    if (session_count < 255) session_count++;
     
     if (session.score > best_score) {
         best_score = session.score;
     }
     
-    if (session.target_achieved) {
+    if (session.isTargetAchieved() && targets_achieved < 255) {
         targets_achieved++;
     }
 }
 
 // DailyDataV3 实现
-String DailyDataV3::toJsonString() const {
-    JsonDocument doc;
+DailyDataV3::DailyDataV3(const String& date_str) :
+    epoch_day(DataUtilsV3::dateToEpochDay(date_str)),
+    session_count(0) {
+}
 
-    doc["date"] = date;
+String DailyDataV3::dateString() const {
+    if (epoch_day < 0) return String("");
+    char date_str[11];
+    DataUtilsV3::formatEpochDay(epoch_day, date_str, sizeof(date_str));
+    return String(date_str);
+}
+
+void DailyDataV3::toJson(JsonDocument& doc, bool for_export) const {
+    char date_str[11] = "";
+    if (epoch_day >= 0) {
+        DataUtilsV3::formatEpochDay(epoch_day, date_str, sizeof(date_str));
+    }
+    doc["date"] = date_str;
 
     JsonArray sessions_array = doc["sessions"].to<JsonArray>();
-    for (const auto& session : sessions) {
+    for (uint8_t i = 0; i < session_count; i++) {
         JsonObject session_obj = sessions_array.add<JsonObject>();
-        session.toJson(session_obj);
+        sessions[i].toJson(session_obj, for_export);
     }
 
     JsonObject total_obj = doc["daily_total"].to<JsonObject>();
     daily_total.toJson(total_obj);
+}
+
+String DailyDataV3::toJsonString() const {
+    JsonDocument doc;
+    toJson(doc, true);
     
     String output;
     serializeJson(doc, output);
@@ -113,15 +171,20 @@ bool DailyDataV3::fromJsonString(const String& json_str) {
         return false;
     }
     
-    date = doc["date"].as<String>();
+    return fromJson(doc);
+}
+
+bool DailyDataV3::fromJson(JsonDocument& doc) {
+    epoch_day = DataUtilsV3::dateToEpochDay(doc["date"] | "");
     
-    // 解析会话数据
-    sessions.clear();
+    // 解析会话数据，超出容量的部分只保留在汇总中
+    session_count = 0;
     JsonArray sessions_array = doc["sessions"];
     for (JsonObject session_obj : sessions_array) {
+        if (session_count >= V3_MAX_DAILY_SESSIONS) break;
         GameSessionV3 session;
         if (session.fromJson(session_obj)) {
-            sessions.push_back(session);
+            sessions[session_count++] = session;
         }
     }
     
@@ -132,22 +195,38 @@ bool DailyDataV3::fromJsonString(const String& json_str) {
     return true;
 }
 
-void DailyDataV3::addSession(const GameSessionV3& session) {
-    sessions.push_back(session);
+bool DailyDataV3::fromJsonSummary(JsonDocument& doc) {
+    epoch_day = DataUtilsV3::dateToEpochDay(doc["date"] | "");
+    session_count = 0;
+    
+    JsonObject total_obj = doc["daily_total"];
+    daily_total.fromJson(total_obj);
+    return !total_obj.isNull();
+}
+
+void DailyDataV3::summaryFilter(JsonDocument& filter) {
+    filter["date"] = true;
+    filter["daily_total"] = true;
+}
+
+bool DailyDataV3::addSession(const GameSessionV3& session) {
     daily_total.addSession(session);
+    if (session_count >= V3_MAX_DAILY_SESSIONS) {
+        return false;
+    }
+    sessions[session_count++] = session;
+    return true;
 }
 
 void DailyDataV3::updateDailyTotal() {
     daily_total.reset();
-    for (const auto& session : sessions) {
-        daily_total.addSession(session);
+    for (uint8_t i = 0; i < session_count; i++) {
+        daily_total.addSession(sessions[i]);
     }
 }
 
 // SystemConfigV3 实现
-String SystemConfigV3::toJsonString() const {
-    JsonDocument doc;
-    
+void SystemConfigV3::toJson(JsonDocument& doc) const {
     doc["volume"] = volume;
     doc["brightness"] = brightness;
     doc["sleep_timeout"] = sleep_timeout;
@@ -157,6 +236,11 @@ String SystemConfigV3::toJsonString() const {
     doc["vibration_enabled"] = vibration_enabled;
     doc["language"] = language;
     doc["version"] = JUMPING_ROCKET_VERSION_STRING;
+}
+
+String SystemConfigV3::toJsonString() const {
+    JsonDocument doc;
+    toJson(doc);
     
     String output;
     serializeJson(doc, output);
@@ -172,6 +256,10 @@ bool SystemConfigV3::fromJsonString(const String& json_str) {
         return false;
     }
     
+    return fromJson(doc);
+}
+
+bool SystemConfigV3::fromJson(JsonDocument& doc) {
     volume = doc["volume"];
     brightness = doc["brightness"];
     sleep_timeout = doc["sleep_timeout"];
@@ -215,24 +303,33 @@ void SystemConfigV3::resetToDefault() {
     brightness = 70;
     sleep_timeout = 300;
     default_difficulty = DIFFICULTY_NORMAL;
-    auto_sleep = false;
+    auto_sleep = true;
     sound_enabled = true;
     vibration_enabled = false;
     language = "zh-CN";
 }
 
 // HistoryStatsV3 实现
-String HistoryStatsV3::toJsonString() const {
-    JsonDocument doc;
-    
+void HistoryStatsV3::toJson(JsonDocument& doc) const {
     doc["total_games"] = total_games;
     doc["total_jumps"] = total_jumps;
     doc["total_time"] = total_time;
     doc["total_calories"] = total_calories;
     doc["best_score"] = best_score;
     doc["best_jumps"] = best_jumps;
-    doc["best_date"] = best_date;
+    // 文件中日期保持"YYYY-MM-DD"字符串
+    char date_str[11] = "";
+    if (best_day >= 0) DataUtilsV3::formatEpochDay(best_day, date_str, sizeof(date_str));
+    doc["best_date"] = date_str;
     doc["streak_days"] = streak_days;
+    date_str[0] = '\0';
+    if (last_active_day >= 0) DataUtilsV3::formatEpochDay(last_active_day, date_str, sizeof(date_str));
+    doc["last_active_date"] = date_str;
+}
+
+String HistoryStatsV3::toJsonString() const {
+    JsonDocument doc;
+    toJson(doc);
     
     String output;
     serializeJson(doc, output);
@@ -247,14 +344,19 @@ bool HistoryStatsV3::fromJsonString(const String& json_str) {
         return false;
     }
     
+    return fromJson(doc);
+}
+
+bool HistoryStatsV3::fromJson(JsonDocument& doc) {
     total_games = doc["total_games"];
     total_jumps = doc["total_jumps"];
     total_time = doc["total_time"];
     total_calories = doc["total_calories"];
     best_score = doc["best_score"];
     best_jumps = doc["best_jumps"];
-    best_date = doc["best_date"].as<String>();
+    best_day = DataUtilsV3::dateToEpochDay(doc["best_date"] | "");
     streak_days = doc["streak_days"];
+    last_active_day = DataUtilsV3::dateToEpochDay(doc["last_active_date"] | "");
     
     return true;
 }
@@ -267,7 +369,7 @@ void HistoryStatsV3::updateWithDailyData(const DailyDataV3& daily_data) {
     
     if (daily_data.daily_total.best_score > best_score) {
         best_score = daily_data.daily_total.best_score;
-        best_date = daily_data.date;
+        best_day = daily_data.epoch_day;
     }
     
     if (daily_data.daily_total.total_jumps > best_jumps) {
@@ -275,6 +377,33 @@ void HistoryStatsV3::updateWithDailyData(const DailyDataV3& daily_data) {
     }
 }
 
+void HistoryStatsV3::addSession(const GameSessionV3& session, const DailyDataV3& daily_data) {
+    total_games++;
+    total_jumps += session.jump_count;
+    total_time += session.duration;
+    total_calories += session.getCalories();
+    
+    if (session.score > best_score) {
+        best_score = session.score;
+        best_day = daily_data.epoch_day;
+    }
+    
+    // 与updateWithDailyData一致：按单日总跳跃数记录
+    if (daily_data.daily_total.total_jumps > best_jumps) {
+        best_jumps = daily_data.daily_total.total_jumps;
+    }
+    
+    // 当天第一次运动时更新连续天数
+    if (last_active_day != daily_data.epoch_day) {
+        if (last_active_day >= 0 && last_active_day == daily_data.epoch_day - 1) {
+            if (streak_days < 255) streak_days++;   // uint8_t，与rebuildHistoryStats一样封顶
+        } else {
+            streak_days = 1;
+        }
+        last_active_day = daily_data.epoch_day;
+    }
+}
+
 void HistoryStatsV3::reset() {
     total_games = 0;
     total_jumps = 0;
@@ -282,8 +411,67 @@ void HistoryStatsV3::reset() {
     total_calories = 0.0f;
     best_score = 0;
     best_jumps = 0;
-    best_date = "";
+    best_day = -1;
     streak_days = 0;
+    last_active_day = -1;
+}
+
+// RollingTotalsV3 实现
+void RollingTotalsV3::reset(int32_t epoch_day) {
+    for (int i = 0; i < V3_ROLLING_DAYS; i++) {
+        days[i].reset();
+    }
+    head = 0;
+    today = epoch_day;
+}
+
+const DailyTotalV3& RollingTotalsV3::getDay(uint8_t days_ago) const {
+    static const DailyTotalV3 empty_total;
+    if (days_ago >= V3_ROLLING_DAYS) return empty_total;
+    return days[(head + V3_ROLLING_DAYS - days_ago) % V3_ROLLING_DAYS];
+}
+
+void RollingTotalsV3::setDay(uint8_t days_ago, const DailyTotalV3& total) {
+    if (days_ago >= V3_ROLLING_DAYS) return;
+    days[(head + V3_ROLLING_DAYS - days_ago) % V3_ROLLING_DAYS] = total;
+}
+
+void RollingTotalsV3::advance(uint16_t count, int32_t new_today) {
+    if (count >= V3_ROLLING_DAYS) {
+        reset(new_today);
+        return;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        head = (head + 1) % V3_ROLLING_DAYS;
+        days[head].reset();
+    }
+    today = new_today;
+}
+
+DailyTotalV3 RollingTotalsV3::sum(uint8_t count) const {
+    DailyTotalV3 total;
+    if (count > V3_ROLLING_DAYS) count = V3_ROLLING_DAYS;
+    for (uint8_t i = 0; i < count; i++) {
+        const DailyTotalV3& day = getDay(i);
+        total.total_jumps += day.total_jumps;
+        total.total_calories += day.total_calories;
+        total.total_duration += day.total_duration;
+        total.session_count += day.session_count;
+        total.targets_achieved += day.targets_achieved;
+        if (day.best_score > total.best_score) {
+            total.best_score = day.best_score;
+        }
+    }
+    return total;
+}
+
+uint8_t RollingTotalsV3::streak() const {
+    uint8_t start = getDay(0).session_count > 0 ? 0 : 1;
+    uint8_t count = 0;
+    while (start + count < V3_ROLLING_DAYS && getDay(start + count).session_count > 0) {
+        count++;
+    }
+    return count;
 }
 
 // TargetSettingsV3 实现
@@ -309,7 +497,7 @@ bool TargetSettingsV3::isTargetAchieved(const GameSessionV3& session) const {
     
     return (session.jump_count >= target_jumps) ||
            (session.duration >= target_time) ||
-           (session.calories >= target_calories);
+           (session.getCalories() >= target_calories);
 }
 
 bool TargetSettingsV3::isTargetAchieved(const DailyDataV3& daily_data) const {
@@ -339,15 +527,9 @@ String formatTime(uint32_t seconds) {
 }
 
 String getCurrentTimeString() {
-    // 尝试使用NTP同步的时间
-    time_t now;
+    // 优先使用时间服务的时间（NTP同步、RTC或文件恢复）
     struct tm timeinfo;
-
-    time(&now);
-
-    // 检查时间是否已同步
-    if (now > 946684800) { // 2000-01-01 00:00:00 UTC
-        localtime_r(&now, &timeinfo);
+    if (ntpTimeV3.getCurrentTime(&timeinfo)) {
 
         char time_str[9];
         snprintf(time_str, sizeof(time_str), "%02d:%02d:%02d",
@@ -375,84 +557,101 @@ String getCurrentDateString() {
 }
 
 String getDateString(int days_offset) {
-    // 尝试使用NTP同步的时间
-    time_t now;
-    struct tm timeinfo;
-
-    time(&now);
-
-    // 检查时间是否已同步（时间戳大于2000年1月1日）
-    if (now > 946684800) { // 2000-01-01 00:00:00 UTC
-        // 添加天数偏移
-        now += (days_offset * 24 * 60 * 60);
+    return epochDayToDateString(getEpochDay(days_offset));
+}
 
-        // 转换为本地时间
-        localtime_r(&now, &timeinfo);
+int32_t getEpochDay(int days_offset) {
+    // 有有效时间时按本地时区取日期
+    struct tm timeinfo;
+    if (ntpTimeV3.getCurrentTime(&timeinfo)) {
+        return civilToEpochDay(timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday) + days_offset;
+    }
 
-        char date_str[11];
-        snprintf(date_str, sizeof(date_str), "%04d-%02d-%02d",
-                timeinfo.tm_year + 1900,
-                timeinfo.tm_mon + 1,
-                timeinfo.tm_mday);
+    // 备用方案：以2025-07-06为启动日，按运行时间推算
+    static int32_t fallback_base = -1;
+    if (fallback_base < 0) {
+        fallback_base = civilToEpochDay(2025, 7, 6);
+        Serial.println("⚠️ 时间未同步，使用备用日期计算（2025-07-06起）");
+    }
+    return fallback_base + (int32_t)(millis() / (24UL * 60UL * 60UL * 1000UL)) + days_offset;
+}
 
-        return String(date_str);
-    } else {
-        // 如果NTP时间未同步，使用备用的基于millis()的计算
-        Serial.println("⚠️ NTP时间未同步，使用备用日期计算");
+int32_t civilToEpochDay(int32_t y, int32_t m, int32_t d) {
+    // 公历日期转天数（以3月为年首，闰日落在年末）
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    int32_t yoe = y - era * 400;
+    int32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
 
-        static uint32_t start_day_millis = 0;
-        static bool initialized = false;
+void epochDayToCivil(int32_t epoch_day, int32_t* year, int32_t* month, int32_t* day) {
+    // civilToEpochDay的逆运算
+    int32_t z = epoch_day + 719468;
+    int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int32_t doe = z - era * 146097;
+    int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int32_t mp = (5 * doy + 2) / 153;
+    *day = doy - (153 * mp + 2) / 5 + 1;
+    *month = mp < 10 ? mp + 3 : mp - 9;
+    *year = yoe + era * 400 + (*month <= 2);
+}
 
-        if (!initialized) {
-            start_day_millis = millis();
-            initialized = true;
-            Serial.printf("📅 备用日期系统初始化，启动时间: %lu ms\n", start_day_millis);
-        }
+int32_t dateToEpochDay(const String& date) {
+    return dateToEpochDay(date.c_str());
+}
 
-        // 计算从启动到现在经过的天数
-        uint32_t current_millis = millis();
-        uint32_t elapsed_days = (current_millis - start_day_millis) / (24UL * 60UL * 60UL * 1000UL);
-
-        // 基准日期：2025-07-06
-        uint32_t base_year = 2025;
-        uint32_t base_month = 7;
-        uint32_t base_day = 6;
-
-        // 计算目标日期
-        int32_t target_day = base_day + elapsed_days + days_offset;
-        uint32_t year = base_year;
-        uint32_t month = base_month;
-
-        // 简单的日期计算
-        while (target_day > 30) {
-            target_day -= 30;
-            month++;
-            if (month > 12) {
-                month = 1;
-                year++;
-            }
-        }
+int32_t dateToEpochDay(const char* date) {
+    if (!date || strlen(date) != 10 || date[4] != '-' || date[7] != '-') return -1;
+    
+    int32_t y = atoi(date);
+    int32_t m = atoi(date + 5);
+    int32_t d = atoi(date + 8);
+    if (m < 1 || m > 12 || d < 1 || d > 31) return -1;
+    return civilToEpochDay(y, m, d);
+}
 
-        while (target_day <= 0) {
-            target_day += 30;
-            month--;
-            if (month == 0) {
-                month = 12;
-                year--;
-            }
-        }
+String epochDayToDateString(int32_t epoch_day) {
+    char date_str[11];
+    formatEpochDay(epoch_day, date_str, sizeof(date_str));
+    return String(date_str);
+}
 
-        char date_str[11];
-        snprintf(date_str, sizeof(date_str), "%04u-%02u-%02u", year, month, target_day);
+void formatEpochDay(int32_t epoch_day, char* buf, size_t len) {
+    int32_t y, m, d;
+    epochDayToCivil(epoch_day, &y, &m, &d);
+    snprintf(buf, len, "%04d-%02d-%02d", (int)y, (int)m, (int)d);
+}
 
-        return String(date_str);
+uint32_t getCurrentEpochSeconds() {
+    if (ntpTimeV3.isValidTime()) {
+        return (uint32_t)ntpTimeV3.getCurrentTimestamp();
+    }
+    // 时间未同步：与getCurrentTimeString的备用方案一致，记录当天秒数
+    return (millis() / 1000) % 86400;
+}
+
+void formatTimeOfDay(uint32_t epoch_seconds, char* buf, size_t len) {
+    int hours, minutes, secs;
+    if (epoch_seconds >= 86400) {
+        time_t t = epoch_seconds;
+        struct tm timeinfo;
+        localtime_r(&t, &timeinfo);
+        hours = timeinfo.tm_hour;
+        minutes = timeinfo.tm_min;
+        secs = timeinfo.tm_sec;
+    } else {
+        hours = epoch_seconds / 3600;
+        minutes = (epoch_seconds % 3600) / 60;
+        secs = epoch_seconds % 60;
     }
+    snprintf(buf, len, "%02d:%02d:%02d", hours, minutes, secs);
 }
 
 bool isValidDate(const String& date) {
-    return date.length() == 10 && 
-           date.charAt(4) == '-' && 
-           date.charAt(7) == '-';
+    return dateToEpochDay(date.c_str()) >= 0;
 }
 
 bool isValidTime(const String& time) {
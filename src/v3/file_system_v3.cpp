@@ -1,10 +1,22 @@
 #include "v3/file_system_v3.h"
+#include "v3/data_models_v3.h"
+#include "v3/ntp_time_v3.h"
+#include <esp_system.h>
 #include <time.h>
+#include <algorithm>
 
 // 全局文件系统实例
 FileSystemV3 fileSystemV3;
 
-FileSystemV3::FileSystemV3() : fs_initialized(false), fs_available(false) {
+FileSystemV3::FileSystemV3() :
+    backend(nullptr),
+    fs_initialized(false),
+    fs_available(false),
+    fill_percent(0.0f),
+    writes_since_fill(0),
+    trace_mux(portMUX_INITIALIZER_UNLOCKED),
+    trace_io_mutex(nullptr) {
+    resetWriteLatencyStats();
 }
 
 FileSystemV3::~FileSystemV3() {
@@ -19,22 +31,38 @@ bool FileSystemV3::init() {
         return fs_available;
     }
     
-    // 初始化SPIFFS
-    Serial.println("正在初始化SPIFFS...");
-    if (!SPIFFS.begin(false)) {
-        Serial.println("⚠️ SPIFFS挂载失败，尝试格式化...");
-        if (!SPIFFS.begin(true)) {
-            Serial.println("❌ SPIFFS初始化和格式化都失败");
+    // 初始化编译期选定的存储后端
+    backend = getStorageBackendV3();
+    Serial.printf("正在初始化%s...\n", backend->name());
+    if (!backend->begin(false)) {
+        Serial.printf("⚠️ %s挂载失败，尝试格式化...\n", backend->name());
+        if (!backend->begin(V3_FS_FORMAT_ON_FAIL)) {
+            Serial.printf("❌ %s初始化和格式化都失败\n", backend->name());
             fs_available = false;
             return false;
         }
-        Serial.println("✅ SPIFFS格式化成功");
+        Serial.printf("✅ %s格式化成功\n", backend->name());
     } else {
-        Serial.println("✅ SPIFFS挂载成功");
+        Serial.printf("✅ %s挂载成功\n", backend->name());
     }
     
     fs_initialized = true;
     fs_available = true;
+    refreshFillLevel();
+    
+    // 打开（首次启动时预分配）事件日志
+    if (!trace_io_mutex) {
+        trace_io_mutex = xSemaphoreCreateMutex();
+    }
+    if (trace_log.begin(backend, V3_LOG_FILE)) {
+        Serial.printf("📝 事件日志: %lu 条容量, 下一序号 %lu\n",
+                     trace_log.capacity(), trace_log.nextSeq());
+    } else {
+        Serial.println("⚠️ 事件日志不可用");
+    }
+    trace(V3_TRACE_BOOT,
+          JUMPING_ROCKET_VERSION_MAJOR * 100 + JUMPING_ROCKET_VERSION_MINOR * 10 + JUMPING_ROCKET_VERSION_PATCH,
+          (uint32_t)esp_reset_reason());
     
     // 创建默认目录结构
     createDefaultDirectories();
@@ -48,7 +76,7 @@ bool FileSystemV3::init() {
 
 void FileSystemV3::deinit() {
     if (fs_initialized) {
-        SPIFFS.end();
+        backend->end();
         fs_initialized = false;
         fs_available = false;
         Serial.println("文件系统已关闭");
@@ -61,20 +89,15 @@ bool FileSystemV3::writeFile(const String& path, const String& content) {
         return false;
     }
     
-    if (content.length() > V3_MAX_FILE_SIZE) {
-        Serial.printf("❌ 文件内容过大: %d > %d\n", content.length(), V3_MAX_FILE_SIZE);
-        return false;
-    }
-    
-    File file = SPIFFS.open(path, "w");
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_WRITE);
     if (!file) {
         Serial.printf("❌ 无法创建文件: %s\n", path.c_str());
-        logOperation("WRITE_FAIL", path, false);
+        logOperation("WRITE_FAIL", path.c_str(), false);
         return false;
     }
     
-    size_t written = file.print(content);
-    file.close();
+    size_t written = file->write((const uint8_t*)content.c_str(), content.length());
+    delete file;
     
     bool success = (written == content.length());
     if (success) {
@@ -84,7 +107,7 @@ bool FileSystemV3::writeFile(const String& path, const String& content) {
                      path.c_str(), written, content.length());
     }
     
-    logOperation("WRITE", path, success);
+    logOperation("WRITE", path.c_str(), success);
     return success;
 }
 
@@ -99,24 +122,31 @@ String FileSystemV3::readFile(const String& path) {
         return "";
     }
     
-    File file = SPIFFS.open(path, "r");
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_READ);
     if (!file) {
         Serial.printf("❌ 无法打开文件: %s\n", path.c_str());
-        logOperation("READ_FAIL", path, false);
+        logOperation("READ_FAIL", path.c_str(), false);
         return "";
     }
     
-    String content = file.readString();
-    file.close();
+    // 按文件大小一次性预留，分块读取
+    String content;
+    content.reserve(file->size());
+    char chunk[128];
+    size_t n;
+    while ((n = file->read((uint8_t*)chunk, sizeof(chunk))) > 0) {
+        content.concat(chunk, n);
+    }
+    delete file;
     
     Serial.printf("✅ 文件读取成功: %s (%d bytes)\n", path.c_str(), content.length());
-    logOperation("READ", path, true);
+    logOperation("READ", path.c_str(), true);
     return content;
 }
 
-bool FileSystemV3::fileExists(const String& path) {
+bool FileSystemV3::fileExists(const char* path) {
     if (!fs_available) return false;
-    return SPIFFS.exists(path);
+    return backend->exists(path);
 }
 
 bool FileSystemV3::deleteFile(const String& path) {
@@ -127,84 +157,230 @@ bool FileSystemV3::deleteFile(const String& path) {
         return true; // 文件不存在也算删除成功
     }
     
-    bool success = SPIFFS.remove(path);
+    bool success = backend->remove(path.c_str());
     if (success) {
         Serial.printf("✅ 文件删除成功: %s\n", path.c_str());
     } else {
         Serial.printf("❌ 文件删除失败: %s\n", path.c_str());
     }
     
-    logOperation("DELETE", path, success);
+    logOperation("DELETE", path.c_str(), success);
     return success;
 }
 
-size_t FileSystemV3::getFileSize(const String& path) {
-    if (!fs_available || !fileExists(path)) return 0;
+bool FileSystemV3::renameFile(const String& from, const String& to) {
+    if (!fs_available) return false;
+    
+    bool success = backend->rename(from.c_str(), to.c_str());
+    logOperation("RENAME", from.c_str(), success);
+    return success;
+}
+
+bool FileSystemV3::appendFile(const String& path, const String& content) {
+    if (!fs_available) return false;
     
-    File file = SPIFFS.open(path, "r");
-    if (!file) return 0;
+    bool success = backend->append(path.c_str(), (const uint8_t*)content.c_str(), content.length());
+    logOperation("APPEND", path.c_str(), success);
+    return success;
+}
+
+size_t FileSystemV3::getFileSize(const String& path) {
+    if (!fs_available) return 0;
     
-    size_t size = file.size();
-    file.close();
+    size_t size = 0;
+    backend->stat(path.c_str(), &size);
     return size;
 }
 
+static void collect_file_cb(const char* path, size_t size, void* ctx) {
+    (void)size;
+    ((std::vector<String>*)ctx)->push_back(String(path));
+}
+
 std::vector<String> FileSystemV3::listFiles(const String& dir) {
     std::vector<String> files;
     
     if (!fs_available) return files;
     
-    File root = SPIFFS.open(dir);
-    if (!root || !root.isDirectory()) {
+    if (backend->list(dir.c_str(), collect_file_cb, &files) < 0) {
         Serial.printf("❌ 无法打开目录: %s\n", dir.c_str());
         return files;
     }
     
-    File file = root.openNextFile();
-    while (file) {
-        if (!file.isDirectory()) {
-            files.push_back(String(file.name()));
-        }
-        file = root.openNextFile();
-    }
-    
     Serial.printf("📁 目录 %s 包含 %d 个文件\n", dir.c_str(), files.size());
     return files;
 }
 
 bool FileSystemV3::writeJson(const String& path, const JsonDocument& doc) {
-    String jsonString;
-    serializeJson(doc, jsonString);
-    return writeFile(path, jsonString);
+    if (!fs_available) {
+        Serial.println("❌ 文件系统不可用");
+        return false;
+    }
+    
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_WRITE);
+    if (!file) {
+        Serial.printf("❌ 无法创建文件: %s\n", path.c_str());
+        logOperation("WRITE_FAIL", path.c_str(), false);
+        return false;
+    }
+    
+    StorageWriterV3 writer(file);
+    serializeJson(doc, writer);
+    bool success = writer.flush();
+    delete file;
+    
+    if (success) {
+        Serial.printf("✅ 文件写入成功: %s (%d bytes)\n", path.c_str(), writer.bytesWritten());
+    } else {
+        Serial.printf("❌ 文件写入不完整: %s\n", path.c_str());
+    }
+    
+    logOperation("WRITE", path.c_str(), success);
+    return success;
 }
 
 bool FileSystemV3::readJson(const String& path, JsonDocument& doc) {
-    String content = readFile(path);
-    if (content.isEmpty()) return false;
+    if (!fs_available) {
+        Serial.println("❌ 文件系统不可用");
+        return false;
+    }
+    
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_READ);
+    if (!file) {
+        Serial.printf("❌ 无法打开文件: %s\n", path.c_str());
+        logOperation("READ_FAIL", path.c_str(), false);
+        return false;
+    }
+    
+    StorageReaderV3 reader(file);
+    DeserializationError error = deserializeJson(doc, reader);
+    delete file;
     
-    DeserializationError error = deserializeJson(doc, content);
     if (error) {
         Serial.printf("❌ JSON解析失败: %s, 错误: %s\n", 
                      path.c_str(), error.c_str());
         return false;
     }
     
+    logOperation("READ", path.c_str(), true);
+    return true;
+}
+
+bool FileSystemV3::writeRecord(const char* path, const JsonDocument& doc) {
+    if (!fs_available) {
+        Serial.println("❌ 文件系统不可用");
+        return false;
+    }
+    
+    uint32_t start_us = micros();
+    StorageFileV3* file = backend->open(path, V3_OPEN_WRITE);
+    if (!file) {
+        Serial.printf("❌ 无法创建文件: %s\n", path);
+        logOperation("WRITE_FAIL", path, false);
+        return false;
+    }
+    
+    const uint8_t header[V3_RECORD_HEADER_SIZE] = {
+        V3_RECORD_MAGIC_0, V3_RECORD_MAGIC_1, V3_RECORD_VERSION, V3_RECORD_FORMAT
+    };
+    
+    StorageWriterV3 writer(file);
+    writer.write(header, sizeof(header));
+#if V3_RECORD_FORMAT == V3_RECORD_FORMAT_MSGPACK
+    serializeMsgPack(doc, writer);
+#else
+    serializeJson(doc, writer);
+#endif
+    bool success = writer.flush();
+    delete file;
+    recordWriteLatency(micros() - start_us);
+    
+    if (success) {
+        Serial.printf("✅ 文件写入成功: %s (%d bytes)\n", path, writer.bytesWritten());
+    } else {
+        Serial.printf("❌ 文件写入不完整: %s\n", path);
+    }
+    
+    logOperation("WRITE", path, success, writer.bytesWritten());
+    return success;
+}
+
+bool FileSystemV3::readRecord(const char* path, JsonDocument& doc, const JsonDocument* filter) {
+    if (!fs_available) {
+        Serial.println("❌ 文件系统不可用");
+        return false;
+    }
+    
+    StorageFileV3* file = backend->open(path, V3_OPEN_READ);
+    if (!file) {
+        Serial.printf("❌ 无法打开文件: %s\n", path);
+        logOperation("READ_FAIL", path, false);
+        return false;
+    }
+    
+    // 解析文件头，没有文件头的是旧版JSON文件
+    uint8_t header[V3_RECORD_HEADER_SIZE];
+    uint8_t format = V3_RECORD_FORMAT_JSON;
+    bool legacy = true;
+    if (file->read(header, sizeof(header)) == sizeof(header) &&
+        header[0] == V3_RECORD_MAGIC_0 && header[1] == V3_RECORD_MAGIC_1) {
+        if (header[2] > V3_RECORD_VERSION) {
+            Serial.printf("❌ 不支持的记录版本: %s (v%d)\n", path, header[2]);
+            delete file;
+            return false;
+        }
+        format = header[3];
+        legacy = false;
+    } else {
+        file->seek(0);
+    }
+    
+    StorageReaderV3 reader(file);
+    DeserializationError error;
+    if (filter) {
+        DeserializationOption::Filter field_filter(*filter);
+        error = (format == V3_RECORD_FORMAT_MSGPACK)
+            ? deserializeMsgPack(doc, reader, field_filter)
+            : deserializeJson(doc, reader, field_filter);
+    } else {
+        error = (format == V3_RECORD_FORMAT_MSGPACK)
+            ? deserializeMsgPack(doc, reader)
+            : deserializeJson(doc, reader);
+    }
+    delete file;
+    
+    if (error) {
+        Serial.printf("❌ 记录解析失败: %s, 错误: %s\n", 
+                     path, error.c_str());
+        return false;
+    }
+    
+    logOperation("READ", path, true);
+    
+    // 旧格式或编码与当前配置不一致时就地迁移
+    if (!filter && (legacy || format != V3_RECORD_FORMAT)) {
+        Serial.printf("🔄 迁移记录格式: %s\n", path);
+        writeRecord(path, doc);
+    }
+    
     return true;
 }
 
 size_t FileSystemV3::getTotalBytes() {
     if (!fs_available) return 0;
-    return SPIFFS.totalBytes();
+    return backend->totalBytes();
 }
 
 size_t FileSystemV3::getUsedBytes() {
     if (!fs_available) return 0;
-    return SPIFFS.usedBytes();
+    return backend->usedBytes();
 }
 
 size_t FileSystemV3::getFreeBytes() {
     if (!fs_available) return 0;
-    return getTotalBytes() - getUsedBytes();
+    size_t total = getTotalBytes();
+    size_t used = getUsedBytes();
+    return used < total ? total - used : 0;
 }
 
 float FileSystemV3::getUsagePercent() {
@@ -215,36 +391,89 @@ float FileSystemV3::getUsagePercent() {
 
 void FileSystemV3::formatFileSystem() {
     Serial.println("⚠️ 格式化文件系统...");
-    SPIFFS.format();
+    if (!backend) return;
+    backend->format();
+    if (trace_io_mutex) xSemaphoreTake(trace_io_mutex, portMAX_DELAY);
+    trace_log.begin(backend, V3_LOG_FILE);
+    if (trace_io_mutex) xSemaphoreGive(trace_io_mutex);
     Serial.println("✅ 文件系统格式化完成");
 }
 
-void FileSystemV3::cleanupOldFiles(int keep_days) {
-    Serial.printf("🧹 清理 %d 天前的旧文件...\n", keep_days);
+// 清理时使用的每日明细文件信息
+struct RetentionFileV3 {
+    int32_t epoch_day;
+    size_t size;
+};
+
+static void collectDailyFile(const char* path, size_t size, void* ctx) {
+    int32_t epoch_day = FileSystemV3::parseDailyDataPath(path);
+    if (epoch_day < 0) return;
+    std::vector<RetentionFileV3>* files = (std::vector<RetentionFileV3>*)ctx;
+    RetentionFileV3 file = { epoch_day, size };
+    files->push_back(file);
+}
+
+retention_result_t FileSystemV3::cleanupOldFiles(int keep_days, size_t byte_budget,
+                                                 retention_guard_cb_t guard, void* ctx) {
+    retention_result_t result = { 0, 0, 0, 0 };
+    if (!fs_available) return result;
     
-    // 获取当前时间戳
-    time_t now = time(nullptr);
-    time_t cutoff_time = now - (keep_days * 24 * 60 * 60);
+    uint32_t start_ms = millis();
     
-    // 列出所有每日数据文件
-    std::vector<String> files = listFiles("/");
-    int deleted_count = 0;
-    
-    for (const String& filename : files) {
-        if (filename.startsWith("/daily_") && filename.endsWith(".json")) {
-            // 从文件名提取日期并检查是否过期
-            // 文件名格式: /daily_YYYY-MM-DD.json
-            String date_part = filename.substring(7, 17); // 提取YYYY-MM-DD
-
-            // 简单的日期比较（这里可以改进为更精确的日期解析）
-            if (date_part.length() == 10) {
-                // 暂时保留所有文件，不删除
-                Serial.printf("保留历史文件: %s\n", filename.c_str());
-            }
-        }
+    // 文件名即日期，按日期升序排列后从最早的开始处理
+    std::vector<RetentionFileV3> files;
+    backend->list("/", collectDailyFile, &files);
+    std::sort(files.begin(), files.end(),
+              [](const RetentionFileV3& a, const RetentionFileV3& b) { return a.epoch_day < b.epoch_day; });
+    
+    size_t daily_bytes = 0;
+    for (const RetentionFileV3& file : files) {
+        daily_bytes += file.size;
+    }
+    
+    // 时间无效时日期不可信，只按容量清理
+    int32_t today = DataUtilsV3::getEpochDay();
+    bool age_valid = ntpTimeV3.isValidTime();
+    int32_t newest_removable = today - V3_RETENTION_MIN_DAYS;
+    int32_t age_cutoff = today - (keep_days < V3_RETENTION_MIN_DAYS ? V3_RETENTION_MIN_DAYS : keep_days);
+    
+    refreshFillLevel();
+    size_t total = getTotalBytes();
+    size_t used = getUsedBytes();
+    size_t low_water = (size_t)(total * (V3_FS_LOW_WATER_PERCENT / 100.0f));
+    bool over_high_water = isAboveHighWater();
+    
+    char path[V3_DAILY_PATH_SIZE];
+    for (const RetentionFileV3& file : files) {
+        bool expired = age_valid && file.epoch_day <= age_cutoff;
+        bool over_budget = daily_bytes > byte_budget;
+        bool over_fill = over_high_water && used > low_water;
+        if (!expired && !over_budget && !over_fill) break;
+        if (file.epoch_day > newest_removable) break;
+        
+        if (guard && !guard(file.epoch_day, ctx)) continue;
+        
+        formatDailyDataPath(file.epoch_day, path, sizeof(path));
+        if (!backend->remove(path)) continue;
+        logOperation("DELETE", path, true);
+        
+        result.files_deleted++;
+        result.bytes_freed += file.size;
+        daily_bytes -= file.size;
+        used = used > file.size ? used - file.size : 0;
     }
     
-    Serial.printf("✅ 清理完成，删除了 %d 个旧文件\n", deleted_count);
+    result.files_kept = files.size() - result.files_deleted;
+    result.bytes_kept = daily_bytes;
+    refreshFillLevel();
+    
+    if (result.files_deleted > 0) {
+        trace(V3_TRACE_RETENTION, result.files_deleted, result.bytes_freed);
+        Serial.printf("🧹 保留策略: 删除 %d 个明细 (%lu bytes), 剩余 %d 个 (%lu bytes), 使用率 %.1f%%, 耗时 %lu ms\n",
+                     result.files_deleted, result.bytes_freed, result.files_kept,
+                     result.bytes_kept, fill_percent, millis() - start_ms);
+    }
+    return result;
 }
 
 void FileSystemV3::printFileSystemInfo() {
@@ -254,6 +483,7 @@ void FileSystemV3::printFileSystemInfo() {
     }
     
     Serial.println("📊 文件系统信息:");
+    Serial.printf("   存储后端: %s\n", backend->name());
     Serial.printf("   总容量: %d bytes (%.1f KB)\n", 
                  getTotalBytes(), getTotalBytes() / 1024.0f);
     Serial.printf("   已使用: %d bytes (%.1f KB)\n", 
@@ -275,12 +505,33 @@ void FileSystemV3::printFileSystemInfo() {
     }
 }
 
-String FileSystemV3::getDailyDataPath(const String& date) {
-    return V3_DAILY_DATA_PREFIX + date + ".json";
+void FileSystemV3::formatDailyDataPath(int32_t epoch_day, char* buf, size_t len) {
+    char date_str[16];
+    DataUtilsV3::formatEpochDay(epoch_day, date_str, sizeof(date_str));
+    snprintf(buf, len, V3_DAILY_DATA_PREFIX "%s.json", date_str);
+}
+
+int32_t FileSystemV3::parseDailyDataPath(const char* path) {
+    // 期望格式: /daily_YYYY-MM-DD.json
+    const size_t prefix_len = sizeof(V3_DAILY_DATA_PREFIX) - 1;
+    if (!path || strncmp(path, V3_DAILY_DATA_PREFIX, prefix_len) != 0) return -1;
+    const char* date = path + prefix_len;
+    if (strlen(date) != 15 || strcmp(date + 10, ".json") != 0) return -1;
+    
+    char date_str[11];
+    memcpy(date_str, date, 10);
+    date_str[10] = '\0';
+    return DataUtilsV3::dateToEpochDay(date_str);
+}
+
+String FileSystemV3::getDailyDataPath(int32_t epoch_day) {
+    char path[V3_DAILY_PATH_SIZE];
+    formatDailyDataPath(epoch_day, path, sizeof(path));
+    return String(path);
 }
 
 String FileSystemV3::getCurrentDailyDataPath() {
-    return getDailyDataPath(getDateString());
+    return getDailyDataPath(DataUtilsV3::getEpochDay());
 }
 
 void FileSystemV3::createDefaultDirectories() {
@@ -295,10 +546,10 @@ void FileSystemV3::createDefaultDirectories() {
         config["volume"] = 80;
         config["brightness"] = 70;
         config["difficulty"] = "normal";
-        config["auto_sleep"] = false; // V3.0暂不支持
-        config["created_time"] = getDateString();
+        config["auto_sleep"] = true;
+        config["created_time"] = DataUtilsV3::getCurrentDateString();
         
-        if (writeJson(V3_CONFIG_FILE, config)) {
+        if (writeRecord(V3_CONFIG_FILE, config)) {
             Serial.println("✅ 创建默认配置文件");
         } else {
             Serial.println("❌ 创建默认配置文件失败");
@@ -312,9 +563,9 @@ void FileSystemV3::createDefaultDirectories() {
         stats["total_jumps"] = 0;
         stats["total_time"] = 0;
         stats["best_score"] = 0;
-        stats["created_time"] = getDateString();
+        stats["created_time"] = DataUtilsV3::getCurrentDateString();
         
-        if (writeJson(V3_STATS_FILE, stats)) {
+        if (writeRecord(V3_STATS_FILE, stats)) {
             Serial.println("✅ 创建默认统计文件");
         } else {
             Serial.println("❌ 创建默认统计文件失败");
@@ -322,47 +573,155 @@ void FileSystemV3::createDefaultDirectories() {
     }
 }
 
-String FileSystemV3::getDateString(int days_offset) {
-    // 简单的日期字符串生成（实际项目中应该使用RTC或NTP）
-    // 暂时使用启动后的天数计算
-    static uint32_t start_day = 0;
-    if (start_day == 0) {
-        start_day = millis() / (24 * 60 * 60 * 1000UL); // 启动时的天数
+void FileSystemV3::logOperation(const char* operation, const char* path, bool success, uint32_t bytes) {
+    // 写入类操作记入事件日志（读取成功太频繁，不记录）
+    trace_event_v3_t event = V3_TRACE_NONE;
+    if (strcmp(operation, "WRITE") == 0 || strcmp(operation, "APPEND") == 0) {
+        event = success ? V3_TRACE_FILE_WRITE : V3_TRACE_FILE_WRITE_FAIL;
+    } else if (strcmp(operation, "WRITE_FAIL") == 0) {
+        event = V3_TRACE_FILE_WRITE_FAIL;
+    } else if (strcmp(operation, "READ_FAIL") == 0) {
+        event = V3_TRACE_FILE_READ_FAIL;
+    } else if (strcmp(operation, "DELETE") == 0 && success) {
+        event = V3_TRACE_FILE_DELETE;
+    } else if (strcmp(operation, "RENAME") == 0 && success) {
+        event = V3_TRACE_FILE_RENAME;
+    }
+    if (event != V3_TRACE_NONE) {
+        trace(event, TraceLogV3::fileId(path), bytes);
+    }
+    
+    if (strcmp(operation, "WRITE") == 0 || strcmp(operation, "DELETE") == 0) {
+        Serial.printf("📝 文件操作: %s %s %s\n", 
+                     operation, 
+                     path, 
+                     success ? "成功" : "失败");
     }
+}
 
-    uint32_t current_day = start_day + days_offset;
+void FileSystemV3::refreshFillLevel() {
+    fill_percent = getUsagePercent();
+    writes_since_fill = 0;
+}
 
-    // 生成简单的日期格式 (从2025-01-01开始)
-    uint32_t base_year = 2025;
-    uint32_t base_month = 1;
-    uint32_t base_day = 1;
+void FileSystemV3::recordWriteLatency(uint32_t elapsed_us) {
+    if (++writes_since_fill >= V3_FILL_SAMPLE_WRITES) {
+        refreshFillLevel();
+    }
+    
+    int bucket = (int)(fill_percent / (100.0f / V3_FILL_BUCKETS));
+    if (bucket < 0) bucket = 0;
+    if (bucket >= V3_FILL_BUCKETS) bucket = V3_FILL_BUCKETS - 1;
+    
+    write_latency_bucket_t& stats = write_latency[bucket];
+    stats.count++;
+    stats.total_us += elapsed_us;
+    if (elapsed_us > stats.max_us) stats.max_us = elapsed_us;
+}
 
-    uint32_t total_days = current_day;
-    uint32_t year = base_year + (total_days / 365);
-    uint32_t month = base_month + ((total_days % 365) / 30);
-    uint32_t day = base_day + ((total_days % 365) % 30);
+void FileSystemV3::resetWriteLatencyStats() {
+    memset(write_latency, 0, sizeof(write_latency));
+}
 
-    if (month > 12) {
-        year++;
-        month -= 12;
+void FileSystemV3::printWriteLatencyReport() {
+    Serial.printf("📈 记录写入延迟 vs 使用率 (当前 %.1f%%, 高水位 %.0f%%):\n",
+                 fill_percent, V3_FS_HIGH_WATER_PERCENT);
+    Serial.println("   使用率    次数    平均(μs)  最大(μs)");
+    
+    const int step = 100 / V3_FILL_BUCKETS;
+    bool any = false;
+    for (int i = 0; i < V3_FILL_BUCKETS; i++) {
+        const write_latency_bucket_t& stats = write_latency[i];
+        if (stats.count == 0) continue;
+        Serial.printf("   %3d-%3d%%  %6lu  %8lu  %8lu\n",
+                     i * step, (i + 1) * step, stats.count,
+                     stats.total_us / stats.count, stats.max_us);
+        any = true;
     }
-    if (day > 31) {
-        month++;
-        day -= 31;
+    if (!any) {
+        Serial.println("   (暂无写入)");
     }
+}
 
-    char date_str[11];
-    snprintf(date_str, sizeof(date_str), "%04d-%02d-%02d", year, month, day);
+void FileSystemV3::trace(trace_event_v3_t event, uint16_t arg0, uint32_t arg1) {
+    if (!trace_log.isOpen()) return;
+    
+    uint8_t flags = 0;
+    uint32_t timestamp;
+    if (ntpTimeV3.isValidTime()) {
+        timestamp = (uint32_t)ntpTimeV3.getCurrentTimestamp();
+        flags |= V3_TRACE_FLAG_EPOCH;
+    } else {
+        timestamp = millis();
+    }
+    
+    portENTER_CRITICAL(&trace_mux);
+    trace_log.append(event, flags, timestamp, arg0, arg1);
+    portEXIT_CRITICAL(&trace_mux);
+}
 
-    return String(date_str);
+bool FileSystemV3::flushTrace() {
+    if (!fs_available || trace_log.pendingCount() == 0) return true;
+    
+    // 取出和写入在同一把锁内，两个调用方不会交错写环形文件或打乱序号顺序
+    trace_record_v3_t records[V3_TRACE_BUFFER_SIZE];
+    if (!trace_io_mutex) return false;
+    xSemaphoreTake(trace_io_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&trace_mux);
+    size_t count = trace_log.takePending(records, V3_TRACE_BUFFER_SIZE);
+    portEXIT_CRITICAL(&trace_mux);
+    
+    bool ok = trace_log.writeRecords(records, count);
+    xSemaphoreGive(trace_io_mutex);
+    return ok;
 }
 
-void FileSystemV3::logOperation(const String& operation, const String& path, bool success) {
-    // 简单的操作日志（可选实现）
-    if (operation == "WRITE" || operation == "DELETE") {
-        Serial.printf("📝 文件操作: %s %s %s\n", 
-                     operation.c_str(), 
-                     path.c_str(), 
-                     success ? "成功" : "失败");
+void FileSystemV3::printTraceLog(uint16_t max_records) {
+    flushTrace();
+    
+    std::vector<trace_record_v3_t> records;
+    if (!trace_io_mutex) return;
+    xSemaphoreTake(trace_io_mutex, portMAX_DELAY);
+    bool ok = trace_log.readAll(&records);
+    xSemaphoreGive(trace_io_mutex);
+    if (!ok) {
+        Serial.println("❌ 事件日志读取失败");
+        return;
+    }
+    
+    Serial.printf("📝 事件日志: %d/%lu 条, 丢弃 %lu 条（显示最近 %d 条）\n",
+                 records.size(), trace_log.capacity(), trace_log.dropped(), max_records);
+    size_t first = records.size() > max_records ? records.size() - max_records : 0;
+    char line[128];
+    for (size_t i = first; i < records.size(); i++) {
+        TraceLogV3::formatRecord(records[i], line, sizeof(line));
+        Serial.printf("   %s\n", line);
+    }
+}
+
+void FileSystemV3::dumpTraceLogHex() {
+    flushTrace();
+    
+    if (!trace_io_mutex) return;
+    xSemaphoreTake(trace_io_mutex, portMAX_DELAY);
+    StorageFileV3* file = backend ? backend->open(V3_LOG_FILE, V3_OPEN_READ) : nullptr;
+    if (!file) {
+        xSemaphoreGive(trace_io_mutex);
+        Serial.println("❌ 事件日志不存在");
+        return;
+    }
+    
+    // 每行32字节，首尾标记便于主机端从串口日志中截取
+    Serial.println("TRACE_BEGIN");
+    uint8_t buf[32];
+    size_t n;
+    while ((n = file->read(buf, sizeof(buf))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            Serial.printf("%02x", buf[i]);
+        }
+        Serial.println();
     }
+    Serial.println("TRACE_END");
+    delete file;
+    xSemaphoreGive(trace_io_mutex);
 }
@@ -2,13 +2,25 @@
 #include "v3/data_manager_v3.h"
 #include "v3/ui_views_v3.h"
 #include "jumping_rocket_simple.h"
+#include "dlog.h"
 
 // V3.0游戏集成状态
 static bool v3_game_integration_active = false;
 static bool v3_ui_mode_active = false;
+static volatile bool v3_setup_finished = false;
 static uint32_t v3_game_start_time = 0;
 static game_difficulty_t v3_current_difficulty = DIFFICULTY_NORMAL;
 
+// V3.0 UI循环：按键事件队列和延迟统计
+typedef struct {
+    button_event_t event;
+    uint32_t detect_us;
+} v3_ui_event_t;
+
+static QueueHandle_t v3_ui_event_queue = NULL;
+static v3_ui_latency_stats_t v3_ui_latency = {};
+static portMUX_TYPE v3_ui_latency_mux = portMUX_INITIALIZER_UNLOCKED;
+
 // V3.0游戏集成初始化
 bool initGameIntegrationV3() {
     Serial.println("🎮 初始化V3.0游戏集成...");
@@ -18,6 +30,14 @@ bool initGameIntegrationV3() {
         return false;
     }
     
+    if (!v3_ui_event_queue) {
+        v3_ui_event_queue = xQueueCreate(V3_UI_EVENT_QUEUE_SIZE, sizeof(v3_ui_event_t));
+        if (!v3_ui_event_queue) {
+            Serial.println("❌ V3.0 UI事件队列创建失败");
+            return false;
+        }
+    }
+    
     v3_game_integration_active = true;
     v3_ui_mode_active = false;
     
@@ -25,6 +45,14 @@ bool initGameIntegrationV3() {
     return true;
 }
 
+void markV3SetupFinished() {
+    v3_setup_finished = true;
+}
+
+bool isV3SetupPending() {
+    return !v3_setup_finished;
+}
+
 // 检查是否应该进入V3.0 UI模式
 bool shouldEnterV3UIMode() {
     // 在待机状态且V3.0功能启用时进入UI模式
@@ -59,6 +87,7 @@ void enterV3UIMode() {
     if (uiManagerV3) {
         Serial.println("🎨 切换到主菜单视图");
         uiManagerV3->switchToView(UI_VIEW_MAIN_MENU);
+        uiManagerV3->invalidate();  // 屏幕刚显示过其它界面，整屏重绘
         Serial.printf("🎨 当前视图: %d\n", uiManagerV3->getCurrentView());
     } else {
         Serial.println("❌ UI管理器为空");
@@ -91,7 +120,7 @@ void updateUIV3() {
     }
 }
 
-void renderUIV3() {
+bool renderUIV3() {
     if (uiManagerV3) {
         // 添加调试信息
         static uint32_t last_debug_time = 0;
@@ -101,9 +130,10 @@ void renderUIV3() {
             last_debug_time = current_time;
         }
 
-        uiManagerV3->render();
+        return uiManagerV3->render();
     } else {
         Serial.println("ERROR: renderUIV3: UI manager is null");
+        return false;
     }
 }
 
@@ -134,10 +164,10 @@ void updateV3UIMode() {
 }
 
 // V3.0 UI模式渲染
-void renderV3UIMode() {
-    if (!v3_ui_mode_active || !uiManagerV3) return;
+bool renderV3UIMode() {
+    if (!v3_ui_mode_active || !uiManagerV3) return false;
 
-    renderUIV3();
+    return renderUIV3();
 }
 
 // V3.0 UI模式按钮处理
@@ -147,6 +177,99 @@ bool handleV3UIButton(button_event_t event) {
     return handleUIButtonV3(event);
 }
 
+// 投递按钮事件到UI循环
+bool postV3UIButton(button_event_t event, uint32_t detect_us) {
+    if (!v3_ui_event_queue || event == BUTTON_EVENT_NONE) return false;
+
+    v3_ui_event_t ui_event = { event, detect_us };
+    if (xQueueSend(v3_ui_event_queue, &ui_event, 0) != pdTRUE) {
+        portENTER_CRITICAL(&v3_ui_latency_mux);
+        v3_ui_latency.dropped++;
+        portEXIT_CRITICAL(&v3_ui_latency_mux);
+        Serial.println("⚠️ V3.0 UI事件队列已满，丢弃按键");
+        return false;
+    }
+    return true;
+}
+
+static void recordV3UILatency(uint32_t latency_us) {
+    portENTER_CRITICAL(&v3_ui_latency_mux);
+    v3_ui_latency.count++;
+    v3_ui_latency.last_us = latency_us;
+    v3_ui_latency.total_us += latency_us;
+    if (latency_us > v3_ui_latency.max_us) {
+        v3_ui_latency.max_us = latency_us;
+    }
+    portEXIT_CRITICAL(&v3_ui_latency_mux);
+
+    DLOG_D("🎨 按键到画面延迟: %lu us\n", (unsigned long)latency_us);
+}
+
+// V3.0 UI循环：按键立即唤醒，否则按节拍刷新动画；按键、更新、渲染都在调用者（显示任务）中执行，
+// 不再依赖loop()的1秒间隔，也不会与渲染并发修改视图状态
+void runV3UIFrame() {
+    if (!v3_ui_event_queue) {
+        // 集成未初始化时退回固定10FPS渲染
+        renderV3UIMode();
+        delay(V3_UI_TICK_MS);
+        return;
+    }
+
+    v3_ui_event_t ui_event;
+    bool has_input = false;
+    uint32_t first_detect_us = 0;
+
+    if (xQueueReceive(v3_ui_event_queue, &ui_event, pdMS_TO_TICKS(V3_UI_TICK_MS)) == pdTRUE) {
+        do {
+            // 同一帧处理多个按键时以最早的按键计算延迟
+            if (!has_input) {
+                first_detect_us = ui_event.detect_us;
+                has_input = true;
+            }
+            if (!v3_ui_mode_active || !uiManagerV3) continue;
+
+            if (!handleUIButtonV3(ui_event.event)) {
+                // V3.0 UI没有处理事件，退出UI模式
+                Serial.println("🎨 V3.0 UI未处理按钮事件，退出UI模式");
+                exitV3UIMode();
+            }
+        } while (xQueueReceive(v3_ui_event_queue, &ui_event, 0) == pdTRUE);
+    }
+
+    if (!v3_ui_mode_active || !uiManagerV3) return;
+
+    updateV3UIMode();
+    if (!v3_ui_mode_active) return;  // 已开始游戏
+
+    if (renderV3UIMode() && has_input) {
+        recordV3UILatency(micros() - first_detect_us);
+    }
+}
+
+void getV3UILatencyStats(v3_ui_latency_stats_t* stats) {
+    if (!stats) return;
+    portENTER_CRITICAL(&v3_ui_latency_mux);
+    *stats = v3_ui_latency;
+    portEXIT_CRITICAL(&v3_ui_latency_mux);
+}
+
+void printV3UILatencyStats() {
+    v3_ui_latency_stats_t stats;
+    getV3UILatencyStats(&stats);
+
+    Serial.println("🎨 V3.0 UI按键到画面延迟:");
+    if (stats.count == 0) {
+        Serial.println("   暂无数据");
+    } else {
+        Serial.printf("   样本: %lu, 最近: %lu us, 平均: %lu us, 最大: %lu us\n",
+                     (unsigned long)stats.count, (unsigned long)stats.last_us,
+                     (unsigned long)(stats.total_us / stats.count), (unsigned long)stats.max_us);
+    }
+    if (stats.dropped > 0) {
+        Serial.printf("   丢弃按键: %lu\n", (unsigned long)stats.dropped);
+    }
+}
+
 // 开始V3.0游戏
 void startV3Game() {
     if (!v3_game_integration_active) return;
@@ -191,9 +314,9 @@ void onV3GameComplete() {
             
             // 显示会话结果
             Serial.printf("   得分: %d 分\n", session.score);
-            Serial.printf("   卡路里: %.1f\n", session.calories);
-            Serial.printf("   平均频率: %.2f 次/秒\n", session.avg_frequency);
-            Serial.printf("   目标达成: %s\n", session.target_achieved ? "是" : "否");
+            Serial.printf("   卡路里: %.1f\n", session.getCalories());
+            Serial.printf("   平均频率: %.2f 次/秒\n", session.getAvgFrequency());
+            Serial.printf("   目标达成: %s\n", session.isTargetAchieved() ? "是" : "否");
         } else {
             Serial.println("❌ V3.0游戏数据保存失败");
         }
@@ -313,6 +436,7 @@ void reportV3SystemStatus() {
 
     // 显示统计信息
     printV3GameStats();
+    printV3UILatencyStats();
 }
 
 // V2.0游戏事件回调函数实现
@@ -372,14 +496,7 @@ void onV2JumpDetected(uint32_t jump_count, uint32_t game_time) {
     if (!v3_game_integration_active) return;
 
     // 这里可以实时更新V3.0的跳跃统计
-    // 暂时只记录日志，避免过多输出
-    static uint32_t last_log_time = 0;
-    uint32_t current_time = millis();
-
-    // 每5秒记录一次日志
-    if (current_time - last_log_time >= 5000) {
-        Serial.printf("📊 V3.0记录跳跃: %d次，游戏时间: %d秒\n",
-                     jump_count, game_time / 1000);
-        last_log_time = current_time;
-    }
+    // 暂时只记录日志，每5秒最多一条，避免过多输出
+    DLOG_RATE_I(5000, "📊 V3.0记录跳跃: %lu次，游戏时间: %lu秒\n",
+                jump_count, game_time / 1000);
 }
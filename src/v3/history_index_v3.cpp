@@ -0,0 +1,358 @@
+#include "v3/history_index_v3.h"
+#include <string.h>
+
+static void entry_add(history_index_entry_t* entry, const day_totals_v3_t& totals) {
+    entry->cum_jumps += totals.jumps;
+    entry->cum_duration += totals.duration;
+    entry->cum_calories_x10 += totals.calories_x10;
+    entry->cum_sessions += totals.sessions;
+    entry->cum_targets += totals.targets;
+}
+
+// 两条累计记录之差（uint32回绕减法，结果与真实差值一致）
+static void entry_diff(const history_index_entry_t& to, const history_index_entry_t& from,
+                       day_totals_v3_t* out) {
+    out->jumps = to.cum_jumps - from.cum_jumps;
+    out->duration = to.cum_duration - from.cum_duration;
+    out->calories_x10 = to.cum_calories_x10 - from.cum_calories_x10;
+    out->sessions = to.cum_sessions - from.cum_sessions;
+    out->targets = to.cum_targets - from.cum_targets;
+    out->best_score = 0;
+}
+
+HistoryIndexV3::HistoryIndexV3() : backend(nullptr) {
+    memset(&header, 0, sizeof(header));
+    memset(&last_entry, 0, sizeof(last_entry));
+}
+
+bool HistoryIndexV3::begin(StorageBackendV3* storage, const char* file_path) {
+    backend = storage;
+    path = file_path;
+    memset(&header, 0, sizeof(header));
+    memset(&last_entry, 0, sizeof(last_entry));
+    if (!backend) return false;
+
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_READ);
+    if (!file) return false;
+
+    history_index_header_t loaded;
+    bool valid = file->read((uint8_t*)&loaded, sizeof(loaded)) == sizeof(loaded) &&
+                 loaded.magic[0] == 'J' && loaded.magic[1] == 'I' &&
+                 loaded.version == V3_HISTORY_INDEX_VERSION &&
+                 loaded.entry_size == sizeof(history_index_entry_t) &&
+                 loaded.count <= V3_HISTORY_INDEX_MAX_DAYS &&
+                 file->size() == sizeof(loaded) + (size_t)loaded.count * sizeof(history_index_entry_t);
+
+    if (valid) {
+        header = loaded;
+        if (header.count > 0) {
+            valid = readEntry(file, header.count - 1, &last_entry);
+        }
+    }
+    delete file;
+
+    if (!valid) {
+        memset(&header, 0, sizeof(header));
+        memset(&last_entry, 0, sizeof(last_entry));
+    }
+    return valid;
+}
+
+bool HistoryIndexV3::readEntry(StorageFileV3* file, uint32_t index, history_index_entry_t* entry) {
+    size_t offset = sizeof(history_index_header_t) + (size_t)index * sizeof(history_index_entry_t);
+    return file->seek(offset) &&
+           file->read((uint8_t*)entry, sizeof(*entry)) == sizeof(*entry);
+}
+
+bool HistoryIndexV3::writeEntry(StorageFileV3* file, uint32_t index, const history_index_entry_t& entry) {
+    size_t offset = sizeof(history_index_header_t) + (size_t)index * sizeof(history_index_entry_t);
+    return file->seek(offset) &&
+           file->write((const uint8_t*)&entry, sizeof(entry)) == sizeof(entry);
+}
+
+bool HistoryIndexV3::writeHeader(StorageFileV3* file) {
+    header.magic[0] = 'J';
+    header.magic[1] = 'I';
+    header.version = V3_HISTORY_INDEX_VERSION;
+    header.entry_size = sizeof(history_index_entry_t);
+    return file->seek(0) &&
+           file->write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+}
+
+bool HistoryIndexV3::setDay(uint32_t epoch_day, const day_totals_v3_t& totals) {
+    if (!backend) return false;
+
+    if (header.count > 0 && epoch_day < header.base_day) {
+        return prependDays(epoch_day, totals);
+    }
+
+    uint32_t index = header.count > 0 ? epoch_day - header.base_day : 0;
+    if (index >= V3_HISTORY_INDEX_MAX_DAYS) return false;
+
+    StorageFileV3* file = backend->open(path.c_str(), header.count > 0 ? V3_OPEN_UPDATE : V3_OPEN_WRITE);
+    if (!file) return false;
+
+    bool ok = true;
+    if (header.count == 0) {
+        // 新文件先写文件头，保证后续记录都是顺序追加（部分后端不支持越过文件末尾seek）
+        header.base_day = epoch_day;
+        memset(&last_entry, 0, sizeof(last_entry));
+        ok = writeHeader(file);
+    }
+
+    if (index >= header.count) {
+        // 追加：中间缺失的日期补上累计值不变的空记录
+        history_index_entry_t entry = last_entry;
+        entry.best_score = 0;
+        entry.flags = 0;
+        entry.reserved = 0;
+        for (uint32_t i = header.count; i < index && ok; i++) {
+            ok = writeEntry(file, i, entry);
+        }
+        entry_add(&entry, totals);
+        entry.best_score = totals.best_score;
+        entry.flags = totals.sessions > 0 ? V3_INDEX_FLAG_HAS_DATA : 0;
+        ok = ok && writeEntry(file, index, entry);
+
+        if (ok) {
+            header.count = index + 1;
+            last_entry = entry;
+            ok = writeHeader(file);
+        }
+    } else {
+        // 改写已有日期：求出差值后加到该日及之后所有记录
+        history_index_entry_t prev;
+        history_index_entry_t entry;
+        memset(&prev, 0, sizeof(prev));
+        ok = (index == 0 || readEntry(file, index - 1, &prev)) && readEntry(file, index, &entry);
+
+        day_totals_v3_t old_totals;
+        if (ok) entry_diff(entry, prev, &old_totals);
+
+        day_totals_v3_t delta;
+        delta.jumps = totals.jumps - old_totals.jumps;
+        delta.duration = totals.duration - old_totals.duration;
+        delta.calories_x10 = totals.calories_x10 - old_totals.calories_x10;
+        delta.sessions = totals.sessions - old_totals.sessions;
+        delta.targets = totals.targets - old_totals.targets;
+
+        for (uint32_t i = index; i < header.count && ok; i++) {
+            if (i != index) ok = readEntry(file, i, &entry);
+            if (!ok) break;
+            entry_add(&entry, delta);
+            if (i == index) {
+                entry.best_score = totals.best_score;
+                entry.flags = totals.sessions > 0 ? V3_INDEX_FLAG_HAS_DATA : 0;
+            }
+            ok = writeEntry(file, i, entry);
+            if (i == header.count - 1) last_entry = entry;
+        }
+    }
+
+    file->flush();
+    delete file;
+    return ok;
+}
+
+bool HistoryIndexV3::prependDays(uint32_t epoch_day, const day_totals_v3_t& totals) {
+    uint32_t shift = header.base_day - epoch_day;
+    if (header.count + shift > V3_HISTORY_INDEX_MAX_DAYS) return false;
+
+    // 整体重写到临时文件再替换
+    std::string tmp_path = path + ".tmp";
+    StorageFileV3* src = backend->open(path.c_str(), V3_OPEN_READ);
+    StorageFileV3* dst = backend->open(tmp_path.c_str(), V3_OPEN_WRITE);
+    if (!src || !dst) {
+        delete src;
+        delete dst;
+        return false;
+    }
+
+    history_index_header_t old_header = header;
+    header.base_day = epoch_day;
+    header.count = old_header.count + shift;
+    bool ok = writeHeader(dst);
+
+    history_index_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry_add(&entry, totals);
+    entry.best_score = totals.best_score;
+    entry.flags = totals.sessions > 0 ? V3_INDEX_FLAG_HAS_DATA : 0;
+    ok = ok && writeEntry(dst, 0, entry);
+
+    entry.best_score = 0;
+    entry.flags = 0;
+    for (uint32_t i = 1; i < shift && ok; i++) {
+        ok = writeEntry(dst, i, entry);
+    }
+
+    for (uint32_t i = 0; i < old_header.count && ok; i++) {
+        ok = readEntry(src, i, &entry);
+        if (!ok) break;
+        entry_add(&entry, totals);
+        ok = writeEntry(dst, i + shift, entry);
+        last_entry = entry;
+    }
+
+    delete src;
+    dst->flush();
+    delete dst;
+
+    if (!ok || !backend->rename(tmp_path.c_str(), path.c_str())) {
+        backend->remove(tmp_path.c_str());
+        begin(backend, path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool HistoryIndexV3::getDay(uint32_t epoch_day, day_totals_v3_t* out) {
+    if (!backend || header.count == 0 ||
+        epoch_day < header.base_day || epoch_day > lastDay()) {
+        return false;
+    }
+
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_READ);
+    if (!file) return false;
+
+    uint32_t index = epoch_day - header.base_day;
+    history_index_entry_t prev;
+    history_index_entry_t entry;
+    memset(&prev, 0, sizeof(prev));
+    bool ok = (index == 0 || readEntry(file, index - 1, &prev)) && readEntry(file, index, &entry);
+    delete file;
+
+    if (ok) {
+        entry_diff(entry, prev, out);
+        out->best_score = entry.best_score;
+    }
+    return ok;
+}
+
+bool HistoryIndexV3::hasData(uint32_t epoch_day) {
+    day_totals_v3_t totals;
+    return getDay(epoch_day, &totals) && totals.sessions > 0;
+}
+
+uint32_t HistoryIndexV3::getDays(uint32_t first_day, uint32_t count, day_totals_v3_t* out) {
+    if (!backend || header.count == 0 || count == 0 ||
+        first_day < header.base_day || first_day > lastDay()) {
+        return 0;
+    }
+    uint32_t index = first_day - header.base_day;
+    if (count > header.count - index) count = header.count - index;
+
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_READ);
+    if (!file) return 0;
+
+    history_index_entry_t prev;
+    history_index_entry_t entry;
+    memset(&prev, 0, sizeof(prev));
+    if ((index > 0 && !readEntry(file, index - 1, &prev)) ||
+        !file->seek(sizeof(history_index_header_t) + (size_t)index * sizeof(history_index_entry_t))) {
+        delete file;
+        return 0;
+    }
+
+    uint32_t read = 0;
+    for (; read < count; read++) {
+        if (file->read((uint8_t*)&entry, sizeof(entry)) != sizeof(entry)) break;
+        entry_diff(entry, prev, &out[read]);
+        out[read].best_score = entry.best_score;
+        prev = entry;
+    }
+    delete file;
+    return read;
+}
+
+bool HistoryIndexV3::getRange(uint32_t first_day, uint32_t last_day, day_totals_v3_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!backend) return false;
+    if (header.count == 0) return true;
+
+    // 裁剪到索引覆盖范围
+    if (first_day < header.base_day) first_day = header.base_day;
+    if (last_day > lastDay()) last_day = lastDay();
+    if (first_day > last_day) return true;
+
+    history_index_entry_t before;
+    history_index_entry_t end = last_entry;
+    memset(&before, 0, sizeof(before));
+
+    uint32_t first_index = first_day - header.base_day;
+    uint32_t last_index = last_day - header.base_day;
+    bool need_file = first_index > 0 || last_index != header.count - 1;
+    if (need_file) {
+        StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_READ);
+        if (!file) return false;
+        bool ok = (first_index == 0 || readEntry(file, first_index - 1, &before)) &&
+                  (last_index == header.count - 1 || readEntry(file, last_index, &end));
+        delete file;
+        if (!ok) return false;
+    }
+
+    entry_diff(end, before, out);
+    return true;
+}
+
+bool HistoryIndexV3::trimBefore(uint32_t epoch_day) {
+    if (!backend || header.count == 0 || epoch_day <= header.base_day) return true;
+    if (epoch_day > lastDay()) return clear();
+
+    uint32_t drop = epoch_day - header.base_day;
+    std::string tmp_path = path + ".tmp";
+    StorageFileV3* src = backend->open(path.c_str(), V3_OPEN_READ);
+    StorageFileV3* dst = backend->open(tmp_path.c_str(), V3_OPEN_WRITE);
+    if (!src || !dst) {
+        delete src;
+        delete dst;
+        return false;
+    }
+
+    history_index_entry_t base;
+    bool ok = readEntry(src, drop - 1, &base);
+
+    header.base_day = epoch_day;
+    header.count -= drop;
+    ok = ok && writeHeader(dst);
+
+    history_index_entry_t entry;
+    for (uint32_t i = 0; i < header.count && ok; i++) {
+        ok = readEntry(src, i + drop, &entry);
+        if (!ok) break;
+        entry.cum_jumps -= base.cum_jumps;
+        entry.cum_duration -= base.cum_duration;
+        entry.cum_calories_x10 -= base.cum_calories_x10;
+        entry.cum_sessions -= base.cum_sessions;
+        entry.cum_targets -= base.cum_targets;
+        ok = writeEntry(dst, i, entry);
+        last_entry = entry;
+    }
+
+    delete src;
+    dst->flush();
+    delete dst;
+
+    if (!ok || !backend->rename(tmp_path.c_str(), path.c_str())) {
+        backend->remove(tmp_path.c_str());
+        begin(backend, path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool HistoryIndexV3::clear() {
+    if (!backend) return false;
+    memset(&header, 0, sizeof(header));
+    memset(&last_entry, 0, sizeof(last_entry));
+
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_WRITE);
+    if (!file) return false;
+    bool ok = writeHeader(file);
+    delete file;
+    return ok;
+}
+
+size_t HistoryIndexV3::fileSize() const {
+    return sizeof(history_index_header_t) + (size_t)header.count * sizeof(history_index_entry_t);
+}
@@ -5,6 +5,7 @@
 #include "v3/file_system_v3.h"
 #include "v3/data_manager_v3.h"
 #include "v3/data_models_v3.h"
+#include "v3/ntp_time_v3.h"
 #include "v3/ui_views_v3.h"
 #include "v3/game_integration_v3.h"
 
@@ -42,9 +43,6 @@ bool initializeV3System() {
         return false;
     }
 
-    // 生成演示数据（如果需要）
-    dataManagerV3.generateDemoData(7);
-
     // 初始化UI管理器
     Serial.println("🎨 初始化V3.0 UI管理器...");
     extern U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2;
@@ -102,9 +100,9 @@ void handleV3GameSession(uint32_t jump_count, uint32_t duration) {
         
         // 显示会话结果
         Serial.printf("   得分: %d 分\n", session.score);
-        Serial.printf("   卡路里: %.1f\n", session.calories);
-        Serial.printf("   平均频率: %.2f 次/秒\n", session.avg_frequency);
-        Serial.printf("   目标达成: %s\n", session.target_achieved ? "是" : "否");
+        Serial.printf("   卡路里: %.1f\n", session.getCalories());
+        Serial.printf("   平均频率: %.2f 次/秒\n", session.getAvgFrequency());
+        Serial.printf("   目标达成: %s\n", session.isTargetAchieved() ? "是" : "否");
         
         // 显示今日统计
         Serial.printf("📊 今日统计:\n");
@@ -206,6 +204,9 @@ void printV3SystemInfo() {
 void testV3System() {
     Serial.println("🧪 V3.0系统测试开始...");
 
+    // 生成演示数据（如果需要）：会写入历史记录，只在系统测试（完整启动或串口命令selftest）时执行
+    dataManagerV3.generateDemoData(7);
+
     // 调用外部完整测试套件
     extern void runV3SystemTests();
     runV3SystemTests();
@@ -240,17 +241,20 @@ void loopV3() {
     // 更新状态机
     updateV3State();
 
-    // 更新UI（如果在UI模式）
-    if (V3_IS_IN_UI()) {
-        V3_UPDATE_UI();
-    }
+    // 游戏进行中暂停后台压缩等重活，空闲时由写回任务执行
+    dataManagerV3.setBackgroundWorkAllowed(current_state == GAME_STATE_IDLE);
+    ntpTimeV3.setSyncAllowed(current_state == GAME_STATE_IDLE);
+
+    // 深度睡眠策略跟随系统配置
+    const SystemConfigV3& config = dataManagerV3.getSystemConfig();
+    deep_sleep_set_policy(config.auto_sleep, config.sleep_timeout);
 
-    // 定期保存数据（每分钟）
-    static uint32_t last_save_time = 0;
+    // 定期检查跨天（数据落盘由写回任务负责）
+    static uint32_t last_rollover_check = 0;
     uint32_t current_time = millis();
-    if (current_time - last_save_time > 60000) { // 60秒
-        dataManagerV3.saveCurrentDayData();
-        last_save_time = current_time;
+    if (current_time - last_rollover_check > 60000) { // 60秒
+        dataManagerV3.checkDayRollover();
+        last_rollover_check = current_time;
     }
 
     // 定期系统状态报告（每10分钟）
@@ -261,13 +265,16 @@ void loopV3() {
     }
 }
 
-// V3.0 关闭处理
-void shutdownV3System() {
+// V3.0 关闭处理：写回任务仍在写文件时返回false，不卸载文件系统（调用方可重试）
+bool shutdownV3System() {
     if (v3_system_initialized) {
         Serial.println("🔄 V3.0系统关闭中...");
 
         // 保存所有数据
-        dataManagerV3.deinit();
+        if (!dataManagerV3.deinit()) {
+            Serial.println("⚠️ V3.0数据未能写出，保持挂载");
+            return false;
+        }
         fileSystemV3.deinit();
 
         // 清理UI管理器
@@ -278,6 +285,7 @@ void shutdownV3System() {
 
         Serial.println("✅ V3.0系统已关闭");
     }
+    return true;
 }
 
 // 兼容性函数：从V2.0游戏逻辑调用V3.0功能
@@ -0,0 +1,353 @@
+#include "v3/ntp_time_v3.h"
+#include "v3/file_system_v3.h"
+#include <ArduinoJson.h>
+#include <esp_timer.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
+
+// 全局NTP时间管理器实例
+NTPTimeV3 ntpTimeV3;
+
+NTPTimeV3::NTPTimeV3() :
+    initialized(false),
+    time_source(V3_TIME_SOURCE_NONE),
+    sync_requested(false),
+    sync_allowed(true),
+    task_stop(false),
+    task_handle(nullptr),
+    fs(nullptr),
+    last_sync_time(0),
+    last_sync_attempt(0),
+    last_persist_time(0),
+    sync_mux(portMUX_INITIALIZER_UNLOCKED),
+    sync_mono_us(0),
+    sync_epoch(0),
+    drift_ppm(0.0f),
+    sync_count(0),
+    sync_failures(0),
+    current_ntp_server("") {
+}
+
+NTPTimeV3::~NTPTimeV3() {
+    deinit();
+}
+
+bool NTPTimeV3::init(FileSystemV3* filesystem) {
+    if (initialized) return true;
+
+    Serial.println("🕐 初始化时间服务...");
+    fs = filesystem;
+
+    // 时区在启动时设置，不依赖NTP是否成功（POSIX TZ中UTC+8写作"UTC-8"）
+    char tz[16];
+    snprintf(tz, sizeof(tz), "UTC%d", -TIME_ZONE_OFFSET);
+    setenv("TZ", tz, 1);
+    tzset();
+
+    // 复位前已有时间（RTC计时延续）直接使用，否则从文件恢复上次保存的时间
+    time_t now = time(nullptr);
+    bool restored = loadPersistedTime();
+    if (now > NTP_VALID_EPOCH) {
+        time_source = V3_TIME_SOURCE_RTC;
+    } else if (restored) {
+        time_source = V3_TIME_SOURCE_RESTORED;
+    }
+    int64_t boot_mono_us = esp_timer_get_time();
+    time_t boot_epoch = time(nullptr);
+    portENTER_CRITICAL(&sync_mux);
+    sync_mono_us = boot_mono_us;
+    sync_epoch = boot_epoch;
+    portEXIT_CRITICAL(&sync_mux);
+
+    if (isValidTime()) {
+        Serial.printf("✅ 时间已恢复: %s (来源: %s, 漂移 %.1f ppm)\n",
+                     getCurrentDateTimeString().c_str(),
+                     getTimeSourceName(getTimeSource()), drift_ppm);
+    } else {
+        Serial.println("⚠️ 无可用时间，等待NTP同步（期间使用备用日期）");
+    }
+
+    if (strlen(V3_WIFI_SSID) == 0) {
+        Serial.println("⚠️ 未配置Wi-Fi（V3_WIFI_SSID），不进行NTP同步");
+    }
+
+    // 同步在后台任务中进行，启动流程不等待网络
+    sync_requested = strlen(V3_WIFI_SSID) > 0;
+    task_stop = false;
+    xTaskCreate(taskEntry, "v3_ntp_task", NTP_TASK_STACK_SIZE, this,
+                NTP_TASK_PRIORITY, &task_handle);
+    if (task_handle == NULL) {
+        Serial.println("⚠️ 时间服务任务创建失败，时间不会同步或保存");
+    }
+
+    initialized = true;
+    return true;
+}
+
+void NTPTimeV3::deinit() {
+    if (!initialized) return;
+
+    // 通知任务退出（同步中最多等待一个超时周期）
+    if (task_handle) {
+        task_stop = true;
+        for (int i = 0; i < (NTP_TIMEOUT * 2) / 10 && task_handle; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+    persistTime();
+    initialized = false;
+}
+
+void NTPTimeV3::taskEntry(void* param) {
+    NTPTimeV3* service = (NTPTimeV3*)param;
+    while (!service->task_stop) {
+        service->syncTimeIfNeeded();
+
+        // 定期保存时间，断电重启后日期最多回退一个保存周期
+        if (service->isValidTime() &&
+            millis() - service->last_persist_time >= NTP_PERSIST_INTERVAL) {
+            service->persistTime();
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(NTP_TASK_CHECK_MS));
+    }
+    service->task_handle = nullptr;
+    vTaskDelete(NULL);
+}
+
+void NTPTimeV3::syncTimeIfNeeded() {
+    if (strlen(V3_WIFI_SSID) == 0 || !sync_allowed) return;
+
+    unsigned long now = millis();
+    bool due;
+    if (sync_requested) {
+        due = true;
+    } else if (isTimeSynced()) {
+        due = now - last_sync_time >= NTP_SYNC_INTERVAL;
+    } else {
+        due = now - last_sync_attempt >= NTP_RETRY_INTERVAL;
+    }
+    if (!due) return;
+
+    sync_requested = false;
+    last_sync_attempt = now;
+    syncTime();
+}
+
+bool NTPTimeV3::syncTime() {
+    if (!connectWiFi(NTP_TIMEOUT)) {
+        Serial.println("⚠️ Wi-Fi连接超时，稍后重试NTP同步");
+        disconnectWiFi();
+        sync_failures++;
+        return false;
+    }
+
+    static const char* const servers[] = {
+        NTP_SERVER_PRIMARY, NTP_SERVER_SECONDARY, NTP_SERVER_BACKUP
+    };
+
+    bool success = false;
+    for (int attempt = 0; attempt < NTP_RETRY_COUNT && !success && !task_stop; attempt++) {
+        const char* server = servers[attempt % (sizeof(servers) / sizeof(servers[0]))];
+        success = connectToNTP(server) && waitForTimeSync(NTP_TIMEOUT);
+    }
+
+    if (success) {
+        int64_t mono_us = esp_timer_get_time();
+        time_t epoch = time(nullptr);
+        updateDrift(epoch, mono_us);
+
+        portENTER_CRITICAL(&sync_mux);
+        sync_mono_us = mono_us;
+        sync_epoch = epoch;
+        portEXIT_CRITICAL(&sync_mux);
+        last_sync_time = millis();
+        sync_count++;
+        time_source = V3_TIME_SOURCE_NTP;
+        persistTime();
+    } else {
+        sync_failures++;
+    }
+
+    // 同步完成后关闭Wi-Fi，不常驻射频
+    disconnectWiFi();
+    logTimeSync(success);
+    return success;
+}
+
+bool NTPTimeV3::connectWiFi(unsigned long timeout_ms) {
+    if (WiFi.status() == WL_CONNECTED) return true;
+
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(V3_WIFI_SSID, V3_WIFI_PASSWORD);
+
+    unsigned long start = millis();
+    while (WiFi.status() != WL_CONNECTED) {
+        if (task_stop || millis() - start >= timeout_ms) return false;
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    return true;
+}
+
+void NTPTimeV3::disconnectWiFi() {
+    sntp_stop();
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+}
+
+bool NTPTimeV3::connectToNTP(const char* server) {
+    current_ntp_server = server;
+    configTime(TIME_ZONE_OFFSET * 3600, DAYLIGHT_OFFSET * 3600, server);
+    return true;
+}
+
+bool NTPTimeV3::waitForTimeSync(unsigned long timeout_ms) {
+    unsigned long start = millis();
+    while (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED) {
+        if (task_stop || millis() - start >= timeout_ms) return false;
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    return time(nullptr) > NTP_VALID_EPOCH;
+}
+
+void NTPTimeV3::updateDrift(time_t epoch, int64_t mono_us) {
+    // 需要本次启动内的两次NTP同步，单调时钟与NTP时间的差值即为本地晶振漂移
+    if (!isTimeSynced()) return;
+
+    double mono_span = (mono_us - sync_mono_us) / 1000000.0;
+    if (mono_span < NTP_DRIFT_MIN_SPAN_S) return;
+
+    float measured = (float)(((double)(epoch - sync_epoch) - mono_span) / mono_span * 1000000.0);
+    if (measured > NTP_DRIFT_MAX_PPM || measured < -NTP_DRIFT_MAX_PPM) {
+        Serial.printf("⚠️ 时钟漂移测量异常: %.1f ppm，已忽略\n", measured);
+        return;
+    }
+
+    // 指数平滑，单次测量误差不会直接影响修正量
+    portENTER_CRITICAL(&sync_mux);
+    drift_ppm = (drift_ppm == 0.0f) ? measured : drift_ppm * 0.7f + measured * 0.3f;
+    portEXIT_CRITICAL(&sync_mux);
+}
+
+time_t NTPTimeV3::getCurrentTimestamp() {
+    if (!isValidTime()) return 0;
+
+    // 同步点和漂移由NTP任务更新，先在临界区内取快照再计算
+    portENTER_CRITICAL(&sync_mux);
+    int64_t mono_us = sync_mono_us;
+    float drift = drift_ppm;
+    portEXIT_CRITICAL(&sync_mux);
+
+    time_t now = time(nullptr);
+    if (drift != 0.0f) {
+        // 按漂移修正自上次同步（或启动）以来累积的误差
+        double elapsed_s = (esp_timer_get_time() - mono_us) / 1000000.0;
+        now += (time_t)(elapsed_s * drift / 1000000.0);
+    }
+    return now;
+}
+
+bool NTPTimeV3::getCurrentTime(struct tm* timeinfo) {
+    time_t now = getCurrentTimestamp();
+    if (now == 0) return false;
+    localtime_r(&now, timeinfo);
+    return true;
+}
+
+String NTPTimeV3::getCurrentDateTimeString() {
+    return formatTimestamp(getCurrentTimestamp());
+}
+
+bool NTPTimeV3::loadPersistedTime() {
+    if (!fs || !fs->isAvailable() || !fs->fileExists(V3_TIME_FILE)) return false;
+
+    JsonDocument doc;
+    if (!fs->readRecord(V3_TIME_FILE, doc)) return false;
+
+    float drift = doc["drift_ppm"] | 0.0f;
+    if (drift > NTP_DRIFT_MAX_PPM || drift < -NTP_DRIFT_MAX_PPM) {
+        drift = 0.0f;
+    }
+    portENTER_CRITICAL(&sync_mux);
+    drift_ppm = drift;
+    portEXIT_CRITICAL(&sync_mux);
+
+    time_t saved = (time_t)(doc["epoch"] | 0UL);
+    if (saved <= NTP_VALID_EPOCH) return false;
+
+    // RTC已有时间时只取漂移，不覆盖系统时间
+    if (time(nullptr) <= NTP_VALID_EPOCH) {
+        struct timeval tv = { saved, 0 };
+        settimeofday(&tv, nullptr);
+    }
+    return true;
+}
+
+bool NTPTimeV3::persistTime() {
+    if (!fs || !fs->isAvailable() || !isValidTime()) return false;
+
+    JsonDocument doc;
+    doc["epoch"] = (uint32_t)getCurrentTimestamp();
+    doc["drift_ppm"] = drift_ppm;
+    doc["source"] = (uint8_t)time_source;
+    if (isTimeSynced()) {
+        doc["last_sync"] = (uint32_t)sync_epoch;
+    }
+
+    last_persist_time = millis();
+    return fs->writeRecord(V3_TIME_FILE, doc);
+}
+
+void NTPTimeV3::logTimeSync(bool success) {
+    if (fs) {
+        if (success) {
+            fs->trace(V3_TRACE_NTP_SYNC, 0, (uint32_t)(int32_t)(drift_ppm * 10.0f));
+        } else {
+            fs->trace(V3_TRACE_NTP_FAIL, 0, sync_failures);
+        }
+    }
+    
+    if (success) {
+        Serial.printf("✅ NTP时间同步成功: %s (服务器 %s, 漂移 %.1f ppm)\n",
+                     getCurrentDateTimeString().c_str(),
+                     current_ntp_server.c_str(), drift_ppm);
+    } else {
+        Serial.printf("⚠️ NTP时间同步失败（累计 %lu 次），%lu 分钟后重试\n",
+                     sync_failures, NTP_RETRY_INTERVAL / 60000UL);
+    }
+}
+
+void NTPTimeV3::printTimeInfo() {
+    Serial.println("🕐 V3.0时间服务状态:");
+    Serial.printf("   当前时间: %s\n",
+                 isValidTime() ? getCurrentDateTimeString().c_str() : "未知");
+    Serial.printf("   时间来源: %s\n", getTimeSourceName(getTimeSource()));
+    Serial.printf("   时区: UTC%+d\n", TIME_ZONE_OFFSET);
+    Serial.printf("   同步: 成功 %lu 次, 失败 %lu 次", sync_count, sync_failures);
+    if (isTimeSynced()) {
+        Serial.printf(", 上次 %lu 秒前 (%s)", (millis() - last_sync_time) / 1000,
+                     current_ntp_server.c_str());
+    }
+    Serial.println();
+    Serial.printf("   时钟漂移: %.1f ppm\n", drift_ppm);
+}
+
+const char* NTPTimeV3::getTimeSourceName(time_source_v3_t source) {
+    switch (source) {
+        case V3_TIME_SOURCE_RESTORED: return "文件恢复";
+        case V3_TIME_SOURCE_RTC:      return "RTC";
+        case V3_TIME_SOURCE_NTP:      return "NTP";
+        default:                      return "无";
+    }
+}
+
+String NTPTimeV3::formatTimestamp(time_t timestamp) {
+    struct tm timeinfo;
+    localtime_r(&timestamp, &timeinfo);
+
+    char buf[20];
+    snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d",
+            timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+            timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+    return String(buf);
+}
@@ -0,0 +1,295 @@
+#include "v3/rollup_store_v3.h"
+#include <string.h>
+
+static void record_add(rollup_record_t* record, const rollup_record_t& other) {
+    record->jumps += other.jumps;
+    record->duration += other.duration;
+    record->calories_x10 += other.calories_x10;
+    record->sessions += other.sessions;
+    record->targets += other.targets;
+    record->active_days += other.active_days;
+    if (other.max_day_jumps > record->max_day_jumps) record->max_day_jumps = other.max_day_jumps;
+    if (other.best_score > record->best_score) record->best_score = other.best_score;
+}
+
+static void totals_add(day_totals_v3_t* totals, const rollup_record_t& record) {
+    totals->jumps += record.jumps;
+    totals->duration += record.duration;
+    totals->calories_x10 += record.calories_x10;
+    totals->sessions += record.sessions;
+    totals->targets += record.targets;
+    if (record.best_score > totals->best_score) totals->best_score = record.best_score;
+}
+
+RollupStoreV3::RollupStoreV3() : backend(nullptr) {
+    memset(&header, 0, sizeof(header));
+}
+
+bool RollupStoreV3::begin(StorageBackendV3* storage, const char* file_path) {
+    backend = storage;
+    path = file_path;
+    memset(&header, 0, sizeof(header));
+    weeks.clear();
+    months.clear();
+    if (!backend) return false;
+    if (!backend->exists(path.c_str())) return true;
+
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_READ);
+    if (!file) return false;
+
+    rollup_header_t loaded;
+    bool valid = file->read((uint8_t*)&loaded, sizeof(loaded)) == sizeof(loaded) &&
+                 loaded.magic[0] == 'J' && loaded.magic[1] == 'U' &&
+                 loaded.version == V3_ROLLUP_VERSION &&
+                 loaded.record_size == sizeof(rollup_record_t) &&
+                 file->size() == sizeof(loaded) +
+                     ((size_t)loaded.month_count + loaded.week_count) * sizeof(rollup_record_t);
+
+    if (valid) {
+        months.resize(loaded.month_count);
+        weeks.resize(loaded.week_count);
+        size_t month_bytes = months.size() * sizeof(rollup_record_t);
+        size_t week_bytes = weeks.size() * sizeof(rollup_record_t);
+        valid = (month_bytes == 0 || file->read((uint8_t*)months.data(), month_bytes) == month_bytes) &&
+                (week_bytes == 0 || file->read((uint8_t*)weeks.data(), week_bytes) == week_bytes);
+    }
+    delete file;
+
+    if (!valid) {
+        weeks.clear();
+        months.clear();
+        return false;
+    }
+    header = loaded;
+    return true;
+}
+
+bool RollupStoreV3::save() {
+    if (!backend) return false;
+
+    header.magic[0] = 'J';
+    header.magic[1] = 'U';
+    header.version = V3_ROLLUP_VERSION;
+    header.record_size = sizeof(rollup_record_t);
+    header.month_count = (uint16_t)months.size();
+    header.week_count = (uint16_t)weeks.size();
+
+    // 先写临时文件再改名，掉电时保留旧文件
+    std::string tmp_path = path + ".tmp";
+    StorageFileV3* file = backend->open(tmp_path.c_str(), V3_OPEN_WRITE);
+    if (!file) return false;
+
+    size_t month_bytes = months.size() * sizeof(rollup_record_t);
+    size_t week_bytes = weeks.size() * sizeof(rollup_record_t);
+    bool ok = file->write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              (month_bytes == 0 || file->write((const uint8_t*)months.data(), month_bytes) == month_bytes) &&
+              (week_bytes == 0 || file->write((const uint8_t*)weeks.data(), week_bytes) == week_bytes);
+    file->flush();
+    delete file;
+
+    if (!ok || !backend->rename(tmp_path.c_str(), path.c_str())) {
+        backend->remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t RollupStoreV3::fileSize() const {
+    return sizeof(rollup_header_t) + (months.size() + weeks.size()) * sizeof(rollup_record_t);
+}
+
+uint32_t RollupStoreV3::weekStart(uint32_t epoch_day) {
+    // 1970-01-01是周四
+    return epoch_day - (epoch_day + 3) % 7;
+}
+
+uint32_t RollupStoreV3::monthStart(uint32_t epoch_day) {
+    // epoch-day -> 公历日期（Howard Hinnant的civil_from_days）
+    int32_t z = (int32_t)epoch_day + 719468;
+    int32_t era = z / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint32_t d = doy - (153 * mp + 2) / 5 + 1;
+    return epoch_day - (d - 1);
+}
+
+bool RollupStoreV3::compactDayToWeek(HistoryIndexV3& index, uint32_t today) {
+    uint32_t first = header.day_tier_start;
+    if (!index.isEmpty() && (first == 0 || index.firstDay() > first)) first = index.firstDay();
+    if (first == 0) return false;
+
+    // 只压缩已完全超出日期层保留期的整周
+    uint32_t week_first = weekStart(first);
+    uint32_t week_last = week_first + 6;
+    if (week_last + V3_DAY_TIER_DAYS >= today) return false;
+
+    rollup_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.start_day = week_first;
+
+    day_totals_v3_t totals;
+    if (!index.getRange(first, week_last, &totals)) return false;
+    record.jumps = totals.jumps;
+    record.duration = totals.duration;
+    record.calories_x10 = totals.calories_x10;
+    record.sessions = totals.sessions;
+    record.targets = totals.targets;
+
+    // 最佳得分和活跃天数需要逐日读取（每周最多7天）
+    if (totals.sessions > 0) {
+        day_totals_v3_t days[7];
+        uint32_t read = index.getDays(first, week_last - first + 1, days);
+        for (uint32_t i = 0; i < read; i++) {
+            if (days[i].sessions == 0) continue;
+            record.active_days++;
+            if (days[i].best_score > record.best_score) record.best_score = days[i].best_score;
+            if (days[i].jumps > record.max_day_jumps) record.max_day_jumps = days[i].jumps;
+        }
+    }
+
+    // 先保存周汇总和新的日期层起点，再裁剪日期索引：中途掉电最多留下重复覆盖的日期
+    // （查询时按day_tier_start忽略，下次压缩补做裁剪），不会两层都丢失
+    uint32_t old_start = header.day_tier_start;
+    bool added = totals.sessions > 0;
+    if (added) weeks.push_back(record);
+    header.day_tier_start = week_last + 1;
+    if (!save()) {
+        if (added) weeks.pop_back();
+        header.day_tier_start = old_start;
+        return false;
+    }
+    finishTrim(index);
+    return true;
+}
+
+bool RollupStoreV3::finishTrim(HistoryIndexV3& index) {
+    if (index.isEmpty() || header.day_tier_start == 0 || index.firstDay() >= header.day_tier_start) {
+        return true;
+    }
+    return index.trimBefore(header.day_tier_start);
+}
+
+bool RollupStoreV3::compactWeekToMonth() {
+    if (weeks.size() <= V3_WEEK_TIER_WEEKS) return false;
+
+    // 合并与最旧一周同月的所有周（周按周一所在月份归属）
+    uint32_t month = monthStart(weeks[0].start_day);
+    size_t count = 0;
+    while (count < weeks.size() && monthStart(weeks[count].start_day) == month) count++;
+
+    if (months.empty() || months.back().start_day != month) {
+        rollup_record_t record;
+        memset(&record, 0, sizeof(record));
+        record.start_day = month;
+        months.push_back(record);
+    }
+    for (size_t i = 0; i < count; i++) {
+        record_add(&months.back(), weeks[i]);
+    }
+    weeks.erase(weeks.begin(), weeks.begin() + count);
+    return true;
+}
+
+bool RollupStoreV3::compactMonthToCarry() {
+    if (months.size() <= V3_MONTH_TIER_MONTHS) return false;
+
+    uint32_t start_day = header.carry.start_day;
+    record_add(&header.carry, months[0]);
+    header.carry.start_day = start_day ? start_day : months[0].start_day;
+    months.erase(months.begin());
+    return true;
+}
+
+int RollupStoreV3::compact(HistoryIndexV3& index, uint32_t today, int max_steps) {
+    if (!backend) return 0;
+
+    // 上次压缩已保存汇总但索引裁剪未完成（掉电或写入失败）时补做
+    finishTrim(index);
+
+    // 日->周每步自行保存；周->月、月->累计只在层间移动数据，最后统一保存
+    int steps = 0;
+    bool dirty = false;
+    while (steps < max_steps) {
+        if (compactDayToWeek(index, today)) {
+            steps++;
+        } else if (compactWeekToMonth() || compactMonthToCarry()) {
+            steps++;
+            dirty = true;
+        } else {
+            break;
+        }
+    }
+
+    if (dirty && !save()) return 0;
+    return steps;
+}
+
+void RollupStoreV3::getLifetime(HistoryIndexV3& index, rollup_record_t* out, uint32_t* best_day) {
+    *out = header.carry;
+    uint32_t best = header.carry.best_score ? header.carry.start_day : 0;
+
+    for (size_t i = 0; i < months.size(); i++) {
+        if (months[i].best_score > out->best_score) best = months[i].start_day;
+        record_add(out, months[i]);
+    }
+    for (size_t i = 0; i < weeks.size(); i++) {
+        if (weeks[i].best_score > out->best_score) best = weeks[i].start_day;
+        record_add(out, weeks[i]);
+    }
+
+    // 日期层：区间汇总O(1)，最佳值需逐日读取（最多约V3_DAY_TIER_DAYS+7天）
+    // 早于day_tier_start的日期已计入周汇总（裁剪未完成时残留），跳过
+    uint32_t first = index.firstDay();
+    if (first < header.day_tier_start) first = header.day_tier_start;
+    if (!index.isEmpty() && first <= index.lastDay()) {
+        day_totals_v3_t totals;
+        if (index.getRange(first, index.lastDay(), &totals)) {
+            out->jumps += totals.jumps;
+            out->duration += totals.duration;
+            out->calories_x10 += totals.calories_x10;
+            out->sessions += totals.sessions;
+            out->targets += totals.targets;
+        }
+        day_totals_v3_t days[16];
+        uint32_t day = first;
+        while (day <= index.lastDay()) {
+            uint32_t read = index.getDays(day, 16, days);
+            if (read == 0) break;
+            for (uint32_t i = 0; i < read; i++) {
+                if (days[i].sessions == 0) continue;
+                out->active_days++;
+                if (days[i].jumps > out->max_day_jumps) out->max_day_jumps = days[i].jumps;
+                if (days[i].best_score > out->best_score) {
+                    out->best_score = days[i].best_score;
+                    best = day + i;
+                }
+            }
+            day += read;
+        }
+    }
+
+    if (best_day) *best_day = best;
+}
+
+bool RollupStoreV3::getRange(HistoryIndexV3& index, uint32_t first_day, uint32_t last_day,
+                             day_totals_v3_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (first_day > last_day) return true;
+
+    if (header.day_tier_start == 0 || last_day >= header.day_tier_start) {
+        // 日期层只负责day_tier_start及之后的日期（裁剪未完成时索引中可能残留更早的日期）
+        uint32_t index_first = first_day > header.day_tier_start ? first_day : header.day_tier_start;
+        if (!index.getRange(index_first, last_day, out)) return false;
+    }
+    if (first_day >= header.day_tier_start) return true;
+
+    for (size_t i = 0; i < months.size(); i++) {
+        if (months[i].start_day >= first_day && months[i].start_day <= last_day) totals_add(out, months[i]);
+    }
+    for (size_t i = 0; i < weeks.size(); i++) {
+        if (weeks[i].start_day >= first_day && weeks[i].start_day <= last_day) totals_add(out, weeks[i]);
+    }
+    return true;
+}
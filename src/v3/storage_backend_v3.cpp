@@ -0,0 +1,531 @@
+#include "v3/storage_backend_v3.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef ARDUINO
+#include <SPIFFS.h>
+#include <LittleFS.h>
+#include <esp_spiffs.h>
+#endif
+
+// ==================== 便捷方法 ====================
+
+bool StorageBackendV3::writeAll(const char* path, const uint8_t* data, size_t len) {
+    StorageFileV3* file = open(path, V3_OPEN_WRITE);
+    if (!file) return false;
+
+    size_t written = file->write(data, len);
+    delete file;
+    return written == len;
+}
+
+bool StorageBackendV3::append(const char* path, const uint8_t* data, size_t len) {
+    StorageFileV3* file = open(path, V3_OPEN_APPEND);
+    if (!file) return false;
+
+    size_t written = file->write(data, len);
+    delete file;
+    return written == len;
+}
+
+size_t StorageBackendV3::readAt(const char* path, size_t offset, uint8_t* buf, size_t len) {
+    StorageFileV3* file = open(path, V3_OPEN_READ);
+    if (!file) return 0;
+
+    size_t read_len = 0;
+    if (file->seek(offset)) {
+        read_len = file->read(buf, len);
+    }
+    delete file;
+    return read_len;
+}
+
+// ==================== RAM后端 ====================
+
+class RamStorageFileV3 : public StorageFileV3 {
+public:
+    RamStorageFileV3(RamStorageBackendV3* owner, RamStorageBackendV3::Entry* entry, size_t pos) :
+        owner(owner), entry(entry), pos(pos) {
+        entry->open_count++;
+    }
+
+    ~RamStorageFileV3() override {
+        owner->closeEntry(entry);
+    }
+
+    size_t read(uint8_t* buf, size_t len) override {
+        size_t available = entry->data.size() > pos ? entry->data.size() - pos : 0;
+        size_t n = len < available ? len : available;
+        if (n > 0) {
+            memcpy(buf, entry->data.data() + pos, n);
+            pos += n;
+        }
+        return n;
+    }
+
+    size_t write(const uint8_t* buf, size_t len) override {
+        size_t end = pos + len;
+        if (end > entry->data.size()) {
+            if (!owner->reserve(end - entry->data.size())) return 0;
+            entry->data.resize(end);
+        }
+        memcpy(entry->data.data() + pos, buf, len);
+        pos = end;
+        return len;
+    }
+
+    bool seek(size_t new_pos) override {
+        if (new_pos > entry->data.size()) return false;
+        pos = new_pos;
+        return true;
+    }
+
+    size_t position() override { return pos; }
+    size_t size() override { return entry->data.size(); }
+
+private:
+    RamStorageBackendV3* owner;
+    RamStorageBackendV3::Entry* entry;
+    size_t pos;
+};
+
+RamStorageBackendV3::RamStorageBackendV3(size_t capacity) :
+    capacity(capacity), used(0), mounted(false) {
+}
+
+bool RamStorageBackendV3::begin(bool format_on_fail) {
+    (void)format_on_fail;
+    mounted = true;
+    return true;
+}
+
+void RamStorageBackendV3::end() {
+    mounted = false;
+}
+
+bool RamStorageBackendV3::format() {
+    while (!entries.empty()) {
+        dropEntry(entries.size() - 1);
+    }
+    return true;
+}
+
+// 从目录中移除；仍有打开的句柄时保留数据，由最后一个句柄关闭时释放（与POSIX的unlink一致）
+void RamStorageBackendV3::dropEntry(size_t index) {
+    Entry* entry = entries[index];
+    entries.erase(entries.begin() + index);
+    entry->unlinked = true;
+    if (entry->open_count == 0) {
+        release(entry->data.size());
+        delete entry;
+    }
+}
+
+void RamStorageBackendV3::closeEntry(Entry* entry) {
+    entry->open_count--;
+    if (entry->unlinked && entry->open_count == 0) {
+        release(entry->data.size());
+        delete entry;
+    }
+}
+
+RamStorageBackendV3::Entry* RamStorageBackendV3::find(const char* path) {
+    for (Entry* entry : entries) {
+        if (entry->path == path) return entry;
+    }
+    return nullptr;
+}
+
+bool RamStorageBackendV3::reserve(size_t bytes) {
+    if (used + bytes > capacity) return false;
+    used += bytes;
+    return true;
+}
+
+void RamStorageBackendV3::release(size_t bytes) {
+    used = bytes > used ? 0 : used - bytes;
+}
+
+StorageFileV3* RamStorageBackendV3::open(const char* path, storage_open_mode_t mode) {
+    if (!mounted) return nullptr;
+
+    Entry* entry = find(path);
+    if (mode == V3_OPEN_READ) {
+        return entry ? new RamStorageFileV3(this, entry, 0) : nullptr;
+    }
+
+    if (!entry) {
+        entry = new Entry();
+        entry->path = path;
+        entries.push_back(entry);
+    } else if (mode == V3_OPEN_WRITE) {
+        release(entry->data.size());
+        entry->data.clear();
+    }
+
+    size_t pos = (mode == V3_OPEN_APPEND) ? entry->data.size() : 0;
+    return new RamStorageFileV3(this, entry, pos);
+}
+
+bool RamStorageBackendV3::exists(const char* path) {
+    return mounted && find(path) != nullptr;
+}
+
+bool RamStorageBackendV3::stat(const char* path, size_t* size) {
+    Entry* entry = mounted ? find(path) : nullptr;
+    if (!entry) return false;
+    if (size) *size = entry->data.size();
+    return true;
+}
+
+bool RamStorageBackendV3::remove(const char* path) {
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i]->path == path) {
+            dropEntry(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RamStorageBackendV3::rename(const char* from, const char* to) {
+    if (!find(from)) return false;
+    if (strcmp(from, to) == 0) return true;
+
+    // 先移除目标再取源记录，目标的删除不会影响源指针
+    remove(to);
+    Entry* entry = find(from);
+    entry->path = to;
+    return true;
+}
+
+int RamStorageBackendV3::list(const char* dir, storage_list_cb_t cb, void* ctx) {
+    if (!mounted) return -1;
+
+    // 扁平结构，与SPIFFS一致：按前缀匹配
+    size_t dir_len = strlen(dir);
+    if (dir_len == 1 && dir[0] == '/') dir_len = 0;
+
+    int count = 0;
+    for (Entry* entry : entries) {
+        if (entry->path.compare(0, dir_len, dir, dir_len) != 0) continue;
+        if (cb) cb(entry->path.c_str(), entry->data.size(), ctx);
+        count++;
+    }
+    return count;
+}
+
+// ==================== POSIX后端 ====================
+
+class PosixStorageFileV3 : public StorageFileV3 {
+public:
+    explicit PosixStorageFileV3(FILE* fp) : fp(fp) {}
+
+    ~PosixStorageFileV3() override {
+        fclose(fp);
+    }
+
+    size_t read(uint8_t* buf, size_t len) override {
+        return fread(buf, 1, len, fp);
+    }
+
+    size_t write(const uint8_t* buf, size_t len) override {
+        return fwrite(buf, 1, len, fp);
+    }
+
+    bool seek(size_t pos) override {
+        return fseek(fp, (long)pos, SEEK_SET) == 0;
+    }
+
+    size_t position() override {
+        long pos = ftell(fp);
+        return pos < 0 ? 0 : (size_t)pos;
+    }
+
+    size_t size() override {
+        long current = ftell(fp);
+        fseek(fp, 0, SEEK_END);
+        long end = ftell(fp);
+        fseek(fp, current, SEEK_SET);
+        return end < 0 ? 0 : (size_t)end;
+    }
+
+    void flush() override {
+        fflush(fp);
+    }
+
+private:
+    FILE* fp;
+};
+
+PosixStorageBackendV3::PosixStorageBackendV3(const char* root, size_t quota) :
+    root(root), quota(quota), mounted(false) {
+}
+
+std::string PosixStorageBackendV3::fullPath(const char* path) const {
+    std::string full = root;
+    if (path[0] != '/') full += '/';
+    full += path;
+    return full;
+}
+
+bool PosixStorageBackendV3::begin(bool format_on_fail) {
+#ifdef ARDUINO
+    // 设备上根目录是SPIFFS分区的VFS挂载点，需要先注册（SPIFFS没有目录，不做stat/mkdir）
+    esp_vfs_spiffs_conf_t conf = {};
+    conf.base_path = root.c_str();
+    conf.partition_label = NULL;
+    conf.max_files = V3_POSIX_STORAGE_MAX_FILES;
+    conf.format_if_mount_failed = format_on_fail;
+    esp_err_t err = esp_vfs_spiffs_register(&conf);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {   // 已注册时沿用
+        Serial.printf("❌ SPIFFS VFS注册失败: %s\n", esp_err_to_name(err));
+        return false;
+    }
+    mounted = true;
+    return true;
+#else
+    struct stat st;
+    if (::stat(root.c_str(), &st) != 0) {
+        if (!format_on_fail || mkdir(root.c_str(), 0755) != 0) {
+            return false;
+        }
+    }
+    mounted = true;
+    return true;
+#endif
+}
+
+void PosixStorageBackendV3::end() {
+#ifdef ARDUINO
+    if (mounted) {
+        esp_vfs_spiffs_unregister(NULL);
+    }
+#endif
+    mounted = false;
+}
+
+static void posix_remove_cb(const char* path, size_t size, void* ctx) {
+    (void)size;
+    std::vector<std::string>* paths = (std::vector<std::string>*)ctx;
+    paths->push_back(path);
+}
+
+bool PosixStorageBackendV3::format() {
+    std::vector<std::string> paths;
+    list("/", posix_remove_cb, &paths);
+
+    bool success = true;
+    for (const std::string& path : paths) {
+        success &= remove(path.c_str());
+    }
+    return success;
+}
+
+StorageFileV3* PosixStorageBackendV3::open(const char* path, storage_open_mode_t mode) {
+    if (!mounted) return nullptr;
+
+    const char* fmode = (mode == V3_OPEN_READ) ? "rb" :
+                        (mode == V3_OPEN_WRITE) ? "wb" :
+                        (mode == V3_OPEN_APPEND) ? "ab" :
+                        exists(path) ? "r+b" : "w+b";
+    FILE* fp = fopen(fullPath(path).c_str(), fmode);
+    return fp ? new PosixStorageFileV3(fp) : nullptr;
+}
+
+bool PosixStorageBackendV3::exists(const char* path) {
+    return stat(path, nullptr);
+}
+
+bool PosixStorageBackendV3::stat(const char* path, size_t* size) {
+    if (!mounted) return false;
+
+    struct stat st;
+    if (::stat(fullPath(path).c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    if (size) *size = (size_t)st.st_size;
+    return true;
+}
+
+bool PosixStorageBackendV3::remove(const char* path) {
+    return mounted && unlink(fullPath(path).c_str()) == 0;
+}
+
+bool PosixStorageBackendV3::rename(const char* from, const char* to) {
+    if (!mounted) return false;
+
+    std::string to_path = fullPath(to);
+#ifdef ARDUINO
+    // SPIFFS的VFS实现中rename不覆盖已有文件
+    unlink(to_path.c_str());
+#endif
+    return ::rename(fullPath(from).c_str(), to_path.c_str()) == 0;
+}
+
+int PosixStorageBackendV3::list(const char* dir, storage_list_cb_t cb, void* ctx) {
+    if (!mounted) return -1;
+
+    DIR* d = opendir(fullPath(dir).c_str());
+    if (!d) return -1;
+
+    std::string prefix = dir;
+    if (prefix.empty() || prefix[prefix.size() - 1] != '/') prefix += '/';
+
+    int count = 0;
+    struct dirent* ent;
+    while ((ent = readdir(d)) != nullptr) {
+        std::string path = prefix + ent->d_name;
+        size_t size = 0;
+        if (!stat(path.c_str(), &size)) continue; // 跳过目录和 . ..
+        if (cb) cb(path.c_str(), size, ctx);
+        count++;
+    }
+    closedir(d);
+    return count;
+}
+
+static void posix_usage_cb(const char* path, size_t size, void* ctx) {
+    (void)path;
+    *(size_t*)ctx += size;
+}
+
+size_t PosixStorageBackendV3::usedBytes() {
+    size_t used = 0;
+    list("/", posix_usage_cb, &used);
+    return used;
+}
+
+// ==================== Arduino FS后端 ====================
+
+#ifdef ARDUINO
+
+class ArduinoStorageFileV3 : public StorageFileV3 {
+public:
+    explicit ArduinoStorageFileV3(File f) : file(f) {}
+
+    ~ArduinoStorageFileV3() override {
+        file.close();
+    }
+
+    size_t read(uint8_t* buf, size_t len) override { return file.read(buf, len); }
+    size_t write(const uint8_t* buf, size_t len) override { return file.write(buf, len); }
+    bool seek(size_t pos) override { return file.seek(pos, SeekSet); }
+    size_t position() override { return file.position(); }
+    size_t size() override { return file.size(); }
+    void flush() override { file.flush(); }
+
+private:
+    File file;
+};
+
+StorageFileV3* ArduinoFSStorageBackendV3::open(const char* path, storage_open_mode_t mode) {
+    const char* fmode = (mode == V3_OPEN_READ) ? FILE_READ :
+                        (mode == V3_OPEN_WRITE) ? FILE_WRITE :
+                        (mode == V3_OPEN_APPEND) ? FILE_APPEND :
+                        vfs.exists(path) ? "r+" : "w+";
+
+    if (mode == V3_OPEN_READ && !vfs.exists(path)) {
+        return nullptr; // 避免VFS打印"文件不存在"错误
+    }
+
+    File file = vfs.open(path, fmode);
+    if (!file) return nullptr;
+    return new ArduinoStorageFileV3(file);
+}
+
+bool ArduinoFSStorageBackendV3::exists(const char* path) {
+    return vfs.exists(path);
+}
+
+bool ArduinoFSStorageBackendV3::stat(const char* path, size_t* size) {
+    if (!vfs.exists(path)) return false;
+
+    File file = vfs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) return false;
+    if (size) *size = file.size();
+    file.close();
+    return true;
+}
+
+bool ArduinoFSStorageBackendV3::remove(const char* path) {
+    return vfs.remove(path);
+}
+
+bool ArduinoFSStorageBackendV3::rename(const char* from, const char* to) {
+    if (vfs.exists(to)) {
+        vfs.remove(to);
+    }
+    return vfs.rename(from, to);
+}
+
+int ArduinoFSStorageBackendV3::list(const char* dir, storage_list_cb_t cb, void* ctx) {
+    File root = vfs.open(dir);
+    if (!root || !root.isDirectory()) return -1;
+
+    int count = 0;
+    File file = root.openNextFile();
+    while (file) {
+        if (!file.isDirectory()) {
+            if (cb) cb(file.path(), file.size(), ctx);
+            count++;
+        }
+        file = root.openNextFile();
+    }
+    return count;
+}
+
+SPIFFSStorageBackendV3::SPIFFSStorageBackendV3() : ArduinoFSStorageBackendV3(SPIFFS) {
+}
+
+bool SPIFFSStorageBackendV3::begin(bool format_on_fail) {
+    if (SPIFFS.begin(false)) return true;
+    return format_on_fail && SPIFFS.begin(true);
+}
+
+void SPIFFSStorageBackendV3::end() { SPIFFS.end(); }
+bool SPIFFSStorageBackendV3::format() { return SPIFFS.format(); }
+size_t SPIFFSStorageBackendV3::totalBytes() { return SPIFFS.totalBytes(); }
+size_t SPIFFSStorageBackendV3::usedBytes() { return SPIFFS.usedBytes(); }
+
+LittleFSStorageBackendV3::LittleFSStorageBackendV3() : ArduinoFSStorageBackendV3(LittleFS) {
+}
+
+bool LittleFSStorageBackendV3::begin(bool format_on_fail) {
+    if (LittleFS.begin(false)) return true;
+    return format_on_fail && LittleFS.begin(true);
+}
+
+void LittleFSStorageBackendV3::end() { LittleFS.end(); }
+bool LittleFSStorageBackendV3::format() { return LittleFS.format(); }
+size_t LittleFSStorageBackendV3::totalBytes() { return LittleFS.totalBytes(); }
+size_t LittleFSStorageBackendV3::usedBytes() { return LittleFS.usedBytes(); }
+
+#endif // ARDUINO
+
+// ==================== 编译期选择 ====================
+
+StorageBackendV3* getStorageBackendV3() {
+#if V3_STORAGE_BACKEND == V3_STORAGE_SPIFFS
+#ifndef ARDUINO
+#error "SPIFFS backend requires the Arduino framework; use V3_STORAGE_RAM or V3_STORAGE_POSIX on host"
+#endif
+    static SPIFFSStorageBackendV3 backend;
+#elif V3_STORAGE_BACKEND == V3_STORAGE_LITTLEFS
+#ifndef ARDUINO
+#error "LittleFS backend requires the Arduino framework; use V3_STORAGE_RAM or V3_STORAGE_POSIX on host"
+#endif
+    static LittleFSStorageBackendV3 backend;
+#elif V3_STORAGE_BACKEND == V3_STORAGE_RAM
+    static RamStorageBackendV3 backend;
+#elif V3_STORAGE_BACKEND == V3_STORAGE_POSIX
+    static PosixStorageBackendV3 backend;
+#else
+#error "Unknown V3_STORAGE_BACKEND"
+#endif
+    return &backend;
+}
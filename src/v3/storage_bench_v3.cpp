@@ -0,0 +1,240 @@
+#include "v3/storage_bench_v3.h"
+#include <string.h>
+#include <stdio.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#define BENCH_PRINTF(...)   Serial.printf(__VA_ARGS__)
+#define BENCH_NOW_US()      ((uint32_t)micros())
+#else
+#include <time.h>
+#define BENCH_PRINTF(...)   printf(__VA_ARGS__)
+static uint32_t bench_now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+#define BENCH_NOW_US()      bench_now_us()
+#endif
+
+// 延迟累计器
+typedef struct {
+    uint64_t total;
+    uint32_t max;
+    uint32_t count;
+} bench_timer_t;
+
+static void bench_record(bench_timer_t* t, uint32_t us) {
+    t->total += us;
+    t->count++;
+    if (us > t->max) t->max = us;
+}
+
+static uint32_t bench_avg(const bench_timer_t* t) {
+    return t->count > 0 ? (uint32_t)(t->total / t->count) : 0;
+}
+
+static void bench_fill_pattern(uint8_t* buf, size_t len, uint32_t seed) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)('A' + (seed + i) % 26);
+    }
+}
+
+static void bench_collect_cb(const char* path, size_t size, void* ctx) {
+    (void)size;
+    std::vector<std::string>* names = (std::vector<std::string>*)ctx;
+    if (strncmp(path, "/bench_", 7) == 0) {
+        names->push_back(path);
+    }
+}
+
+// 删除所有测试文件
+static void bench_cleanup(StorageBackendV3* backend) {
+    std::vector<std::string> names;
+    backend->list("/", bench_collect_cb, &names);
+    for (size_t i = 0; i < names.size(); i++) {
+        backend->remove(names[i].c_str());
+    }
+}
+
+static float bench_usage_percent(StorageBackendV3* backend) {
+    size_t total = backend->totalBytes();
+    return total > 0 ? (backend->usedBytes() * 100.0f) / total : 100.0f;
+}
+
+// 小文件写读：模拟每日数据文件的整体重写
+static bool bench_small_files(StorageBackendV3* backend, storage_bench_result_t* result) {
+    uint8_t buf[V3_BENCH_SMALL_FILE_SIZE];
+    char path[32];
+    bench_timer_t wt = {0, 0, 0};
+    bench_timer_t rt = {0, 0, 0};
+
+    for (int i = 0; i < V3_BENCH_SMALL_FILE_COUNT; i++) {
+        snprintf(path, sizeof(path), "/bench_s%02d.json", i);
+        bench_fill_pattern(buf, sizeof(buf), i);
+
+        uint32_t t0 = BENCH_NOW_US();
+        if (!backend->writeAll(path, buf, sizeof(buf))) return false;
+        bench_record(&wt, BENCH_NOW_US() - t0);
+    }
+
+    for (int i = 0; i < V3_BENCH_SMALL_FILE_COUNT; i++) {
+        snprintf(path, sizeof(path), "/bench_s%02d.json", i);
+
+        uint32_t t0 = BENCH_NOW_US();
+        size_t n = backend->readAt(path, 0, buf, sizeof(buf));
+        bench_record(&rt, BENCH_NOW_US() - t0);
+        if (n != sizeof(buf)) return false;
+    }
+
+    result->small_write_avg_us = bench_avg(&wt);
+    result->small_write_max_us = wt.max;
+    result->small_read_avg_us = bench_avg(&rt);
+    result->small_read_max_us = rt.max;
+    return true;
+}
+
+// 顺序吞吐量：分块写入和读取一个较大文件
+static bool bench_throughput(StorageBackendV3* backend, storage_bench_result_t* result) {
+    uint8_t chunk[V3_BENCH_CHUNK_SIZE];
+    bench_fill_pattern(chunk, sizeof(chunk), 7);
+
+    uint32_t t0 = BENCH_NOW_US();
+    StorageFileV3* file = backend->open("/bench_stream.bin", V3_OPEN_WRITE);
+    if (!file) return false;
+    size_t written = 0;
+    while (written < V3_BENCH_STREAM_SIZE) {
+        size_t n = file->write(chunk, sizeof(chunk));
+        if (n != sizeof(chunk)) break;
+        written += n;
+    }
+    file->flush();
+    delete file;
+    uint32_t write_us = BENCH_NOW_US() - t0;
+    if (written < V3_BENCH_STREAM_SIZE) return false;
+
+    t0 = BENCH_NOW_US();
+    file = backend->open("/bench_stream.bin", V3_OPEN_READ);
+    if (!file) return false;
+    size_t read_total = 0;
+    size_t n;
+    while ((n = file->read(chunk, sizeof(chunk))) > 0) {
+        read_total += n;
+    }
+    delete file;
+    uint32_t read_us = BENCH_NOW_US() - t0;
+    if (read_total != written) return false;
+
+    // KB/s = bytes / 1024 / (us / 1e6)
+    result->write_kbps = write_us > 0 ? (written * 1000000.0f / 1024.0f) / write_us : 0;
+    result->read_kbps = read_us > 0 ? (read_total * 1000000.0f / 1024.0f) / read_us : 0;
+
+    backend->remove("/bench_stream.bin");
+    return true;
+}
+
+// 追加记录：模拟日志和会话追加
+static bool bench_append(StorageBackendV3* backend, storage_bench_result_t* result) {
+    uint8_t record[V3_BENCH_APPEND_SIZE];
+    bench_timer_t at = {0, 0, 0};
+
+    backend->remove("/bench_append.log");
+    for (int i = 0; i < V3_BENCH_APPEND_COUNT; i++) {
+        bench_fill_pattern(record, sizeof(record), i);
+        uint32_t t0 = BENCH_NOW_US();
+        if (!backend->append("/bench_append.log", record, sizeof(record))) return false;
+        bench_record(&at, BENCH_NOW_US() - t0);
+    }
+
+    size_t size = 0;
+    if (!backend->stat("/bench_append.log", &size) ||
+        size != (size_t)V3_BENCH_APPEND_COUNT * V3_BENCH_APPEND_SIZE) {
+        return false;
+    }
+
+    result->append_avg_us = bench_avg(&at);
+    result->append_max_us = at.max;
+    backend->remove("/bench_append.log");
+    return true;
+}
+
+// 填充测试：不断写入1KB文件直到使用率达到上限，按使用率分档统计写入延迟
+static void bench_fill(StorageBackendV3* backend, storage_bench_result_t* result) {
+    uint8_t buf[V3_BENCH_FILL_FILE_SIZE];
+    char path[32];
+    bench_timer_t buckets[V3_BENCH_FILL_BUCKETS];
+    memset(buckets, 0, sizeof(buckets));
+
+    uint32_t index = 0;
+    float usage = bench_usage_percent(backend);
+    while (usage < V3_BENCH_FILL_LIMIT) {
+        snprintf(path, sizeof(path), "/bench_f%05lu.bin", (unsigned long)index);
+        bench_fill_pattern(buf, sizeof(buf), index);
+
+        uint32_t t0 = BENCH_NOW_US();
+        bool ok = backend->writeAll(path, buf, sizeof(buf));
+        uint32_t us = BENCH_NOW_US() - t0;
+        if (!ok) break;
+
+        int bucket = (int)(usage / (100 / V3_BENCH_FILL_BUCKETS));
+        if (bucket >= V3_BENCH_FILL_BUCKETS) bucket = V3_BENCH_FILL_BUCKETS - 1;
+        bench_record(&buckets[bucket], us);
+
+        index++;
+        usage = bench_usage_percent(backend);
+    }
+
+    for (int i = 0; i < V3_BENCH_FILL_BUCKETS; i++) {
+        result->fill[i].writes = buckets[i].count;
+        result->fill[i].avg_us = bench_avg(&buckets[i]);
+        result->fill[i].max_us = buckets[i].max;
+    }
+    result->fill_files = index;
+    result->fill_reached_percent = usage;
+}
+
+bool runStorageBenchmarkV3(StorageBackendV3* backend, storage_bench_result_t* result,
+                           bool include_fill) {
+    memset(result, 0, sizeof(*result));
+    if (!backend) return false;
+    result->backend_name = backend->name();
+
+    bench_cleanup(backend);
+
+    bool ok = bench_small_files(backend, result);
+    bench_cleanup(backend);
+
+    ok = ok && bench_throughput(backend, result);
+    ok = ok && bench_append(backend, result);
+    if (ok && include_fill) {
+        bench_fill(backend, result);
+    }
+
+    bench_cleanup(backend);
+    result->success = ok;
+    return ok;
+}
+
+void printStorageBenchmarkV3(const storage_bench_result_t* result) {
+    BENCH_PRINTF("📁 存储基准测试 [%s]: %s\n", result->backend_name ? result->backend_name : "?",
+                 result->success ? "完成" : "失败");
+    if (!result->success) return;
+
+    BENCH_PRINTF("   小文件写入: 平均 %lu μs, 最大 %lu μs\n",
+                 (unsigned long)result->small_write_avg_us, (unsigned long)result->small_write_max_us);
+    BENCH_PRINTF("   小文件读取: 平均 %lu μs, 最大 %lu μs\n",
+                 (unsigned long)result->small_read_avg_us, (unsigned long)result->small_read_max_us);
+    BENCH_PRINTF("   顺序写入: %.1f KB/s, 顺序读取: %.1f KB/s\n",
+                 result->write_kbps, result->read_kbps);
+    BENCH_PRINTF("   追加记录: 平均 %lu μs, 最大 %lu μs\n",
+                 (unsigned long)result->append_avg_us, (unsigned long)result->append_max_us);
+    if (result->fill_files == 0) return;
+    BENCH_PRINTF("   填充测试: %lu 个文件, 使用率达到 %.1f%%\n",
+                 (unsigned long)result->fill_files, result->fill_reached_percent);
+    for (int i = 0; i < V3_BENCH_FILL_BUCKETS; i++) {
+        if (result->fill[i].writes == 0) continue;
+        BENCH_PRINTF("     %2d-%3d%%: %4lu 次, 平均 %lu μs, 最大 %lu μs\n",
+                     i * 10, (i + 1) * 10, (unsigned long)result->fill[i].writes,
+                     (unsigned long)result->fill[i].avg_us, (unsigned long)result->fill[i].max_us);
+    }
+}
@@ -0,0 +1,74 @@
+#include "v3/storage_stream_v3.h"
+#include <string.h>
+
+// StorageReaderV3 实现
+StorageReaderV3::StorageReaderV3(StorageFileV3* f) : file(f), pos(0), len(0) {
+}
+
+bool StorageReaderV3::fill() {
+    pos = 0;
+    len = file ? file->read(buffer, sizeof(buffer)) : 0;
+    return len > 0;
+}
+
+int StorageReaderV3::read() {
+    if (pos >= len && !fill()) return -1;
+    return buffer[pos++];
+}
+
+size_t StorageReaderV3::readBytes(char* buf, size_t n) {
+    size_t copied = 0;
+    while (copied < n) {
+        if (pos >= len && !fill()) break;
+        size_t chunk = len - pos;
+        if (chunk > n - copied) chunk = n - copied;
+        memcpy(buf + copied, buffer + pos, chunk);
+        pos += chunk;
+        copied += chunk;
+    }
+    return copied;
+}
+
+// StorageWriterV3 实现
+StorageWriterV3::StorageWriterV3(StorageFileV3* f) : file(f), used(0), total(0), error(file == nullptr) {
+}
+
+size_t StorageWriterV3::write(uint8_t c) {
+    if (error) return 0;
+    if (used >= sizeof(buffer) && !drain()) return 0;
+    buffer[used++] = c;
+    total++;
+    return 1;
+}
+
+size_t StorageWriterV3::write(const uint8_t* buf, size_t n) {
+    size_t written = 0;
+    while (written < n && !error) {
+        if (used >= sizeof(buffer) && !drain()) break;
+        size_t chunk = sizeof(buffer) - used;
+        if (chunk > n - written) chunk = n - written;
+        memcpy(buffer + used, buf + written, chunk);
+        used += chunk;
+        written += chunk;
+    }
+    total += written;
+    return written;
+}
+
+bool StorageWriterV3::drain() {
+    if (error) return false;
+    if (used > 0) {
+        if (file->write(buffer, used) != used) {
+            error = true;
+            return false;
+        }
+        used = 0;
+    }
+    return true;
+}
+
+bool StorageWriterV3::flush() {
+    if (!drain()) return false;
+    file->flush();
+    return true;
+}
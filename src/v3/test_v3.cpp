@@ -1,6 +1,8 @@
 #include "v3/board_config_v3.h"
 #include "v3/file_system_v3.h"
+#include "v3/storage_bench_v3.h"
 #include "v3/data_manager_v3.h"
+#include "v3/ntp_time_v3.h"
 #include "v3/ui_views_v3.h"
 #include "v3/game_integration_v3.h"
 
@@ -97,6 +99,30 @@ bool testV3DataManager() {
         return false;
     }
     
+    // 测试写回缓存
+    if (!dataManagerV3.flushPendingWrites(true) || dataManagerV3.hasPendingWrites()) {
+        Serial.println("❌ 写回缓存刷新失败");
+        return false;
+    }
+    
+    // 测试每日数据缓存：重复读取命中，写入后失效
+    DailyDataV3 cached_day;
+    uint32_t hits_before = dataManagerV3.getCacheHits();
+    dataManagerV3.loadDailyData(dataManagerV3.getTodayEpochDay(), cached_day);
+    if (!dataManagerV3.loadDailyData(dataManagerV3.getTodayEpochDay(), cached_day) ||
+        dataManagerV3.getCacheHits() != hits_before + 1) {
+        Serial.println("❌ 每日数据缓存未命中");
+        return false;
+    }
+    dataManagerV3.saveGameSession(session);
+    dataManagerV3.flushPendingWrites(true);
+    DailyDataV3 reloaded_day;
+    if (!dataManagerV3.loadDailyData(dataManagerV3.getTodayEpochDay(), reloaded_day) ||
+        reloaded_day.daily_total.session_count != cached_day.daily_total.session_count + 1) {
+        Serial.println("❌ 每日数据缓存写入后未失效");
+        return false;
+    }
+    
     // 测试统计数据
     uint32_t total_jumps = dataManagerV3.getTotalJumpsToday();
     if (total_jumps < 50) {
@@ -104,6 +130,16 @@ bool testV3DataManager() {
         return false;
     }
     
+    // 测试趋势序列：今天的点随会话增量更新，柱高在绘图区范围内
+    TrendWindowV3 trend;
+    std::vector<uint32_t> jumps_trend = dataManagerV3.getJumpsTrend(V3_TREND_DAYS);
+    if (!dataManagerV3.getTrendWindow(V3_TREND_WINDOW_7D, trend) ||
+        jumps_trend.size() != V3_TREND_DAYS || jumps_trend.back() != total_jumps ||
+        trend.days != 7 || trend.heights[6] == 0 || trend.heights[6] > V3_TREND_PLOT_HEIGHT) {
+        Serial.println("❌ 趋势序列与今日数据不一致");
+        return false;
+    }
+    
     Serial.println("✅ 数据管理器测试通过");
     return true;
 }
@@ -282,6 +318,9 @@ void printV3SystemDetails() {
     Serial.printf("   File System: %s\n", fileSystemV3.isAvailable() ? "Available" : "Unavailable");
     Serial.printf("   Data Manager: %s\n", dataManagerV3.isInitialized() ? "Initialized" : "Not Initialized");
     Serial.printf("   UI Manager: %s\n", (uiManagerV3 != nullptr) ? "Created" : "Not Created");
+    Serial.printf("   Time: %s (%s)\n",
+                 ntpTimeV3.isValidTime() ? ntpTimeV3.getCurrentDateTimeString().c_str() : "Unknown",
+                 NTPTimeV3::getTimeSourceName(ntpTimeV3.getTimeSource()));
     
     // 内存使用情况
     Serial.println("\n💾 内存使用情况:");
@@ -292,9 +331,11 @@ void printV3SystemDetails() {
     // 文件系统信息
     if (fileSystemV3.isAvailable()) {
         Serial.println("\n💾 文件系统信息:");
-        Serial.printf("   总空间: %d bytes\n", SPIFFS.totalBytes());
-        Serial.printf("   已使用: %d bytes\n", SPIFFS.usedBytes());
-        Serial.printf("   使用率: %.1f%%\n", (SPIFFS.usedBytes() * 100.0) / SPIFFS.totalBytes());
+        Serial.printf("   存储后端: %s\n", fileSystemV3.getBackendName());
+        Serial.printf("   总空间: %d bytes\n", fileSystemV3.getTotalBytes());
+        Serial.printf("   已使用: %d bytes\n", fileSystemV3.getUsedBytes());
+        Serial.printf("   使用率: %.1f%%\n", fileSystemV3.getUsagePercent());
+        fileSystemV3.printTraceLog(16);
     }
     
     // 配置信息
@@ -314,6 +355,124 @@ void printV3SystemDetails() {
     Serial.println("================================================");
 }
 
+// JSON与MessagePack记录格式对比（最近一周的真实每日数据）
+void runV3RecordFormatComparison(uint8_t days = 7) {
+    if (!dataManagerV3.isInitialized()) return;
+    
+    Serial.printf("📦 记录格式对比 (最近%d天):\n", days);
+    
+    const int rounds = 10;
+    size_t json_bytes = 0, msgpack_bytes = 0;
+    uint32_t json_parse_us = 0, msgpack_parse_us = 0;
+    uint8_t loaded = 0;
+    
+    for (int i = 0; i < days; i++) {
+        DailyDataV3 daily_data;
+        if (!dataManagerV3.loadDailyData(dataManagerV3.getTodayEpochDay() - i, daily_data)) continue;
+        loaded++;
+        
+        JsonDocument doc;
+        daily_data.toJson(doc);
+        
+        String json_text;
+        serializeJson(doc, json_text);
+        std::vector<uint8_t> msgpack(measureMsgPack(doc));
+        serializeMsgPack(doc, msgpack.data(), msgpack.size());
+        
+        json_bytes += json_text.length();
+        msgpack_bytes += msgpack.size();
+        
+        // 解析耗时取多轮平均
+        JsonDocument parsed;
+        uint32_t start_time = micros();
+        for (int r = 0; r < rounds; r++) {
+            deserializeJson(parsed, json_text.c_str(), json_text.length());
+        }
+        json_parse_us += (micros() - start_time) / rounds;
+        
+        start_time = micros();
+        for (int r = 0; r < rounds; r++) {
+            deserializeMsgPack(parsed, msgpack.data(), msgpack.size());
+        }
+        msgpack_parse_us += (micros() - start_time) / rounds;
+    }
+    
+    if (loaded == 0) {
+        Serial.println("   没有可用的每日数据");
+        return;
+    }
+    
+    // 落盘大小包含文件头
+    json_bytes += loaded * V3_RECORD_HEADER_SIZE;
+    msgpack_bytes += loaded * V3_RECORD_HEADER_SIZE;
+    
+    Serial.printf("   %d 个文件\n", loaded);
+    Serial.printf("   JSON:        %d bytes, 解析 %lu μs\n", json_bytes, json_parse_us);
+    Serial.printf("   MessagePack: %d bytes, 解析 %lu μs\n", msgpack_bytes, msgpack_parse_us);
+    Serial.printf("   体积比: %.1f%%\n", (msgpack_bytes * 100.0) / json_bytes);
+}
+
+// 完整加载与只读汇总对比（20次游戏的一天）
+void runV3SummaryLoadBenchmark(uint8_t session_count = 20) {
+    if (!fileSystemV3.isAvailable()) return;
+    
+    Serial.printf("📄 每日记录加载对比 (%d次游戏):\n", session_count);
+    
+    const char* path = "/bench_daily.rec";
+    const int rounds = 10;
+    
+    DailyDataV3 day(DataUtilsV3::getEpochDay());
+    for (int i = 0; i < session_count; i++) {
+        GameSessionV3 session = dataManagerV3.createGameSession(
+            (game_difficulty_t)(i % DIFFICULTY_COUNT), 60 + i * 5, 120 + i * 10);
+        day.addSession(session);
+    }
+    JsonDocument source;
+    day.toJson(source);
+    if (!fileSystemV3.writeRecord(path, source)) {
+        Serial.println("   ❌ 测试文件写入失败");
+        return;
+    }
+    
+    JsonDocument filter;
+    DailyDataV3::summaryFilter(filter);
+    
+    // 耗时取多轮平均；堆占用为解析完成、对象尚未释放时的空闲堆减少量
+    uint32_t full_us = 0, summary_us = 0;
+    uint32_t full_heap = 0, summary_heap = 0;
+    uint32_t jumps_full = 0, jumps_summary = 0;
+    for (int r = 0; r < rounds; r++) {
+        uint32_t heap_before = ESP.getFreeHeap();
+        uint32_t start_time = micros();
+        {
+            JsonDocument doc;
+            DailyDataV3 loaded;
+            fileSystemV3.readRecord(path, doc);
+            loaded.fromJson(doc);
+            full_us += micros() - start_time;
+            full_heap = max(full_heap, heap_before - ESP.getFreeHeap());
+            jumps_full = loaded.daily_total.total_jumps;
+        }
+        
+        heap_before = ESP.getFreeHeap();
+        start_time = micros();
+        {
+            JsonDocument doc;
+            DailyDataV3 loaded;
+            fileSystemV3.readRecord(path, doc, &filter);
+            loaded.fromJsonSummary(doc);
+            summary_us += micros() - start_time;
+            summary_heap = max(summary_heap, heap_before - ESP.getFreeHeap());
+            jumps_summary = loaded.daily_total.total_jumps;
+        }
+    }
+    fileSystemV3.deleteFile(path);
+    
+    Serial.printf("   完整加载: %lu μs, 峰值堆 %lu bytes\n", full_us / rounds, full_heap);
+    Serial.printf("   只读汇总: %lu μs, 峰值堆 %lu bytes\n", summary_us / rounds, summary_heap);
+    Serial.printf("   汇总一致: %s\n", jumps_full == jumps_summary ? "✅" : "❌");
+}
+
 // 性能基准测试
 void runV3PerformanceBenchmark() {
     Serial.println("⚡ 运行V3.0性能基准测试...");
@@ -339,6 +498,17 @@ void runV3PerformanceBenchmark() {
         Serial.printf("   读取耗时: %lu μs\n", end_time - start_time);
         
         fileSystemV3.deleteFile("/benchmark.json");
+        
+        // 存储后端基准测试：当前后端（不做填充测试，避免写满用户分区）与RAM后端对比
+        storage_bench_result_t bench;
+        runStorageBenchmarkV3(fileSystemV3.getBackend(), &bench, false);
+        printStorageBenchmarkV3(&bench);
+        
+        RamStorageBackendV3 ram_backend;
+        ram_backend.begin(true);
+        runStorageBenchmarkV3(&ram_backend, &bench);
+        printStorageBenchmarkV3(&bench);
+        ram_backend.end();
     }
     
     // 数据处理性能测试
@@ -358,5 +528,9 @@ void runV3PerformanceBenchmark() {
         Serial.printf("   Statistics calculation time: %lu μs\n", end_time - start_time);
     }
 
+    runV3RecordFormatComparison();
+    runV3SummaryLoadBenchmark();
+    fileSystemV3.printWriteLatencyReport();
+
     Serial.println("Performance benchmark test completed");
 }
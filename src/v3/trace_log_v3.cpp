@@ -0,0 +1,315 @@
+#include "v3/trace_log_v3.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+
+// 已知文件的编号（只能追加）
+static const char* const trace_known_files[] = {
+    nullptr,
+    "/system.json",
+    "/summary.json",
+    "/targets.json",
+    "/history.idx",
+    "/rollup.bin",
+    "/time.json",
+};
+#define TRACE_KNOWN_FILE_COUNT  (sizeof(trace_known_files) / sizeof(trace_known_files[0]))
+
+static const char* const trace_event_names[V3_TRACE_EVENT_COUNT] = {
+    "NONE",
+    "BOOT",
+    "FILE_WRITE",
+    "FILE_WRITE_FAIL",
+    "FILE_READ_FAIL",
+    "FILE_DELETE",
+    "FILE_RENAME",
+    "SESSION_SAVED",
+    "DAY_ROLLOVER",
+    "NTP_SYNC",
+    "NTP_FAIL",
+    "RETENTION",
+    "COMPACTION",
+};
+
+// 公历日期 -> epoch-day（与DataUtilsV3::civilToEpochDay相同算法，这里不依赖Arduino）
+static int32_t trace_days_from_civil(int32_t y, int32_t m, int32_t d) {
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    int32_t yoe = y - era * 400;
+    int32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static bool trace_seq_less(const trace_record_v3_t& a, const trace_record_v3_t& b) {
+    return a.seq < b.seq;
+}
+
+TraceLogV3::TraceLogV3() : backend(nullptr), next_seq(1), dropped_count(0), pending_count(0) {
+    memset(&header, 0, sizeof(header));
+}
+
+bool TraceLogV3::begin(StorageBackendV3* storage, const char* file_path, uint32_t capacity) {
+    backend = nullptr;
+    path = file_path;
+    next_seq = 1;
+    pending_count = 0;
+    if (!storage || capacity == 0) return false;
+
+    header.magic[0] = 'J';
+    header.magic[1] = 'L';
+    header.version = V3_TRACE_VERSION;
+    header.record_size = sizeof(trace_record_v3_t);
+    header.capacity = capacity;
+    header.reserved[0] = 0;
+    header.reserved[1] = 0;
+
+    size_t expected_size = sizeof(trace_header_v3_t) + (size_t)capacity * sizeof(trace_record_v3_t);
+    StorageFileV3* file = storage->open(file_path, V3_OPEN_READ);
+    bool valid = false;
+    if (file) {
+        trace_header_v3_t loaded;
+        valid = file->size() == expected_size &&
+                file->read((uint8_t*)&loaded, sizeof(loaded)) == sizeof(loaded) &&
+                memcmp(&loaded, &header, sizeof(header)) == 0;
+
+        // 扫描全部槽位找到最大序号（只在启动时做一次）
+        trace_record_v3_t chunk[32];
+        uint32_t remaining = capacity;
+        while (valid && remaining > 0) {
+            uint32_t n = remaining < 32 ? remaining : 32;
+            if (file->read((uint8_t*)chunk, n * sizeof(trace_record_v3_t)) != n * sizeof(trace_record_v3_t)) {
+                valid = false;
+                break;
+            }
+            for (uint32_t i = 0; i < n; i++) {
+                if (chunk[i].seq >= next_seq) next_seq = chunk[i].seq + 1;
+            }
+            remaining -= n;
+        }
+        delete file;
+    }
+
+    backend = storage;
+    if (!valid) {
+        next_seq = 1;
+        if (!preallocate()) {
+            backend = nullptr;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TraceLogV3::preallocate() {
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_WRITE);
+    if (!file) return false;
+
+    bool ok = file->write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+    trace_record_v3_t empty[32];
+    memset(empty, 0, sizeof(empty));
+    uint32_t remaining = header.capacity;
+    while (ok && remaining > 0) {
+        uint32_t n = remaining < 32 ? remaining : 32;
+        ok = file->write((const uint8_t*)empty, n * sizeof(trace_record_v3_t)) == n * sizeof(trace_record_v3_t);
+        remaining -= n;
+    }
+    delete file;
+    return ok;
+}
+
+size_t TraceLogV3::slotOffset(uint32_t seq) const {
+    return sizeof(trace_header_v3_t) + (size_t)((seq - 1) % header.capacity) * sizeof(trace_record_v3_t);
+}
+
+bool TraceLogV3::append(uint8_t event, uint8_t flags, uint32_t timestamp, uint16_t arg0, uint32_t arg1) {
+    if (pending_count >= V3_TRACE_BUFFER_SIZE) {
+        dropped_count++;
+        return false;
+    }
+
+    trace_record_v3_t& record = pending[pending_count++];
+    record.seq = next_seq++;
+    record.timestamp = timestamp;
+    record.event = event;
+    record.flags = flags;
+    record.arg0 = arg0;
+    record.arg1 = arg1;
+    return true;
+}
+
+size_t TraceLogV3::takePending(trace_record_v3_t* out, size_t max) {
+    size_t n = pending_count < max ? pending_count : max;
+    memcpy(out, pending, n * sizeof(trace_record_v3_t));
+    if (n < pending_count) {
+        memmove(pending, pending + n, (pending_count - n) * sizeof(trace_record_v3_t));
+    }
+    pending_count -= n;
+    return n;
+}
+
+bool TraceLogV3::writeRecords(const trace_record_v3_t* records, size_t count) {
+    if (!backend || count == 0) return backend != nullptr;
+
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_UPDATE);
+    if (!file) return false;
+
+    // 序号连续的记录在文件中也连续，只在环形回绕处拆成两次写入
+    bool ok = true;
+    size_t i = 0;
+    while (ok && i < count) {
+        size_t run = 1;
+        while (i + run < count &&
+               records[i + run].seq == records[i].seq + run &&
+               (records[i + run].seq - 1) % header.capacity != 0) {
+            run++;
+        }
+        ok = file->seek(slotOffset(records[i].seq)) &&
+             file->write((const uint8_t*)&records[i], run * sizeof(trace_record_v3_t)) ==
+                 run * sizeof(trace_record_v3_t);
+        i += run;
+    }
+    delete file;
+    return ok;
+}
+
+bool TraceLogV3::readAll(std::vector<trace_record_v3_t>* out) {
+    out->clear();
+    if (!backend) return false;
+
+    StorageFileV3* file = backend->open(path.c_str(), V3_OPEN_READ);
+    if (!file) return false;
+
+    std::vector<uint8_t> data(file->size());
+    bool ok = file->read(data.data(), data.size()) == data.size();
+    delete file;
+    return ok && decode(data.data(), data.size(), out);
+}
+
+bool TraceLogV3::clear() {
+    if (!backend) return false;
+    next_seq = 1;
+    pending_count = 0;
+    dropped_count = 0;
+    return preallocate();
+}
+
+bool TraceLogV3::decode(const uint8_t* data, size_t len, std::vector<trace_record_v3_t>* out) {
+    out->clear();
+    if (len < sizeof(trace_header_v3_t)) return false;
+
+    trace_header_v3_t hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.magic[0] != 'J' || hdr.magic[1] != 'L' || hdr.version != V3_TRACE_VERSION ||
+        hdr.record_size != sizeof(trace_record_v3_t)) {
+        return false;
+    }
+
+    size_t available = (len - sizeof(hdr)) / sizeof(trace_record_v3_t);
+    size_t count = hdr.capacity < available ? hdr.capacity : available;
+    for (size_t i = 0; i < count; i++) {
+        trace_record_v3_t record;
+        memcpy(&record, data + sizeof(hdr) + i * sizeof(record), sizeof(record));
+        if (record.seq != 0) out->push_back(record);
+    }
+    std::sort(out->begin(), out->end(), trace_seq_less);
+    return true;
+}
+
+const char* TraceLogV3::eventName(uint8_t event) {
+    return event < V3_TRACE_EVENT_COUNT ? trace_event_names[event] : "UNKNOWN";
+}
+
+uint16_t TraceLogV3::fileId(const char* path) {
+    if (!path) return 0;
+
+    // 每日明细: /daily_YYYY-MM-DD.json，编号中直接带epoch-day
+    int y, m, d;
+    if (sscanf(path, "/daily_%4d-%2d-%2d.json", &y, &m, &d) == 3) {
+        return V3_TRACE_FILE_DAILY | (uint16_t)(trace_days_from_civil(y, m, d) & 0x7FFF);
+    }
+
+    for (size_t i = 1; i < TRACE_KNOWN_FILE_COUNT; i++) {
+        if (strcmp(path, trace_known_files[i]) == 0) return (uint16_t)i;
+    }
+
+    // 其它文件：14位FNV-1a哈希
+    uint32_t hash = 2166136261u;
+    for (const char* p = path; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return V3_TRACE_FILE_HASHED | (uint16_t)(hash & 0x3FFF);
+}
+
+static int format_file_id(uint16_t id, char* buf, size_t len) {
+    if (id & V3_TRACE_FILE_DAILY) {
+        time_t t = (time_t)(id & 0x7FFF) * 86400;
+        struct tm tm_utc;
+        gmtime_r(&t, &tm_utc);
+        return snprintf(buf, len, "/daily_%04d-%02d-%02d.json",
+                        tm_utc.tm_year + 1900, tm_utc.tm_mon + 1, tm_utc.tm_mday);
+    }
+    if (id & V3_TRACE_FILE_HASHED) {
+        return snprintf(buf, len, "file#%04x", id & 0x3FFF);
+    }
+    if (id > 0 && id < TRACE_KNOWN_FILE_COUNT) {
+        return snprintf(buf, len, "%s", trace_known_files[id]);
+    }
+    return snprintf(buf, len, "file#%u", id);
+}
+
+int TraceLogV3::formatRecord(const trace_record_v3_t& record, char* buf, size_t len) {
+    char when[48];
+    if (record.flags & V3_TRACE_FLAG_EPOCH) {
+        time_t t = record.timestamp;
+        struct tm tm_utc;
+        gmtime_r(&t, &tm_utc);
+        snprintf(when, sizeof(when), "%04d-%02d-%02d %02d:%02d:%02dZ",
+                 tm_utc.tm_year + 1900, tm_utc.tm_mon + 1, tm_utc.tm_mday,
+                 tm_utc.tm_hour, tm_utc.tm_min, tm_utc.tm_sec);
+    } else {
+        snprintf(when, sizeof(when), "+%lu.%03lus",
+                 (unsigned long)(record.timestamp / 1000), (unsigned long)(record.timestamp % 1000));
+    }
+
+    int n = snprintf(buf, len, "#%-6lu %-22s %-16s ",
+                     (unsigned long)record.seq, when, eventName(record.event));
+    if (n < 0 || (size_t)n >= len) return n;
+    char* p = buf + n;
+    size_t left = len - n;
+
+    char file[32];
+    switch (record.event) {
+        case V3_TRACE_FILE_WRITE:
+            format_file_id(record.arg0, file, sizeof(file));
+            return n + snprintf(p, left, "%s %lu bytes", file, (unsigned long)record.arg1);
+        case V3_TRACE_FILE_WRITE_FAIL:
+        case V3_TRACE_FILE_READ_FAIL:
+        case V3_TRACE_FILE_DELETE:
+        case V3_TRACE_FILE_RENAME:
+            format_file_id(record.arg0, file, sizeof(file));
+            return n + snprintf(p, left, "%s", file);
+        case V3_TRACE_SESSION_SAVED:
+            return n + snprintf(p, left, "jumps=%u score=%lu", record.arg0, (unsigned long)record.arg1);
+        case V3_TRACE_DAY_ROLLOVER: {
+            time_t t = (time_t)record.arg1 * 86400;
+            struct tm tm_utc;
+            gmtime_r(&t, &tm_utc);
+            return n + snprintf(p, left, "day=%04d-%02d-%02d",
+                                tm_utc.tm_year + 1900, tm_utc.tm_mon + 1, tm_utc.tm_mday);
+        }
+        case V3_TRACE_NTP_SYNC:
+            return n + snprintf(p, left, "drift=%.1fppm", (int32_t)record.arg1 / 10.0);
+        case V3_TRACE_NTP_FAIL:
+            return n + snprintf(p, left, "failures=%lu", (unsigned long)record.arg1);
+        case V3_TRACE_RETENTION:
+            return n + snprintf(p, left, "deleted=%u freed=%lu bytes", record.arg0, (unsigned long)record.arg1);
+        case V3_TRACE_COMPACTION:
+            return n + snprintf(p, left, "steps=%u %lu ms", record.arg0, (unsigned long)record.arg1);
+        case V3_TRACE_BOOT:
+            return n + snprintf(p, left, "version=%u reset=%lu", record.arg0, (unsigned long)record.arg1);
+        default:
+            return n + snprintf(p, left, "arg0=%u arg1=%lu", record.arg0, (unsigned long)record.arg1);
+    }
+}
@@ -0,0 +1,100 @@
+#include "v3/trend_series_v3.h"
+#include <string.h>
+
+static const uint8_t trend_window_days[V3_TREND_WINDOW_COUNT] = { 7, 30, 90 };
+static const char* const trend_window_names[V3_TREND_WINDOW_COUNT] = { "7-Day", "30-Day", "90-Day" };
+
+TrendSeriesV3::TrendSeriesV3() : today_day(-1), change_count(0) {
+    reset(-1);
+}
+
+uint8_t TrendSeriesV3::windowDays(trend_window_v3_t which) {
+    return which < V3_TREND_WINDOW_COUNT ? trend_window_days[which] : 0;
+}
+
+const char* TrendSeriesV3::windowName(trend_window_v3_t which) {
+    return which < V3_TREND_WINDOW_COUNT ? trend_window_names[which] : "";
+}
+
+void TrendSeriesV3::reset(int32_t epoch_day) {
+    memset(values, 0, sizeof(values));
+    today_day = epoch_day;
+    for (int i = 0; i < V3_TREND_WINDOW_COUNT; i++) {
+        windows[i].days = trend_window_days[i];
+        windows[i].max_value = 0;
+        memset(windows[i].heights, 0, sizeof(windows[i].heights));
+    }
+    change_count++;
+}
+
+void TrendSeriesV3::setDay(uint16_t days_ago, uint32_t value) {
+    if (days_ago < V3_TREND_DAYS) {
+        values[V3_TREND_DAYS - 1 - days_ago] = value;
+    }
+}
+
+uint32_t TrendSeriesV3::getDay(uint16_t days_ago) const {
+    return days_ago < V3_TREND_DAYS ? values[V3_TREND_DAYS - 1 - days_ago] : 0;
+}
+
+uint8_t TrendSeriesV3::scale(uint32_t value, uint32_t max_value) {
+    if (value == 0 || max_value == 0) return 0;
+    uint32_t height = (uint64_t)value * V3_TREND_PLOT_HEIGHT / max_value;
+    return height < 1 ? 1 : (uint8_t)height;
+}
+
+void TrendSeriesV3::rescale(TrendWindowV3& w) {
+    const uint32_t* first = values + V3_TREND_DAYS - w.days;
+
+    w.max_value = 0;
+    for (uint8_t i = 0; i < w.days; i++) {
+        if (first[i] > w.max_value) w.max_value = first[i];
+    }
+    for (uint8_t i = 0; i < w.days; i++) {
+        w.heights[i] = scale(first[i], w.max_value);
+    }
+}
+
+void TrendSeriesV3::rescaleAll() {
+    for (int i = 0; i < V3_TREND_WINDOW_COUNT; i++) {
+        rescale(windows[i]);
+    }
+    change_count++;
+}
+
+void TrendSeriesV3::addToday(uint32_t delta) {
+    if (delta == 0) return;
+
+    uint32_t& today_value = values[V3_TREND_DAYS - 1];
+    today_value += delta;
+
+    // 今天不超过窗口最大值时只改最后一个点，否则整个窗口按新最大值缩放
+    for (int i = 0; i < V3_TREND_WINDOW_COUNT; i++) {
+        TrendWindowV3& w = windows[i];
+        if (today_value > w.max_value) {
+            rescale(w);
+        } else {
+            w.heights[w.days - 1] = scale(today_value, w.max_value);
+        }
+    }
+    change_count++;
+}
+
+void TrendSeriesV3::advance(int32_t new_today) {
+    if (today_day < 0 || new_today <= today_day) {
+        reset(new_today);
+        return;
+    }
+
+    uint32_t days = new_today - today_day;
+    if (days >= V3_TREND_DAYS) {
+        memset(values, 0, sizeof(values));
+    } else {
+        memmove(values, values + days, (V3_TREND_DAYS - days) * sizeof(values[0]));
+        memset(values + V3_TREND_DAYS - days, 0, days * sizeof(values[0]));
+    }
+    today_day = new_today;
+
+    // 每天一次，最大值可能已移出窗口，整体重新缩放
+    rescaleAll();
+}
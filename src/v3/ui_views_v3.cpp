@@ -5,63 +5,11 @@
 // 全局UI管理器实例
 UIManagerV3* uiManagerV3 = nullptr;
 
-// UIViewV3 基类实现
-void UIViewV3::drawTitle(const String& title, int y) {
-    display->setFont(u8g2_font_6x10_tf);
-    int width = display->getUTF8Width(title.c_str());
-    int x = (128 - width) / 2;
-    display->drawUTF8(x, y, title.c_str());
-    // 移除顶部横线：display->drawHLine(10, y + 2, 108);
-}
-
-void UIViewV3::drawMenuItem(const String& text, int y, bool selected) {
-    display->setFont(u8g2_font_6x10_tf);
-
-    if (selected) {
-        // 文字闪烁效果：每500ms切换一次显示状态
-        uint32_t current_time = millis();
-        bool blink_state = (current_time / 500) % 2 == 0;
-
-        if (blink_state) {
-            // 显示文字
-            display->drawUTF8(4, y, text.c_str());
-        }
-        // 不显示状态时什么都不画，实现闪烁效果
-    } else {
-        // 非选中项正常显示
-        display->drawUTF8(4, y, text.c_str());
-    }
-}
-
-void UIViewV3::drawProgressBar(int x, int y, int width, int height, float progress) {
-    // 绘制边框
-    display->drawFrame(x, y, width, height);
-    
-    // 绘制进度
-    int fill_width = (int)(progress * (width - 2));
-    if (fill_width > 0) {
-        display->drawBox(x + 1, y + 1, fill_width, height - 2);
-    }
-}
-
-void UIViewV3::drawValue(const String& label, const String& value, int y) {
-    display->setFont(u8g2_font_6x10_tf);
-    display->drawUTF8(4, y, label.c_str());
-    
-    int value_width = display->getUTF8Width(value.c_str());
-    display->drawUTF8(124 - value_width, y, value.c_str());
-}
-
-void UIViewV3::drawCenteredText(const String& text, int y) {
-    display->setFont(u8g2_font_6x10_tf);
-    int width = display->getUTF8Width(text.c_str());
-    int x = (128 - width) / 2;
-    display->drawUTF8(x, y, text.c_str());
-}
-
 // MainMenuViewV3 实现
 MainMenuViewV3::MainMenuViewV3(U8G2* disp) : 
-    UIViewV3(disp), selected_index(0), animation_time(0) {
+    UIViewV3(disp), selected_index(0), animation_time(0), selection_time(0), prefetch_requested(false),
+    menu_list(4, 12, 12, 4) {  // 起始位置上移，间距12让4个选项更紧凑
+    screen.add(&menu_list);
     initMenuItems();
 }
 
@@ -71,12 +19,19 @@ void MainMenuViewV3::initMenuItems() {
     menu_items.push_back(MenuItemV3("History", "", UI_VIEW_HISTORY));
     menu_items.push_back(MenuItemV3("Target Timer", "", UI_VIEW_TARGET_TIMER));
     menu_items.push_back(MenuItemV3("Settings", "", UI_VIEW_SETTINGS));
+    
+    for (int i = 0; i < menu_items.size() && i < menu_list.getRowCount(); i++) {
+        menu_list.setRow(i, menu_items[i].title.c_str());
+    }
 }
 
 void MainMenuViewV3::enter() {
     active = true;
     selected_index = 0;
     animation_time = millis();
+    selection_time = animation_time;
+    prefetch_requested = false;
+    screen.invalidateAll();
     Serial.println("Entering main menu");
 }
 
@@ -92,79 +47,22 @@ void MainMenuViewV3::update() {
     if (current_time - last_update_time >= 100) { // 10FPS更新
         last_update_time = current_time;
     }
-}
-
-void MainMenuViewV3::render() {
-    if (!active) {
-        Serial.println("Main menu view not active");
-        return;
-    }
-
-    Serial.println("Rendering main menu view");
-    display->clearBuffer();
-
-    // 绘制菜单项 (不再绘制标题)
-    renderMenuItems();
-
-    // 不再绘制状态栏，保持界面简洁
-    // renderStatusBar();
-
-    display->sendBuffer();
-    Serial.println("Main menu rendering completed");
-}
-
-void MainMenuViewV3::renderMenuItems() {
-    int start_y = 12;  // 进一步上移起始位置
-    int item_height = 12;  // 减小间距，让4个选项更紧凑
-
-    Serial.printf("Rendering menu items, total: %d, selected: %d\n", menu_items.size(), selected_index);
-
-    for (int i = 0; i < menu_items.size() && i < 4; i++) {
-        int y = start_y + i * item_height;
-        bool selected = (i == selected_index);
-
-        Serial.printf("Rendering menu item %d: %s (y=%d, selected=%s)\n",
-                     i, menu_items[i].title.c_str(), y, selected ? "yes" : "no");
-
-        // 使用闪烁效果绘制选中项
-        drawMenuItemWithBlink(menu_items[i].title, y, selected);
+    
+    // 光标停在History上时提前在后台加载历史数据，进入页面时直接显示
+    if (!prefetch_requested && getSelectedView() == UI_VIEW_HISTORY &&
+        current_time - selection_time >= V3_HISTORY_PREFETCH_DWELL_MS) {
+        dataManagerV3.prefetchHistorySummaries(V3_HISTORY_DAYS);
+        prefetch_requested = true;
     }
 }
 
-void MainMenuViewV3::drawMenuItemWithBlink(const String& text, int y, bool selected) {
-    display->setFont(u8g2_font_6x10_tf);
-
-    if (selected) {
-        // 文字闪烁效果：每500ms切换一次显示状态
-        uint32_t current_time = millis();
-        bool blink_state = (current_time / 500) % 2 == 0;
+void MainMenuViewV3::render() {
+    if (!active) return;
 
-        if (blink_state) {
-            // 显示文字
-            display->drawUTF8(4, y, text.c_str());
-        }
-        // 不显示状态时什么都不画，实现闪烁效果
-    } else {
-        // 非选中项正常显示
-        display->drawUTF8(4, y, text.c_str());
-    }
-}
-
-void MainMenuViewV3::renderStatusBar() {
-    // 绘制底部状态信息
-    display->setFont(u8g2_font_5x7_tf);
-    
-    // 今日统计
-    if (dataManagerV3.isInitialized()) {
-        String status = "Today: " + String(dataManagerV3.getTotalJumpsToday()) + " jumps";
-        display->drawUTF8(4, 62, status.c_str());
-
-        // 目标进度
-        float progress = dataManagerV3.getTodayTargetProgress();
-        String progress_text = String((int)(progress * 100)) + "%";
-        int width = display->getUTF8Width(progress_text.c_str());
-        display->drawUTF8(124 - width, 62, progress_text.c_str());
-    }
+    // 只有选中项闪烁和光标移动会改变画面，其余帧不发送数据（不再绘制标题和状态栏，保持界面简洁）
+    menu_list.setSelected(selected_index);
+    menu_list.setHighlightVisible(blinkOn());
+    screen.render(display);
 }
 
 bool MainMenuViewV3::handleButton(button_event_t event) {
@@ -200,6 +98,8 @@ void MainMenuViewV3::updateSelection(int direction) {
     } else if (selected_index >= menu_items.size()) {
         selected_index = 0;
     }
+    selection_time = millis();
+    prefetch_requested = false;
     
     Serial.printf("菜单选择: %d - %s\n", selected_index, menu_items[selected_index].title.c_str());
 }
@@ -210,7 +110,21 @@ DifficultySelectViewV3::DifficultySelectViewV3(U8G2* disp) :
     selected_difficulty(DIFFICULTY_NORMAL),
     confirmed_difficulty(DIFFICULTY_NORMAL),
     animation_time(0),
-    selection_confirmed(false) {
+    selection_confirmed(false),
+    title_label(0, 0, u8g2_font_6x10_tf, UI_ALIGN_CENTER),     // 标题上移12个单位：12 - 12 = 0
+    option_list(4, 13, 12, DIFFICULTY_COUNT),                  // 上移12个单位：25 - 12 = 13
+    detail_label(0, 56, u8g2_font_6x10_tf, UI_ALIGN_CENTER),   // 64 - 8 = 56px，预留足够空间
+    confirm_name_label(0, 18, u8g2_font_6x10_tf, UI_ALIGN_CENTER),
+    confirm_ready_label(0, 33, u8g2_font_6x10_tf, UI_ALIGN_CENTER),
+    confirm_prompt_label(0, 46, u8g2_font_6x10_tf, UI_ALIGN_CENTER) {
+    screen.add(&title_label);
+    screen.add(&option_list);
+    screen.add(&detail_label);
+    screen.add(&confirm_name_label);
+    screen.add(&confirm_ready_label);
+    screen.add(&confirm_prompt_label);
+    confirm_ready_label.setText("Ready to Exercise...");
+    confirm_prompt_label.setText("Press to Start");
 }
 
 void DifficultySelectViewV3::enter() {
@@ -218,6 +132,14 @@ void DifficultySelectViewV3::enter() {
     selected_difficulty = DIFFICULTY_NORMAL;
     selection_confirmed = false;
     animation_time = millis();
+    
+    for (int i = 0; i < DIFFICULTY_COUNT; i++) {
+        const difficulty_config_t* config = V3Config::getDifficultyConfig((game_difficulty_t)i);
+        char text[V3_UI_TEXT_MAX];
+        snprintf(text, sizeof(text), "%s (%d%%)", config->name_en, (int)(config->multiplier * 100));
+        option_list.setRow(i, text);
+    }
+    screen.invalidateAll();
     Serial.println("🎯 进入难度选择");
 }
 
@@ -238,65 +160,41 @@ void DifficultySelectViewV3::update() {
 void DifficultySelectViewV3::render() {
     if (!active) return;
     
-    display->clearBuffer();
+    // 两种画面共用一棵控件树，切换时隐藏的控件只擦除自己的区域
+    bool confirmed = selection_confirmed;
+    option_list.setVisible(!confirmed);
+    detail_label.setVisible(!confirmed);
+    confirm_name_label.setVisible(confirmed);
+    confirm_ready_label.setVisible(confirmed);
     
-    if (selection_confirmed) {
-        renderConfirmation();
+    if (confirmed) {
+        bindConfirmation();
     } else {
-        // 绘制标题（上移12个单位）
-        drawTitle("Select Difficulty", 12 - 12);  // 12 - 12 = 0
-
-        // 绘制难度选项
-        renderDifficultyOptions();
-
-        // 绘制难度详情
-        renderDifficultyDetails();
+        title_label.setText("Select Difficulty");
+        confirm_prompt_label.setVisible(false);
+        bindDifficultyOptions();
     }
     
-    display->sendBuffer();
+    screen.render(display);
 }
 
-void DifficultySelectViewV3::renderDifficultyOptions() {
-    int start_y = 25 - 12;  // 上移12个单位：25 - 12 = 13
-    int item_height = 12;
+void DifficultySelectViewV3::bindDifficultyOptions() {
+    option_list.setSelected((int)selected_difficulty);
+    option_list.setHighlightVisible(blinkOn());
 
-    for (int i = 0; i < DIFFICULTY_COUNT; i++) {
-        int y = start_y + i * item_height;
-        bool selected = (i == (int)selected_difficulty);
-
-        const difficulty_config_t* config = V3Config::getDifficultyConfig((game_difficulty_t)i);
-        String text = String(config->name_en) + " (" + String((int)(config->multiplier * 100)) + "%)";
-
-        drawMenuItem(text, y, selected);
-    }
-}
-
-void DifficultySelectViewV3::renderDifficultyDetails() {
     const difficulty_config_t* config = V3Config::getDifficultyConfig(selected_difficulty);
-
-    display->setFont(u8g2_font_5x7_tf);
-
-    int detail_y = 56;  // 调整位置确保文字完整显示：64 - 8 = 56px（预留足够空间）
-    String target_text = "Target: " + String(config->target_jumps) + " jumps/" + String(config->target_time) + " sec";
-    drawCenteredText(target_text, detail_y);
+    detail_label.setTextf("Target: %lu jumps/%lu sec",
+                          (unsigned long)config->target_jumps, (unsigned long)config->target_time);
 }
 
-void DifficultySelectViewV3::renderConfirmation() {
-    drawTitle("Difficulty Selected", 12 - 12);  // 上移12个单位：12 - 12 = 0
+void DifficultySelectViewV3::bindConfirmation() {
+    title_label.setText("Difficulty Selected");
 
     const difficulty_config_t* config = V3Config::getDifficultyConfig(confirmed_difficulty);
+    confirm_name_label.setText(config->name_en);
 
-    display->setFont(u8g2_font_6x10_tf);
-    drawCenteredText(config->name_en, 30 - 12);  // 上移12个单位：30 - 12 = 18
-
-    display->setFont(u8g2_font_5x7_tf);
-    drawCenteredText("Ready to Exercise...", 45 - 12);  // 上移12个单位：45 - 12 = 33
-
-    // 绘制动画效果
-    uint32_t elapsed = millis() - animation_time;
-    if ((elapsed / 500) % 2 == 0) {
-        drawCenteredText("Press to Start", 58 - 12);  // 上移12个单位：58 - 12 = 46
-    }
+    // 提示文字闪烁
+    confirm_prompt_label.setVisible(blinkOn(500, animation_time));
 }
 
 bool DifficultySelectViewV3::handleButton(button_event_t event) {
@@ -355,14 +253,45 @@ void DifficultySelectViewV3::confirmSelection() {
 
 // HistoryViewV3 实现
 HistoryViewV3::HistoryViewV3(U8G2* disp) :
-    UIViewV3(disp), current_page(0), total_pages(1), last_data_update(0) {
+    UIViewV3(disp), history_loaded(false), history_version(0), current_page(0),
+    total_pages(V3_HISTORY_DAYS + 2 + V3_TREND_WINDOW_COUNT), last_data_update(0), loading_start(0),
+    trend_version(UINT32_MAX), trend_shown(-1),
+    title_label(0, 2, u8g2_font_6x10_tf, UI_ALIGN_CENTER),     // 下移2个单位，无横线
+    value_rows{UIValueV3(12), UIValueV3(22), UIValueV3(32), UIValueV3(42)},
+    message_label(0, 22, u8g2_font_6x10_tf, UI_ALIGN_CENTER),
+    message_label2(0, 29, u8g2_font_6x10_tf, UI_ALIGN_CENTER),
+    subtitle_label(0, 12, u8g2_font_5x7_tf, UI_ALIGN_CENTER),
+    trend_chart(4, 47, 120, V3_TREND_PLOT_HEIGHT),             // 基线Y=47，柱区Y=23-46
+    page_label(0, 52, u8g2_font_6x10_tf, UI_ALIGN_CENTER) {
+    screen.add(&title_label);
+    for (UIValueV3& row : value_rows) {
+        screen.add(&row);
+    }
+    screen.add(&message_label);
+    screen.add(&message_label2);
+    screen.add(&subtitle_label);
+    screen.add(&trend_chart);
+    screen.add(&page_label);
+    subtitle_label.setVisible(false);
+    trend_chart.setVisible(false);
 }
 
 void HistoryViewV3::enter() {
     active = true;
     current_page = 0;
-    loadHistoryData();
-    Serial.println("📊 进入历史数据查看");
+    total_pages = V3_HISTORY_DAYS + 2 + V3_TREND_WINDOW_COUNT; // 汇总页 + 周统计页 + 每日页面 + 7/30/90天趋势页
+    trend_shown = -1;
+    
+    // 菜单停留时已预取的数据直接使用，否则后台加载，汇总页不依赖每日数据可以立即显示
+    history_loaded = false;
+    history_version = UINT32_MAX;
+    pollHistoryData();
+    if (!history_loaded) {
+        requestHistoryData();
+    }
+    last_data_update = millis();
+    screen.invalidateAll();
+    Serial.printf("📊 进入历史数据查看%s\n", history_loaded ? "（已预取）" : "（后台加载中）");
 }
 
 void HistoryViewV3::exit() {
@@ -378,9 +307,12 @@ void HistoryViewV3::update() {
         last_update_time = current_time;
     }
 
-    // 定期更新数据
-    if (current_time - last_data_update >= 5000) { // 5秒更新一次
-        loadHistoryData();
+    // 取走后台加载完成的数据
+    pollHistoryData();
+
+    // 定期在后台刷新，旧数据继续显示到新数据就绪
+    if (current_time - last_data_update >= V3_HISTORY_REFRESH_MS) {
+        requestHistoryData();
         last_data_update = current_time;
     }
 }
@@ -388,202 +320,213 @@ void HistoryViewV3::update() {
 void HistoryViewV3::render() {
     if (!active) return;
 
-    display->clearBuffer();
+    // 趋势页面在最后，数据来自内存中的趋势序列，不等待后台加载
+    int trend_page = current_page - (total_pages - V3_TREND_WINDOW_COUNT);
+    if (trend_page < 0) {
+        subtitle_label.setVisible(false);
+        trend_chart.setVisible(false);
+    }
 
     if (current_page == 0) {
-        renderSummaryPage();
+        bindSummaryPage();
     } else if (current_page == 1) {
-        renderWeeklyPage();
-    } else if (current_page <= history_data.size() + 1) {
-        renderHistoryPage();
+        bindWeeklyPage();
+    } else if (trend_page >= 0) {
+        bindTrendPage((trend_window_v3_t)trend_page);
+    } else if (!history_loaded) {
+        bindLoadingPlaceholder();
+    } else {
+        bindHistoryPage();
     }
-    // 暂时注释掉趋势图页面
-    // else {
-    //     renderTrendPage();
-    // }
 
-    display->sendBuffer();
+    screen.render(display);
 }
 
-void HistoryViewV3::loadHistoryData() {
-    if (dataManagerV3.isInitialized()) {
-        history_data = dataManagerV3.getHistoryData(7); // 最近7天
-        total_pages = history_data.size() + 2; // 数据页 + 汇总页 + 周统计页 (暂时去掉趋势页)
+void HistoryViewV3::requestHistoryData() {
+    if (!dataManagerV3.isInitialized()) return;
+    if (!history_loaded) {
+        loading_start = millis();
+    }
+    dataManagerV3.prefetchHistorySummaries(V3_HISTORY_DAYS); // 最近7天，页面只显示每日汇总
+}
+
+void HistoryViewV3::pollHistoryData() {
+    if (!dataManagerV3.takeHistorySummaries(history_data, &history_version)) return;
+    
+    if (!history_loaded && loading_start != 0) {
+        Serial.printf("📊 历史数据就绪: %d 天, 等待 %lu ms\n", (int)history_data.size(), millis() - loading_start);
+    }
+    history_loaded = true;
+    loading_start = 0;
+    
+    // 实际天数少于预设页数时收缩页数，正在看趋势页时保持在同一个趋势页
+    int trend_page = current_page - (total_pages - V3_TREND_WINDOW_COUNT);
+    total_pages = history_data.size() + 2 + V3_TREND_WINDOW_COUNT;
+    if (trend_page >= 0) {
+        current_page = total_pages - V3_TREND_WINDOW_COUNT + trend_page;
+    } else if (current_page >= total_pages - V3_TREND_WINDOW_COUNT) {
+        current_page = total_pages - V3_TREND_WINDOW_COUNT - 1;
     }
 }
 
-void HistoryViewV3::renderSummaryPage() {
-    // 绘制无横线标题
-    display->setFont(u8g2_font_6x10_tf);
-    int width = display->getUTF8Width("Fitness Summary");
-    int x = (128 - width) / 2;
-    display->drawUTF8(x, 2, "Fitness Summary");  // 下移2个单位，无横线
+void HistoryViewV3::showRows(bool show) {
+    for (UIValueV3& row : value_rows) {
+        row.setVisible(show);
+    }
+}
+
+void HistoryViewV3::showMessage(const char* line1, int16_t y1, const char* line2, int16_t y2) {
+    message_label.setVisible(line1 != nullptr);
+    message_label2.setVisible(line2 != nullptr);
+    if (line1) {
+        message_label.setText(line1);
+        message_label.setPosition(0, y1);
+    }
+    if (line2) {
+        message_label2.setText(line2);
+        message_label2.setPosition(0, y2);
+    }
+}
+
+void HistoryViewV3::bindLoadingPlaceholder() {
+    title_label.setVisible(false);
+    showRows(false);
+
+    // 三个点依次出现，表示后台仍在加载
+    static const char* const frames[] = { "Loading", "Loading.", "Loading..", "Loading..." };
+    showMessage(frames[(millis() / 250) % 4], 22);
+
+    page_label.setTextf("Day %d (%d/%d)", current_page - 1, current_page + 1, total_pages);
+}
+
+void HistoryViewV3::bindSummaryPage() {
+    title_label.setVisible(true);
+    title_label.setText("Fitness Summary");
 
     if (dataManagerV3.isInitialized()) {
         const HistoryStatsV3& stats = dataManagerV3.getHistoryStats();
 
-        display->setFont(u8g2_font_6x10_tf);
-
-        // 健身导向的数据展示 - 下移2个单位
-        drawValue("Workout Days:", String(stats.streak_days), 12);
-        drawValue("Total Time:", DataUtilsV3::formatTime(stats.total_time), 22);
-        drawValue("Calories Burned:", String((int)stats.total_calories), 32);
-        drawValue("Total Jumps:", String(stats.total_jumps), 42);
+        // 健身导向的数据展示
+        showRows(true);
+        showMessage(nullptr, 0);
+        value_rows[0].setLabel("Workout Days:");
+        value_rows[0].setValue((int32_t)dataManagerV3.getStreakDays());
+        value_rows[1].setLabel("Total Time:");
+        if (value_rows[1].bind(stats.total_time)) {
+            value_rows[1].setValue(DataUtilsV3::formatTime(stats.total_time).c_str());
+        }
+        value_rows[2].setLabel("Calories Burned:");
+        value_rows[2].setValue((int32_t)stats.total_calories);
+        value_rows[3].setLabel("Total Jumps:");
+        value_rows[3].setValue((int32_t)stats.total_jumps);
     } else {
-        display->setFont(u8g2_font_6x10_tf);
-        drawCenteredText("Start exercising to", 17);
-        drawCenteredText("see your progress!", 29);
+        showRows(false);
+        showMessage("Start exercising to", 17, "see your progress!", 29);
     }
 
     // 页面指示器
-    display->setFont(u8g2_font_5x7_tf);
-    String page_info = "Summary (" + String(current_page + 1) + "/" + String(total_pages) + ")";
-    drawCenteredText(page_info, 52);
+    page_label.setTextf("Summary (%d/%d)", current_page + 1, total_pages);
 }
 
-void HistoryViewV3::renderWeeklyPage() {
-    // 绘制无横线标题
-    display->setFont(u8g2_font_6x10_tf);
-    int width = display->getUTF8Width("This Week");
-    int x = (128 - width) / 2;
-    display->drawUTF8(x, 2, "This Week");  // 下移2个单位，无横线
+void HistoryViewV3::bindWeeklyPage() {
+    title_label.setVisible(true);
+    title_label.setText("This Week");
 
     if (dataManagerV3.isInitialized()) {
-        display->setFont(u8g2_font_6x10_tf);
-
-        // 本周健身数据 - 下移2个单位
-        drawValue("Workouts:", String(dataManagerV3.getWeeklyWorkouts()), 12);
-        drawValue("Total Time:", DataUtilsV3::formatTime(dataManagerV3.getWeeklyTime()), 22);
-        drawValue("Calories:", String((int)dataManagerV3.getWeeklyCalories()), 32);
-        drawValue("Goals Met:", String(dataManagerV3.getWeeklyGoalsAchieved()), 42);
+        // 本周健身数据
+        showRows(true);
+        showMessage(nullptr, 0);
+        value_rows[0].setLabel("Workouts:");
+        value_rows[0].setValue((int32_t)dataManagerV3.getWeeklyWorkouts());
+        value_rows[1].setLabel("Total Time:");
+        uint32_t weekly_time = dataManagerV3.getWeeklyTime();
+        if (value_rows[1].bind(weekly_time)) {
+            value_rows[1].setValue(DataUtilsV3::formatTime(weekly_time).c_str());
+        }
+        value_rows[2].setLabel("Calories:");
+        value_rows[2].setValue((int32_t)dataManagerV3.getWeeklyCalories());
+        value_rows[3].setLabel("Goals Met:");
+        value_rows[3].setValue((int32_t)dataManagerV3.getWeeklyGoalsAchieved());
     } else {
-        display->setFont(u8g2_font_6x10_tf);
-        drawCenteredText("No weekly data", 22);
+        showRows(false);
+        showMessage("No weekly data", 22);
     }
 
     // 页面指示器
-    display->setFont(u8g2_font_5x7_tf);
-    String page_info = "Week (" + String(current_page + 1) + "/" + String(total_pages) + ")";
-    drawCenteredText(page_info, 52);
+    page_label.setTextf("Week (%d/%d)", current_page + 1, total_pages);
 }
 
-void HistoryViewV3::renderHistoryPage() {
+void HistoryViewV3::bindHistoryPage() {
     int data_index = current_page - 2; // 调整索引，因为前面有汇总页和周统计页
+    showMessage(nullptr, 0);
     if (data_index >= 0 && data_index < history_data.size()) {
-        const DailyDataV3& daily_data = history_data[data_index];
-
-        // 绘制无横线标题
-        display->setFont(u8g2_font_6x10_tf);
-        int width = display->getUTF8Width(daily_data.date.c_str());
-        int x = (128 - width) / 2;
-        display->drawUTF8(x, 2, daily_data.date.c_str());  // 下移2个单位，无横线
-
-        renderDayData(daily_data, 12);  // 内容下移2个单位
+        const DailySummaryV3& summary = history_data[data_index];
+        char date_str[11];
+        DataUtilsV3::formatEpochDay(summary.epoch_day, date_str, sizeof(date_str));
+
+        title_label.setVisible(true);
+        title_label.setText(date_str);
+        showRows(true);
+        bindDayData(summary.total);
+    } else {
+        title_label.setVisible(false);
+        showRows(false);
     }
 
     // 页面指示器
-    display->setFont(u8g2_font_5x7_tf);
-    String page_info = "Day " + String(data_index + 1) + " (" + String(current_page + 1) + "/" + String(total_pages) + ")";
-    drawCenteredText(page_info, 52);
+    page_label.setTextf("Day %d (%d/%d)", data_index + 1, current_page + 1, total_pages);
 }
 
-void HistoryViewV3::renderDayData(const DailyDataV3& data, int y) {
-    display->setFont(u8g2_font_6x10_tf);
-
+void HistoryViewV3::bindDayData(const DailyTotalV3& total) {
     // 健身导向的每日数据展示
-    drawValue("Workouts:", String(data.daily_total.session_count), y);
-    drawValue("Exercise Time:", DataUtilsV3::formatTime(data.daily_total.total_duration), y + 10);
-    drawValue("Calories:", String((int)data.daily_total.total_calories), y + 20);
+    value_rows[0].setLabel("Workouts:");
+    value_rows[0].setValue((int32_t)total.session_count);
+    value_rows[1].setLabel("Exercise Time:");
+    if (value_rows[1].bind(total.total_duration)) {
+        value_rows[1].setValue(DataUtilsV3::formatTime(total.total_duration).c_str());
+    }
+    value_rows[2].setLabel("Calories:");
+    value_rows[2].setValue((int32_t)total.total_calories);
 
     // 显示目标达成情况
-    if (data.daily_total.targets_achieved > 0) {
-        drawValue("Goals Met:", String(data.daily_total.targets_achieved), y + 30);
+    if (total.targets_achieved > 0) {
+        value_rows[3].setLabel("Goals Met:");
+        value_rows[3].setValue((int32_t)total.targets_achieved);
     } else {
-        drawValue("Jumps:", String(data.daily_total.total_jumps), y + 30);
+        value_rows[3].setLabel("Jumps:");
+        value_rows[3].setValue((int32_t)total.total_jumps);
     }
 }
 
-// 暂时注释掉趋势图页面，避免显示问题
-/*
-void HistoryViewV3::renderTrendPage() {
-    // 绘制无横线标题
-    display->setFont(u8g2_font_6x10_tf);
-    int width = display->getUTF8Width("Exercise Trend");
-    int x = (128 - width) / 2;
-    display->drawUTF8(x, 2, "Exercise Trend");
-
-    // 检查是否有有效的历史数据
-    if (history_data.size() == 0 || !dataManagerV3.isInitialized()) {
-        display->setFont(u8g2_font_6x10_tf);
-        drawCenteredText("No trend data", 25);
+void HistoryViewV3::bindTrendPage(trend_window_v3_t which) {
+    title_label.setVisible(true);
+    title_label.setText("Exercise Trend");
+    showRows(false);
 
-        // 页面指示器
-        display->setFont(u8g2_font_5x7_tf);
-        String page_info = "Trend (" + String(current_page + 1) + "/" + String(total_pages) + ")";
-        drawCenteredText(page_info, 52);
-        return;
+    // 切换窗口时重新复制，同一窗口只在数据版本变化时复制
+    if (trend_shown != which) {
+        trend_shown = which;
+        trend_version = UINT32_MAX;
     }
-
-    // 绘制副标题
-    display->setFont(u8g2_font_5x7_tf);
-    drawCenteredText("7-Day Jump Trend", 12);
-
-    // 计算最大跳跃数，用于缩放
-    int max_jumps = 1; // 避免除零
-    for (const auto& data : history_data) {
-        if (data.daily_total.total_jumps > max_jumps) {
-            max_jumps = data.daily_total.total_jumps;
-        }
+    if (dataManagerV3.isInitialized()) {
+        dataManagerV3.getTrendWindow(which, trend_window, &trend_version);
     }
 
-    // 绘制简化的趋势图 - 使用点状图表
-    if (history_data.size() > 0 && history_data.size() <= 7) {
-        // 使用更简单的点状图表，避免条形图问题
-        int point_spacing = 15; // 点之间的间距
-        int total_width = (history_data.size() - 1) * point_spacing;
-        int start_x = (128 - total_width) / 2; // 居中显示
-
-        // 绘制基准线
-        int baseline_y = 38;
-        display->drawHLine(start_x - 10, baseline_y, total_width + 20);
-
-        for (int i = 0; i < history_data.size(); i++) {
-            int jumps = history_data[i].daily_total.total_jumps;
-
-            // 计算点的位置
-            int point_x = start_x + i * point_spacing;
-            int point_y = baseline_y;
-
-            // 根据跳跃数绘制不同高度的点或线
-            if (jumps > 0 && max_jumps > 0) {
-                int height = (jumps * 10) / max_jumps; // 最大高度10像素
-                if (height < 1) height = 1;
-                if (height > 10) height = 10;
-
-                // 绘制垂直线表示数据
-                for (int h = 0; h < height; h++) {
-                    display->drawPixel(point_x, baseline_y - h);
-                }
-
-                // 在顶部绘制一个点
-                display->drawPixel(point_x - 1, baseline_y - height);
-                display->drawPixel(point_x + 1, baseline_y - height);
-            } else {
-                // 无数据时只绘制基准点
-                display->drawPixel(point_x, baseline_y);
-            }
-
-            // 在基准线下方绘制日期标识点
-            display->drawPixel(point_x, baseline_y + 2);
-        }
+    if (!dataManagerV3.isInitialized() || trend_window.max_value == 0) {
+        subtitle_label.setVisible(false);
+        trend_chart.setVisible(false);
+        showMessage("No trend data", 25);
+    } else {
+        showMessage(nullptr, 0);
+        subtitle_label.setVisible(true);
+        subtitle_label.setTextf("%s Jump Trend", TrendSeriesV3::windowName(which));
+        trend_chart.setVisible(true);
+        trend_chart.setBars(trend_window.heights, trend_window.days);
     }
 
     // 页面指示器
-    display->setFont(u8g2_font_5x7_tf);
-    String page_info = "Trend (" + String(current_page + 1) + "/" + String(total_pages) + ")";
-    drawCenteredText(page_info, 52);
+    page_label.setTextf("Trend (%d/%d)", current_page + 1, total_pages);
 }
-*/
 
 bool HistoryViewV3::handleButton(button_event_t event) {
     if (!active) return false;
@@ -616,7 +559,19 @@ void HistoryViewV3::updatePage(int direction) {
 
 // SettingsViewV3 实现
 SettingsViewV3::SettingsViewV3(U8G2* disp) :
-    UIViewV3(disp), selected_item(0), editing_mode(false), edit_start_time(0) {
+    UIViewV3(disp), selected_item(0), editing_mode(false), edit_start_time(0), display_start_index(0),
+    title_label(0, 6, u8g2_font_6x10_tf, UI_ALIGN_CENTER),    // 进一步上移到Y=6，为设置项预留更多空间
+    item_list(4, 16, 8, MAX_VISIBLE_ITEMS),                     // Y=16 到 Y=56，每项8px，最多5项
+    scroll_bar(124, 16, 40),
+    edit_label(0, 58, u8g2_font_6x10_tf, UI_ALIGN_CENTER) {
+    screen.add(&title_label);
+    screen.add(&item_list);
+    screen.add(&scroll_bar);
+    screen.add(&edit_label);
+    title_label.setText("Settings");
+    edit_label.setText("Edit Mode - Press to Adjust");
+    // 设置项总数不超过可显示数量时不显示滚动条
+    scroll_bar.setVisible((int)SETTING_COUNT > MAX_VISIBLE_ITEMS);
 }
 
 void SettingsViewV3::enter() {
@@ -626,6 +581,7 @@ void SettingsViewV3::enter() {
     display_start_index = 0;  // 初始化轮播显示起始索引
     loadConfig();
     loadTargetSettings();
+    screen.invalidateAll();
     Serial.println("⚙️ 进入系统设置");
 }
 
@@ -654,16 +610,10 @@ void SettingsViewV3::update() {
 void SettingsViewV3::render() {
     if (!active) return;
 
-    display->clearBuffer();
-
-    drawTitle("Settings", 6);  // 进一步上移到Y=6，为设置项预留更多空间
-    renderSettingItems();
+    bindSettingItems();
+    edit_label.setVisible(editing_mode);
 
-    if (editing_mode) {
-        renderEditIndicator();
-    }
-
-    display->sendBuffer();
+    screen.render(display);
 }
 
 void SettingsViewV3::loadConfig() {
@@ -696,90 +646,40 @@ void SettingsViewV3::saveTargetSettings() {
     }
 }
 
-void SettingsViewV3::renderSettingItems() {
-    // 轮播显示逻辑：
-    // 标题: Y=6, 占用到Y=13
-    // 可用空间: Y=16 到 Y=56 = 40px
-    // 每项高度: 8px (u8g2_font_6x10_tf字体 + 间距)
-    // 最多显示: 5项 (40px / 8px = 5)
-    int start_y = 16;
-    int item_height = 8;
-
-    // 只渲染当前窗口内的设置项
-    int end_index = min(display_start_index + MAX_VISIBLE_ITEMS, (int)SETTING_COUNT);
-
-    for (int i = display_start_index; i < end_index; i++) {
-        int display_index = i - display_start_index;  // 在屏幕上的相对位置
-        int y = start_y + display_index * item_height;
-        bool selected = (i == selected_item);
-
-        String item_text = getSettingName(i) + ": " + getSettingValue(i);
-
-        display->setFont(u8g2_font_6x10_tf);  // 使用原来的字体大小保证可读性
-
-        if (selected) {
-            if (editing_mode) {
-                // 编辑模式：文字闪烁显示
-                uint32_t elapsed = millis() - edit_start_time;
-                if ((elapsed / 300) % 2 == 0) {
-                    display->drawUTF8(4, y, item_text.c_str());
-                }
-                // 不显示状态时什么都不画，实现闪烁效果
-            } else {
-                // 选中但未编辑：文字闪烁显示
-                uint32_t current_time = millis();
-                bool blink_state = (current_time / 500) % 2 == 0;
-                if (blink_state) {
-                    display->drawUTF8(4, y, item_text.c_str());
-                }
-                // 不显示状态时什么都不画，实现闪烁效果
-            }
-        } else {
-            // 非选中项正常显示
-            display->drawUTF8(4, y, item_text.c_str());
+void SettingsViewV3::bindSettingItems() {
+    // 轮播显示：只绑定当前窗口内的设置项，行文字不变时不重绘
+    for (int row = 0; row < MAX_VISIBLE_ITEMS; row++) {
+        int index = display_start_index + row;
+        if (index >= (int)SETTING_COUNT) {
+            item_list.setRow(row, "");
+            continue;
         }
-    }
-
-    // 绘制滚动指示器
-    renderScrollIndicator();
-}
 
-void SettingsViewV3::renderEditIndicator() {
-    display->setFont(u8g2_font_5x7_tf);  // 恢复合适的字体大小
-    drawCenteredText("Edit Mode - Press to Adjust", 58);
-}
-
-void SettingsViewV3::renderScrollIndicator() {
-    // 只有当设置项总数超过可显示数量时才显示滚动指示器
-    if ((int)SETTING_COUNT <= MAX_VISIBLE_ITEMS) {
-        return;
+        char value[24];
+        char item_text[V3_UI_TEXT_MAX];
+        formatSettingValue(index, value, sizeof(value));
+        snprintf(item_text, sizeof(item_text), "%s: %s", getSettingName(index), value);
+        item_list.setRow(row, item_text);
     }
 
-    // 在屏幕右侧绘制滚动条
-    int scroll_x = 124;  // 滚动条X位置
-    int scroll_y_start = 16;  // 滚动条起始Y位置
-    int scroll_height = 40;   // 滚动条总高度
-
-    // 计算滚动条位置和大小
-    float scroll_ratio = (float)display_start_index / ((int)SETTING_COUNT - MAX_VISIBLE_ITEMS);
-    int indicator_height = max(2, scroll_height * MAX_VISIBLE_ITEMS / (int)SETTING_COUNT);
-    int indicator_y = scroll_y_start + (scroll_height - indicator_height) * scroll_ratio;
-
-    // 绘制滚动条背景
-    display->drawVLine(scroll_x, scroll_y_start, scroll_height);
-
-    // 绘制滚动指示器
-    for (int i = 0; i < indicator_height; i++) {
-        display->drawPixel(scroll_x - 1, indicator_y + i);
-        display->drawPixel(scroll_x + 1, indicator_y + i);
+    // 选中项闪烁：编辑模式300ms，普通模式500ms
+    item_list.setSelected(selected_item - display_start_index);
+    if (editing_mode) {
+        item_list.setHighlightVisible(blinkOn(300, edit_start_time));
+    } else {
+        item_list.setHighlightVisible(blinkOn());
     }
+
+    scroll_bar.setWindow(display_start_index, MAX_VISIBLE_ITEMS, SETTING_COUNT);
 }
 
-String SettingsViewV3::getSettingName(int index) {
+const char* SettingsViewV3::getSettingName(int index) {
     switch (index) {
         case SETTING_VOLUME: return "Volume";
         case SETTING_DIFFICULTY: return "Difficulty";
         case SETTING_SOUND_ENABLED: return "Sound";
+        case SETTING_AUTO_SLEEP: return "Auto Sleep";
+        case SETTING_SLEEP_TIMEOUT: return "Sleep After";
         case SETTING_TARGET_ENABLED: return "Target Enable";
         case SETTING_TARGET_JUMPS: return "Target Jumps";
         case SETTING_TARGET_TIME: return "Target Time";
@@ -790,28 +690,41 @@ String SettingsViewV3::getSettingName(int index) {
     }
 }
 
-String SettingsViewV3::getSettingValue(int index) {
+void SettingsViewV3::formatSettingValue(int index, char* buf, size_t len) {
     switch (index) {
         case SETTING_VOLUME:
-            return String(config.volume) + "%";
+            snprintf(buf, len, "%d%%", config.volume);
+            break;
         case SETTING_DIFFICULTY:
-            return V3Config::getDifficultyName(config.default_difficulty);
+            snprintf(buf, len, "%s", V3Config::getDifficultyName(config.default_difficulty));
+            break;
         case SETTING_SOUND_ENABLED:
-            return config.sound_enabled ? "On" : "Off";
+            snprintf(buf, len, "%s", config.sound_enabled ? "On" : "Off");
+            break;
+        case SETTING_AUTO_SLEEP:
+            snprintf(buf, len, "%s", config.auto_sleep ? "On" : "Off");
+            break;
+        case SETTING_SLEEP_TIMEOUT:
+            snprintf(buf, len, "%lu min", (unsigned long)(config.sleep_timeout / 60));
+            break;
         case SETTING_TARGET_ENABLED:
-            return target_settings.enabled ? "On" : "Off";
+            snprintf(buf, len, "%s", target_settings.enabled ? "On" : "Off");
+            break;
         case SETTING_TARGET_JUMPS:
-            return String(target_settings.target_jumps);
+            snprintf(buf, len, "%lu", (unsigned long)target_settings.target_jumps);
+            break;
         case SETTING_TARGET_TIME:
-            return String(target_settings.target_time) + " sec";
+            snprintf(buf, len, "%lu sec", (unsigned long)target_settings.target_time);
+            break;
         case SETTING_TARGET_CALORIES:
-            return String((int)target_settings.target_calories);
+            snprintf(buf, len, "%d", (int)target_settings.target_calories);
+            break;
         case SETTING_RESET_DATA:
-            return "Execute";
-        case SETTING_BACK:
-            return "";
+            snprintf(buf, len, "Execute");
+            break;
         default:
-            return "";
+            buf[0] = '\0';
+            break;
     }
 }
 
@@ -859,7 +772,7 @@ void SettingsViewV3::updateSelection(int direction) {
     // 更新轮播显示窗口
     updateDisplayWindow();
 
-    Serial.printf("设置选择: %s\n", getSettingName(selected_item).c_str());
+    Serial.printf("设置选择: %s\n", getSettingName(selected_item));
 }
 
 void SettingsViewV3::updateDisplayWindow() {
@@ -888,9 +801,9 @@ void SettingsViewV3::toggleEditMode() {
     editing_mode = !editing_mode;
     if (editing_mode) {
         edit_start_time = millis();
-        Serial.printf("Start editing: %s\n", getSettingName(selected_item).c_str());
+        Serial.printf("Start editing: %s\n", getSettingName(selected_item));
     } else {
-        Serial.printf("End editing: %s\n", getSettingName(selected_item).c_str());
+        Serial.printf("End editing: %s\n", getSettingName(selected_item));
         saveConfig();
         saveTargetSettings();
     }
@@ -920,6 +833,21 @@ void SettingsViewV3::adjustValue(int direction) {
             Serial.printf("Sound: %s\n", config.sound_enabled ? "On" : "Off");
             break;
 
+        case SETTING_AUTO_SLEEP:
+            config.auto_sleep = !config.auto_sleep;
+            Serial.printf("Auto sleep: %s\n", config.auto_sleep ? "On" : "Off");
+            break;
+
+        case SETTING_SLEEP_TIMEOUT:
+            {
+                int32_t timeout = (int32_t)config.sleep_timeout + direction * 60; // 每次调整1分钟
+                if (timeout > 3600) timeout = 3600; // 最大60分钟
+                if (timeout < 60) timeout = 60; // 最小1分钟
+                config.sleep_timeout = timeout;
+                Serial.printf("Sleep after: %lu sec\n", (unsigned long)config.sleep_timeout);
+            }
+            break;
+
         case SETTING_TARGET_ENABLED:
             target_settings.enabled = !target_settings.enabled;
             Serial.printf("Target enabled: %s\n", target_settings.enabled ? "On" : "Off");
@@ -950,12 +878,23 @@ void SettingsViewV3::adjustValue(int direction) {
 
 // TargetTimerViewV3 简化实现（暂时）
 TargetTimerViewV3::TargetTimerViewV3(U8G2* disp) :
-    UIViewV3(disp), timer_start_time(0), target_duration(0), timer_active(false), target_achieved(false) {
+    UIViewV3(disp), timer_start_time(0), target_duration(0), timer_active(false), target_achieved(false),
+    shown_elapsed(UINT32_MAX),
+    title_label(0, 12, u8g2_font_6x10_tf, UI_ALIGN_CENTER),
+    target_label(0, 25, u8g2_font_6x10_tf, UI_ALIGN_CENTER),
+    timer_label(0, 45, u8g2_font_6x10_tf, UI_ALIGN_CENTER),
+    progress_bar(14, 55, 100, 6) {
+    screen.add(&title_label);
+    screen.add(&target_label);
+    screen.add(&timer_label);
+    screen.add(&progress_bar);
+    title_label.setText("Target Timer");
 }
 
 void TargetTimerViewV3::enter() {
     active = true;
     loadTargetSettings();
+    screen.invalidateAll();
     Serial.println("⏰ 进入目标计时");
 }
 
@@ -975,22 +914,17 @@ void TargetTimerViewV3::update() {
 void TargetTimerViewV3::render() {
     if (!active) return;
 
-    display->clearBuffer();
-
     // 检查是否需要屏幕闪烁效果
     if (is_target_flash_active() && !should_screen_flash_now()) {
-        // 闪烁状态：显示空白屏幕
-        display->sendBuffer();
+        // 闪烁状态：显示空白屏幕，下一次正常显示时整屏重绘
+        screen.blank(display);
         return;
     }
 
-    drawTitle("Target Timer", 12);
+    target_label.setTextf("Target: %lu sec", (unsigned long)target_duration);
+    bindTimer();
 
-    renderTargetInfo();
-    renderTimer();
-    renderProgress();
-
-    display->sendBuffer();
+    screen.render(display);
 }
 
 bool TargetTimerViewV3::handleButton(button_event_t event) {
@@ -1047,32 +981,24 @@ void TargetTimerViewV3::checkTargetAchievement() {
     }
 }
 
-void TargetTimerViewV3::renderTargetInfo() {
-    display->setFont(u8g2_font_6x10_tf);
-    String target_text = "Target: " + String(target_duration) + " sec";
-    drawCenteredText(target_text, 25);
-}
-
-void TargetTimerViewV3::renderTimer() {
+void TargetTimerViewV3::bindTimer() {
     if (timer_active) {
         uint32_t elapsed = (millis() - timer_start_time) / 1000;
-        String time_text = DataUtilsV3::formatTime(elapsed);
+        if (elapsed != shown_elapsed) {
+            shown_elapsed = elapsed;
+            timer_label.setText(DataUtilsV3::formatTime(elapsed).c_str());
+        }
 
-        display->setFont(u8g2_font_10x20_tf);
-        drawCenteredText(time_text, 45);
+        if (target_duration > 0) {
+            progress_bar.setVisible(true);
+            progress_bar.setProgress((float)elapsed / target_duration);
+        } else {
+            progress_bar.setVisible(false);
+        }
     } else {
-        display->setFont(u8g2_font_6x10_tf);
-        drawCenteredText(target_achieved ? "目标达成!" : "按键开始", 45);
-    }
-}
-
-void TargetTimerViewV3::renderProgress() {
-    if (timer_active && target_duration > 0) {
-        uint32_t elapsed = (millis() - timer_start_time) / 1000;
-        float progress = (float)elapsed / target_duration;
-        if (progress > 1.0f) progress = 1.0f;
-
-        drawProgressBar(14, 55, 100, 6, progress);
+        shown_elapsed = UINT32_MAX;
+        timer_label.setText(target_achieved ? "目标达成!" : "按键开始");
+        progress_bar.setVisible(false);
     }
 }
 
@@ -1148,12 +1074,20 @@ void UIManagerV3::update() {
     }
 }
 
-void UIManagerV3::render() {
+void UIManagerV3::invalidate() {
     if (current_view_instance) {
-        current_view_instance->render();
+        current_view_instance->invalidate();
     }
 }
 
+bool UIManagerV3::render() {
+    if (!current_view_instance) return false;
+
+    uint32_t flushes = current_view_instance->getFlushCount();
+    current_view_instance->render();
+    return current_view_instance->getFlushCount() != flushes;
+}
+
 bool UIManagerV3::handleButton(button_event_t event) {
     if (!current_view_instance) return false;
 
@@ -0,0 +1,442 @@
+#include "v3/ui_widgets_v3.h"
+#include <stdarg.h>
+
+// UIRectV3 实现
+UIRectV3 UIRectV3::unite(const UIRectV3& other) const {
+    if (isEmpty()) return other;
+    if (other.isEmpty()) return *this;
+
+    int16_t left = min(x, other.x);
+    int16_t top = min(y, other.y);
+    int16_t right = max(x + w, other.x + other.w);
+    int16_t bottom = max(y + h, other.y + other.h);
+    return UIRectV3(left, top, right - left, bottom - top);
+}
+
+// UIDirtyRegionV3 实现
+void UIDirtyRegionV3::add(const UIRectV3& pixel_rect) {
+    if (full || pixel_rect.isEmpty()) return;
+
+    // 裁剪到屏幕并转换为tile坐标（SSD1306按8x8 tile更新）
+    int16_t left = max<int16_t>(pixel_rect.x, 0);
+    int16_t top = max<int16_t>(pixel_rect.y, 0);
+    int16_t right = min<int16_t>(pixel_rect.x + pixel_rect.w, V3_UI_SCREEN_WIDTH);
+    int16_t bottom = min<int16_t>(pixel_rect.y + pixel_rect.h, V3_UI_SCREEN_HEIGHT);
+    if (left >= right || top >= bottom) return;
+
+    UIRectV3 tiles(left / 8, top / 8, (right + 7) / 8 - left / 8, (bottom + 7) / 8 - top / 8);
+
+    // 与已有区域相交时合并，避免同一tile重复发送
+    for (uint8_t i = 0; i < count; i++) {
+        const UIRectV3& r = rects[i];
+        if (tiles.intersects(r)) {
+            rects[i] = r.unite(tiles);
+            return;
+        }
+    }
+
+    if (count < V3_UI_MAX_DIRTY_RECTS) {
+        rects[count++] = tiles;
+    } else {
+        rects[count - 1] = rects[count - 1].unite(tiles);
+    }
+}
+
+uint16_t UIDirtyRegionV3::flush(U8G2* display) {
+    uint16_t tiles = 0;
+    for (uint8_t i = 0; i < count && !full; i++) {
+        tiles += rects[i].w * rects[i].h;
+    }
+
+    if (full || tiles > V3_UI_FULL_FLUSH_TILES) {
+        display->sendBuffer();
+        tiles = (V3_UI_SCREEN_WIDTH / 8) * (V3_UI_SCREEN_HEIGHT / 8);
+    } else {
+        for (uint8_t i = 0; i < count; i++) {
+            display->updateDisplayArea(rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+        }
+    }
+
+    clear();
+    return tiles;
+}
+
+// UIWidgetV3 实现
+void UIWidgetV3::setVisible(bool state) {
+    if (visible != state) {
+        visible = state;
+        dirty = true;
+    }
+}
+
+bool UIWidgetV3::invalidateIntersecting(const UIRectV3& rect) {
+    if (dirty || !bounds.intersects(rect)) return false;
+    dirty = true;
+    return true;
+}
+
+UIRectV3 UIWidgetV3::erase(U8G2* display, UIDirtyRegionV3& region) {
+    UIRectV3 erased = bounds;
+    if (!dirty || erased.isEmpty()) return UIRectV3();
+
+    display->setDrawColor(0);
+    display->drawBox(erased.x, erased.y, erased.w, erased.h);
+    display->setDrawColor(1);
+    region.add(erased);
+    bounds = UIRectV3();
+    return erased;
+}
+
+void UIWidgetV3::paint(U8G2* display, UIDirtyRegionV3& region) {
+    if (!dirty) return;
+
+    if (visible) {
+        bounds = measure(display);
+        draw(display);
+        region.add(bounds);
+    }
+    dirty = false;
+}
+
+UIRectV3 UIWidgetV3::eraseDirty(std::vector<UIWidgetV3*>& widgets, U8G2* display, UIDirtyRegionV3& region) {
+    // 擦除会削掉与之重叠的控件的像素，这些控件也要擦除重绘；已擦除的控件区域为空，循环必然结束
+    UIRectV3 total;
+    bool cascaded = true;
+    while (cascaded) {
+        cascaded = false;
+        for (UIWidgetV3* widget : widgets) {
+            if (!widget->isDirty()) continue;
+
+            UIRectV3 erased = widget->erase(display, region);
+            if (erased.isEmpty()) continue;
+            total = total.unite(erased);
+
+            for (UIWidgetV3* other : widgets) {
+                if (other != widget && other->invalidateIntersecting(erased)) {
+                    cascaded = true;
+                }
+            }
+        }
+    }
+    return total;
+}
+
+// UILabelV3 实现
+UILabelV3::UILabelV3(int16_t lx, int16_t ly, const uint8_t* f, ui_align_v3_t a) :
+    font(f), x(lx), y(ly), align(a) {
+    text[0] = '\0';
+}
+
+void UILabelV3::setText(const char* value) {
+    if (!value) value = "";
+    if (strncmp(text, value, sizeof(text) - 1) == 0) return;
+
+    strncpy(text, value, sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    dirty = true;
+}
+
+void UILabelV3::setTextf(const char* format, ...) {
+    char buf[V3_UI_TEXT_MAX];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    setText(buf);
+}
+
+void UILabelV3::setFont(const uint8_t* f) {
+    if (font != f) {
+        font = f;
+        dirty = true;
+    }
+}
+
+void UILabelV3::setPosition(int16_t lx, int16_t ly) {
+    if (x != lx || y != ly) {
+        x = lx;
+        y = ly;
+        dirty = true;
+    }
+}
+
+UIRectV3 UILabelV3::measure(U8G2* display) {
+    if (text[0] == '\0') return UIRectV3();
+
+    display->setFont(font);
+    int16_t width = display->getUTF8Width(text);
+    int16_t left = x;
+    if (align == UI_ALIGN_CENTER) {
+        left = (V3_UI_SCREEN_WIDTH - width) / 2;
+    } else if (align == UI_ALIGN_RIGHT) {
+        left = x - width;
+    }
+    return UIRectV3(left, y, width, display->getMaxCharHeight());
+}
+
+void UILabelV3::draw(U8G2* display) {
+    if (bounds.isEmpty()) return;
+    display->setFont(font);
+    display->drawUTF8(bounds.x, y, text);
+}
+
+// UIValueV3 实现
+UIValueV3::UIValueV3(int16_t ly, const char* l) :
+    bound_value(0), has_bound_value(false), y(ly) {
+    strncpy(label, l, sizeof(label) - 1);
+    label[sizeof(label) - 1] = '\0';
+    value[0] = '\0';
+}
+
+void UIValueV3::setLabel(const char* l) {
+    if (strncmp(label, l, sizeof(label) - 1) == 0) return;
+    strncpy(label, l, sizeof(label) - 1);
+    label[sizeof(label) - 1] = '\0';
+    has_bound_value = false;
+    dirty = true;
+}
+
+void UIValueV3::setValue(const char* v) {
+    if (strncmp(value, v, sizeof(value) - 1) == 0) return;
+    strncpy(value, v, sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+    dirty = true;
+}
+
+void UIValueV3::setValue(int32_t v) {
+    if (!bind(v)) return;
+    snprintf(value, sizeof(value), "%ld", (long)v);
+    dirty = true;
+}
+
+bool UIValueV3::bind(int32_t key) {
+    if (has_bound_value && bound_value == key) return false;
+    bound_value = key;
+    has_bound_value = true;
+    return true;
+}
+
+UIRectV3 UIValueV3::measure(U8G2* display) {
+    // 整行作为区域，数值变短时旧的数字也会被擦除
+    display->setFont(u8g2_font_6x10_tf);
+    return UIRectV3(4, y, 120, display->getMaxCharHeight());
+}
+
+void UIValueV3::draw(U8G2* display) {
+    display->setFont(u8g2_font_6x10_tf);
+    display->drawUTF8(4, y, label);
+
+    int value_width = display->getUTF8Width(value);
+    display->drawUTF8(124 - value_width, y, value);
+}
+
+// UIProgressBarV3 实现
+UIProgressBarV3::UIProgressBarV3(int16_t bx, int16_t by, int16_t bw, int16_t bh) :
+    x(bx), y(by), w(bw), h(bh), fill_width(0) {
+}
+
+void UIProgressBarV3::setProgress(float progress) {
+    if (progress < 0.0f) progress = 0.0f;
+    if (progress > 1.0f) progress = 1.0f;
+
+    int16_t width = (int16_t)(progress * (w - 2));
+    if (width != fill_width) {
+        fill_width = width;
+        dirty = true;
+    }
+}
+
+UIRectV3 UIProgressBarV3::measure(U8G2* display) {
+    return UIRectV3(x, y, w, h);
+}
+
+void UIProgressBarV3::draw(U8G2* display) {
+    display->drawFrame(x, y, w, h);
+    if (fill_width > 0) {
+        display->drawBox(x + 1, y + 1, fill_width, h - 2);
+    }
+}
+
+// UIScrollBarV3 实现
+UIScrollBarV3::UIScrollBarV3(int16_t bx, int16_t by, int16_t bh) :
+    x(bx), y(by), h(bh), thumb_y(by), thumb_h(bh) {
+}
+
+void UIScrollBarV3::setWindow(int first, int visible_count, int total) {
+    int16_t new_h = h;
+    int16_t new_y = y;
+    if (total > visible_count) {
+        new_h = max(2, h * visible_count / total);
+        float ratio = (float)first / (total - visible_count);
+        new_y = y + (h - new_h) * ratio;
+    }
+
+    if (new_h != thumb_h || new_y != thumb_y) {
+        thumb_h = new_h;
+        thumb_y = new_y;
+        dirty = true;
+    }
+}
+
+UIRectV3 UIScrollBarV3::measure(U8G2* display) {
+    return UIRectV3(x - 1, y, 3, h);
+}
+
+void UIScrollBarV3::draw(U8G2* display) {
+    display->drawVLine(x, y, h);
+    display->drawVLine(x - 1, thumb_y, thumb_h);
+    display->drawVLine(x + 1, thumb_y, thumb_h);
+}
+
+// UIBarChartV3 实现
+UIBarChartV3::UIBarChartV3(int16_t bx, int16_t by, int16_t bw, int16_t bh) :
+    x(bx), baseline(by), w(bw), h(bh), count(0) {
+    memset(heights, 0, sizeof(heights));
+}
+
+void UIBarChartV3::setBars(const uint8_t* values, uint8_t n) {
+    if (n > V3_UI_CHART_MAX_POINTS) n = V3_UI_CHART_MAX_POINTS;
+    if (n == count && memcmp(heights, values, n) == 0) return;
+    
+    memcpy(heights, values, n);
+    count = n;
+    dirty = true;
+}
+
+UIRectV3 UIBarChartV3::measure(U8G2* display) {
+    return count ? UIRectV3(x, baseline - h, w, h + 1) : UIRectV3();
+}
+
+void UIBarChartV3::draw(U8G2* display) {
+    if (count == 0) return;
+    
+    // 柱间距最大15像素，间距足够时柱宽3像素，否则1像素；整体水平居中
+    int16_t step = count > 1 ? min(15, (w - 1) / (count - 1)) : 0;
+    int16_t bar_w = step >= 4 ? 3 : 1;
+    int16_t span = (count - 1) * step + bar_w;
+    int16_t left = x + (w - span) / 2;
+    
+    display->drawHLine(x, baseline, w);
+    for (uint8_t i = 0; i < count; i++) {
+        int16_t bar_h = heights[i] > h ? h : heights[i];
+        if (bar_h > 0) {
+            display->drawBox(left + i * step, baseline - bar_h, bar_w, bar_h);
+        }
+    }
+}
+
+// UIListV3 实现
+UIListV3::UIListV3(int16_t lx, int16_t ly, int16_t row_height, uint8_t row_count, const uint8_t* f) :
+    selected(-1), highlight_visible(true) {
+    rows.reserve(row_count);
+    for (uint8_t i = 0; i < row_count; i++) {
+        rows.push_back(UILabelV3(lx, ly + i * row_height, f));
+    }
+    for (UILabelV3& row : rows) {
+        row_widgets.push_back(&row);
+    }
+}
+
+void UIListV3::updateRowVisibility() {
+    for (size_t i = 0; i < rows.size(); i++) {
+        rows[i].setVisible(visible && ((int)i != selected || highlight_visible));
+    }
+}
+
+void UIListV3::setRow(uint8_t index, const char* text) {
+    if (index < rows.size()) {
+        rows[index].setText(text);
+    }
+}
+
+void UIListV3::setSelected(int index) {
+    if (selected != index) {
+        selected = index;
+        updateRowVisibility();
+    }
+}
+
+void UIListV3::setHighlightVisible(bool state) {
+    if (highlight_visible != state) {
+        highlight_visible = state;
+        updateRowVisibility();
+    }
+}
+
+void UIListV3::invalidate() {
+    for (UILabelV3& row : rows) {
+        row.invalidate();
+    }
+}
+
+bool UIListV3::isDirty() const {
+    for (const UILabelV3& row : rows) {
+        if (row.isDirty()) return true;
+    }
+    return false;
+}
+
+void UIListV3::setVisible(bool state) {
+    if (visible != state) {
+        visible = state;
+        updateRowVisibility();
+    }
+}
+
+bool UIListV3::invalidateIntersecting(const UIRectV3& rect) {
+    bool invalidated = false;
+    for (UILabelV3& row : rows) {
+        invalidated |= row.invalidateIntersecting(rect);
+    }
+    return invalidated;
+}
+
+void UIListV3::resetBounds() {
+    for (UILabelV3& row : rows) {
+        row.resetBounds();
+    }
+}
+
+UIRectV3 UIListV3::erase(U8G2* display, UIDirtyRegionV3& region) {
+    // 行距小于字体高度时相邻行像素重叠，由级联擦除处理
+    return UIWidgetV3::eraseDirty(row_widgets, display, region);
+}
+
+void UIListV3::paint(U8G2* display, UIDirtyRegionV3& region) {
+    for (UILabelV3& row : rows) {
+        row.paint(display, region);
+    }
+}
+
+// UIScreenV3 实现
+bool UIScreenV3::render(U8G2* display) {
+    if (needs_clear || blanked) {
+        needs_clear = false;
+        blanked = false;
+        display->clearBuffer();
+        for (UIWidgetV3* widget : widgets) {
+            widget->resetBounds();
+        }
+        region.markFull();
+    }
+
+    UIWidgetV3::eraseDirty(widgets, display, region);
+    for (UIWidgetV3* widget : widgets) {
+        widget->paint(display, region);
+    }
+
+    if (region.isEmpty()) {
+        return false;
+    }
+    region.flush(display);
+    flush_count++;
+    return true;
+}
+
+void UIScreenV3::blank(U8G2* display) {
+    if (blanked) return;
+    display->clearBuffer();
+    display->sendBuffer();
+    blanked = true;
+    flush_count++;
+}